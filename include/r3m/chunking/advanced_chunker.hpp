@@ -7,8 +7,10 @@
 #include "r3m/chunking/multipass_chunker.hpp"
 #include "r3m/chunking/contextual_rag.hpp"
 #include "r3m/chunking/quality_assessment/quality_calculator.hpp"
-#include "r3m/chunking/token_management/token_cache.hpp"
+#include "r3m/chunking/token_management/shared_token_cache.hpp"
 #include "r3m/chunking/section_processing/section_processor.hpp"
+#include "r3m/parallel/optimized_thread_pool.hpp"
+#include <functional>
 #include <memory>
 #include <unordered_map>
 #include <string>
@@ -49,6 +51,7 @@ public:
         int contextual_rag_reserved_tokens = 512;
         
         Config() {}
+        bool operator==(const Config&) const = default;
     };
     
     /**
@@ -61,12 +64,25 @@ public:
         std::string source_type;
         std::unordered_map<std::string, std::string> metadata;
         std::vector<section_processing::DocumentSection> sections;
-        std::string full_content;
+        std::string full_content;   // Text of sections given as offsets; else may be left empty when total_tokens is provided
         int total_tokens = 0;
         
         DocumentInfo() = default;
     };
     
+    /**
+     * @brief Pull-source of document text for streaming mode
+     * 
+     * Fills the next block (content, link, image) and returns true, or returns
+     * false once the document is exhausted.
+     */
+    using BlockSource = std::function<bool(section_processing::DocumentSection& block)>;
+    
+    /**
+     * @brief Receives each chunk as soon as it is final
+     */
+    using ChunkCallback = std::function<void(DocumentChunk&& chunk)>;
+    
     explicit AdvancedChunker(std::shared_ptr<Tokenizer> tokenizer, const Config& config = Config());
     ~AdvancedChunker() = default;
     
@@ -75,6 +91,27 @@ public:
      */
     ChunkingResult process_document(const DocumentInfo& document);
     
+    /**
+     * @brief Process a document whose text arrives incrementally
+     * 
+     * Each block from next_block is treated as a section and combined exactly as in
+     * process_document; chunks are passed to on_chunk as soon as they are complete,
+     * so memory is bounded by a few chunks rather than by the document size.
+     * document.sections and full_content are ignored. Large chunks are emitted as
+     * each group of large_chunk_ratio chunks completes, so they interleave with
+     * regular chunks instead of trailing them.
+     * 
+     * @param document Document identity, title and metadata
+     * @param next_block Source of document blocks
+     * @param on_chunk Sink for finished chunks
+     * @return Chunking statistics (the chunks vector is left empty)
+     */
+    ChunkingResult process_document_stream(
+        const DocumentInfo& document,
+        const BlockSource& next_block,
+        const ChunkCallback& on_chunk
+    );
+    
     /**
      * @brief Process multiple documents
      */
@@ -86,16 +123,39 @@ public:
      */
     const Config& get_config() const { return config_; }
     
+    /**
+     * @brief Tokenizer the chunker counts and splits with
+     */
+    const std::shared_ptr<Tokenizer>& get_tokenizer() const { return tokenizer_; }
+    
     /**
      * @brief Update chunker configuration
      */
     void update_config(const Config& config);
     
     /**
-     * @brief Clear internal caches for memory management
+     * @brief Drop this chunker's tokenizer's counts from the shared token-count cache
+     * 
+     * Counts of other tokenizers stay cached; SharedTokenCache::instance().clear()
+     * empties the whole process-wide cache.
      */
     void clear_cache();
     
+    /**
+     * @brief Hit rate and size of the shared token-count cache
+     */
+    token_management::SharedTokenCache::Stats get_token_cache_stats() const { return token_counts_->stats(); }
+    
+    /**
+     * @brief Run per-chunk work of a document on a shared pool
+     * 
+     * Quality scoring, content token accounting and large/mini chunk assembly
+     * are forked over the pool and joined before the next step, so one large
+     * document uses every worker. Chunk order and ids do not depend on the
+     * pool. nullptr (the default) runs everything on the calling thread.
+     */
+    void set_thread_pool(parallel::OptimizedThreadPool* pool);
+    
 private:
     std::shared_ptr<Tokenizer> tokenizer_;
     Config config_;
@@ -104,9 +164,9 @@ private:
     std::unique_ptr<SentenceChunker> mini_chunk_splitter_;
     std::unique_ptr<MultipassChunker> multipass_chunker_;
     std::unique_ptr<ContextualRAG> contextual_rag_;
-    std::unique_ptr<token_management::TokenCache> token_cache_; // Token cache for performance optimization
-    std::unique_ptr<token_management::OptimizedTokenCache> optimized_cache_; // Optimized token cache
+    token_management::SharedTokenCache* token_counts_; // Process-wide token counts, not owned
     std::unique_ptr<section_processing::SectionProcessor> section_processor_; // Section processor
+    parallel::OptimizedThreadPool* thread_pool_ = nullptr; // Not owned
     
     /**
      * @brief Manage token allocation for title, metadata, and content
@@ -115,6 +175,14 @@ private:
      */
     section_processing::TokenManagementResult manage_tokens(const DocumentInfo& document);
     
+    /**
+     * @brief Manage token allocation given a known document token count
+     * @param document Document information
+     * @param doc_tokens Token count of the whole document
+     * @return Token management result
+     */
+    section_processing::TokenManagementResult manage_tokens(const DocumentInfo& document, int doc_tokens);
+    
     /**
      * @brief Extract title blurb from document
      * @param title Document title
@@ -126,25 +194,32 @@ private:
      * @brief Process document sections with token management
      * @param document Document information
      * @param token_result Token management result
-     * @return Vector of document chunks
+     * @return Vector of document chunks (not yet scored, see score_chunks)
      */
     std::vector<DocumentChunk> process_sections(
         const DocumentInfo& document,
         const section_processing::TokenManagementResult& token_result
     );
     
+    /**
+     * @brief Calculate quality metrics of every chunk (in parallel on the pool)
+     * @param chunks Vector of chunks
+     */
+    void score_chunks(std::vector<DocumentChunk>& chunks);
+    
     /**
      * @brief Apply quality filtering to chunks
      * @param chunks Vector of chunks
-     * @return Filtered chunks
+     * @return Filtered chunks, in their original order
      */
-    std::vector<DocumentChunk> apply_quality_filtering(const std::vector<DocumentChunk>& chunks);
+    std::vector<DocumentChunk> apply_quality_filtering(std::vector<DocumentChunk> chunks);
     
     /**
-     * @brief Calculate chunk quality metrics
+     * @brief Check a single chunk against the quality filter
      * @param chunk Document chunk
+     * @return True if the chunk is kept
      */
-    void calculate_chunk_quality(DocumentChunk& chunk);
+    bool passes_quality_filter(const DocumentChunk& chunk) const;
     
          /**
       * @brief Initialize chunking components
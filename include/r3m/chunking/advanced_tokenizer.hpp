@@ -1,6 +1,12 @@
 #pragma once
 
+#include "r3m/chunking/tokenizer.hpp"
+
+#include <array>
+#include <cstdint>
+#include <limits>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <unordered_map>
@@ -9,31 +15,26 @@
 namespace r3m::chunking {
 
 /**
- * Advanced tokenizer interface
+ * Tokenizer with integer token ids
+ *
+ * Usable anywhere a chunking Tokenizer is (the chunker counts with it); adds
+ * encoding to ids and decoding back. Counts are not capped.
  */
-class AdvancedTokenizer {
+class AdvancedTokenizer : public Tokenizer {
 public:
-    virtual ~AdvancedTokenizer() = default;
+    using Tokenizer::count_tokens;
     
     /**
      * Encode text to token IDs
      */
-    virtual std::vector<int> encode(const std::string& text) = 0;
-    
-    /**
-     * Tokenize text to token strings
-     */
-    virtual std::vector<std::string> tokenize(const std::string& text) = 0;
+    virtual std::vector<int> encode(const std::string& text) const = 0;
     
     /**
      * Decode token IDs back to text
      */
-    virtual std::string decode(const std::vector<int>& tokens) = 0;
+    virtual std::string decode(const std::vector<int>& tokens) const = 0;
     
-    /**
-     * Get token count for text
-     */
-    virtual int count_tokens(const std::string& text) = 0;
+    size_t get_max_tokens() const override { return std::numeric_limits<size_t>::max(); }
 };
 
 /**
@@ -41,14 +42,17 @@ public:
  */
 class SimpleTokenizer : public AdvancedTokenizer {
 public:
-    std::vector<int> encode(const std::string& text) override;
-    std::vector<std::string> tokenize(const std::string& text) override;
-    std::string decode(const std::vector<int>& tokens) override;
-    int count_tokens(const std::string& text) override;
+    using AdvancedTokenizer::count_tokens;
+    
+    std::vector<int> encode(const std::string& text) const override;
+    std::vector<std::string> tokenize(const std::string& text) const override;
+    std::vector<TokenSpan> token_spans(std::string_view text) const override;
+    std::string decode(const std::vector<int>& tokens) const override;
+    size_t count_tokens(const std::string& text) const override;
 
 private:
-    std::vector<std::string> split_text(const std::string& text);
-    int hash_token(const std::string& token);
+    std::vector<std::string> split_text(const std::string& text) const;
+    int hash_token(const std::string& token) const;
 };
 
 /**
@@ -58,74 +62,90 @@ class SentenceTokenizer : public AdvancedTokenizer {
 public:
     SentenceTokenizer(bool preserve_punctuation = true);
     
-    std::vector<int> encode(const std::string& text) override;
-    std::vector<std::string> tokenize(const std::string& text) override;
-    std::string decode(const std::vector<int>& tokens) override;
-    int count_tokens(const std::string& text) override;
+    using AdvancedTokenizer::count_tokens;
+    std::vector<int> encode(const std::string& text) const override;
+    std::vector<std::string> tokenize(const std::string& text) const override;
+    std::vector<TokenSpan> token_spans(std::string_view text) const override;
+    std::string decode(const std::vector<int>& tokens) const override;
+    size_t count_tokens(const std::string& text) const override;
 
 private:
     bool preserve_punctuation_;
     std::regex sentence_pattern_;
     std::regex word_pattern_;
     
-    std::vector<std::string> split_sentences(const std::string& text);
-    std::vector<std::string> split_words(const std::string& text);
-    int hash_token(const std::string& token);
+    std::vector<std::string> split_sentences(const std::string& text) const;
+    std::vector<std::string> split_words(const std::string& text) const;
+    int hash_token(const std::string& token) const;
 };
 
 /**
- * BPE-style tokenizer with vocabulary
+ * Byte-level BPE tokenizer (GPT-2 / RoBERTa style)
+ *
+ * Text is pre-tokenized by a hand-written scanner equivalent to the GPT-2
+ * pattern ('s|'t|'re|'ve|'m|'ll|'d| ?letters| ?digits| ?other|whitespace),
+ * treating every non-ASCII byte as a letter. Each piece starts as one token
+ * per byte and adjacent pairs are merged lowest merge rank first, using a
+ * linked list of symbols and a heap of candidate pairs (O(n log n) per
+ * piece). Token strings are raw bytes, so decode(encode(text)) == text.
+ *
+ * Vocabularies load from the standard vocab.json / merges.txt pair, which
+ * stores tokens in GPT-2's printable byte-to-unicode form, so token counts
+ * match models trained with them.
  */
 class BPETokenizer : public AdvancedTokenizer {
 public:
     BPETokenizer(size_t vocab_size = 50000);
     
-    std::vector<int> encode(const std::string& text) override;
-    std::vector<std::string> tokenize(const std::string& text) override;
-    std::string decode(const std::vector<int>& tokens) override;
-    int count_tokens(const std::string& text) override;
+    std::vector<int> encode(const std::string& text) const override;
+    std::vector<std::string> tokenize(const std::string& text) const override;
+    std::vector<TokenSpan> token_spans(std::string_view text) const override; // Exact, from token byte lengths
+    std::string decode(const std::vector<int>& tokens) const override;
+    size_t count_tokens(const std::string& text) const override;
+    size_t count_tokens(std::string_view text) const override; // No token or id vector
     
     /**
-     * Train the tokenizer on a corpus
+     * Learn merges from a corpus, starting again from the 256 byte tokens,
+     * until the vocabulary reaches vocab_size (or no pair repeats)
      */
     void train(const std::vector<std::string>& corpus);
     
     /**
-     * Save/load vocabulary
+     * Save/load vocab.json and merges.txt (throws std::runtime_error if a
+     * file cannot be opened or parsed)
+     */
+    void save_vocabulary(const std::string& vocab_path, const std::string& merges_path) const;
+    void load_vocabulary(const std::string& vocab_path, const std::string& merges_path);
+    
+    size_t vocabulary_size() const { return vocab_.size(); }
+    size_t merge_count() const { return merges_.size(); }
+    
+    /**
+     * Split text into the pieces BPE runs on (views into text)
      */
-    void save_vocabulary(const std::string& filename);
-    void load_vocabulary(const std::string& filename);
+    static std::vector<std::string_view> pre_tokenize(std::string_view text);
 
 private:
+    struct Merge {
+        int rank;
+        int id;
+    };
+    
     size_t vocab_size_;
     std::unordered_map<std::string, int> vocab_;
-    std::unordered_map<int, std::string> reverse_vocab_;
-    std::unordered_map<std::string, int> pair_freqs_;
+    std::vector<std::string> reverse_vocab_;    // Token bytes by id ("" for unused ids)
+    std::array<int, 256> byte_ids_;             // Id of each single-byte token, -1 if none
+    std::unordered_map<uint64_t, Merge> merges_; // (left id, right id) -> rank and merged id
     
-    void build_vocabulary(const std::vector<std::string>& corpus);
-    std::vector<std::string> byte_pair_encode(const std::string& text);
-    std::string byte_pair_decode(const std::vector<std::string>& tokens);
-    void merge_pairs();
-};
-
-/**
- * Factory for creating tokenizers
- */
-class TokenizerFactory {
-public:
-    enum class Type {
-        SIMPLE,
-        SENTENCE,
-        BPE
-    };
+    static uint64_t pair_key(int left, int right) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(left)) << 32) | static_cast<uint32_t>(right);
+    }
     
-    static std::shared_ptr<AdvancedTokenizer> create(Type type, 
-                                                    const std::string& model_name = "");
+    void reset_to_bytes();
+    int add_token(const std::string& token);
     
-    /**
-     * Create tokenizer from configuration
-     */
-    static std::shared_ptr<AdvancedTokenizer> create_from_config(const std::string& config);
+    // Appends the token ids of one pre-tokenized piece
+    void encode_piece(std::string_view piece, std::vector<int>& ids) const;
 };
 
 } // namespace r3m::chunking 
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "r3m/chunking/shared_text.hpp"
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -27,16 +28,16 @@ constexpr bool USE_DOCUMENT_SUMMARY = true;       // Enable document summaries
  */
 struct BaseChunk {
     int chunk_id;
-    std::string blurb;           // First sentence(s) of the chunk
-    std::string content;          // Main chunk text
+    SharedText blurb;            // First sentence(s) of the chunk
+    SharedText content;           // Main chunk text (usually a slice of the document text)
     std::unordered_map<int, std::string> source_links;  // Links with offsets
     std::string image_file_id;    // Associated image file
     bool section_continuation;    // True if chunk doesn't start at section beginning
     
     BaseChunk() : chunk_id(0), section_continuation(false) {}
     
-    BaseChunk(int id, const std::string& b, const std::string& c)
-        : chunk_id(id), blurb(b), content(c), section_continuation(false) {}
+    BaseChunk(int id, SharedText b, SharedText c)
+        : chunk_id(id), blurb(std::move(b)), content(std::move(c)), section_continuation(false) {}
 };
 
 /**
@@ -44,12 +45,15 @@ struct BaseChunk {
  * 
  * Document-aware chunk with context and advanced features
  * like multipass support and contextual RAG.
+ * Text fields are SharedText: title/metadata strings and the document summary
+ * are shared by every chunk of a document, and content/blurb slice the
+ * document text, so a chunk copies no text until it is serialized.
  */
 struct DocumentChunk : public BaseChunk {
     std::string document_id;      // Source document identifier
-    std::string title_prefix;     // Document title prefix (may be empty if too long)
-    std::string metadata_suffix_semantic; // Semantic metadata string
-    std::string metadata_suffix_keyword;  // Keyword metadata string
+    SharedText title_prefix;      // Document title prefix (may be empty if too long)
+    SharedText metadata_suffix_semantic; // Semantic metadata string
+    SharedText metadata_suffix_keyword;  // Keyword metadata string
     
     // Section properties
     bool section_continuation;     // True if chunk doesn't start at section boundary
@@ -62,14 +66,14 @@ struct DocumentChunk : public BaseChunk {
     int content_token_limit;      // Adjusted content token limit
 
     // Multipass support
-    std::vector<std::string> mini_chunk_texts;  // For multipass mode
+    SharedTextList mini_chunk_texts;  // For multipass mode (shared by sibling mini chunks)
     int large_chunk_id;           // Reference to large chunk
     std::vector<int> large_chunk_reference_ids; // IDs of chunks in large chunk
 
     // Contextual RAG support
     int contextual_rag_reserved_tokens;
-    std::string doc_summary;      // Document summary for RAG
-    std::string chunk_context;    // Chunk-specific context
+    SharedText doc_summary;       // Document summary for RAG
+    SharedText chunk_context;     // Chunk-specific context
 
     // Quality metrics
     double quality_score;
@@ -103,14 +107,22 @@ struct DocumentChunk : public BaseChunk {
      * @brief Get full content with title and metadata (for indexing)
      */
     std::string get_full_content() const {
-        return title_prefix + doc_summary + content + chunk_context + metadata_suffix_keyword;
+        std::string full;
+        full.reserve(title_prefix.size() + doc_summary.size() + content.size() +
+                     chunk_context.size() + metadata_suffix_keyword.size());
+        full.append(title_prefix.view());
+        full.append(doc_summary.view());
+        full.append(content.view());
+        full.append(chunk_context.view());
+        full.append(metadata_suffix_keyword.view());
+        return full;
     }
     
     /**
      * @brief Get content summary (without title/metadata for highlighting)
      */
     std::string get_content_summary() const {
-        return content;
+        return content.str();
     }
 };
 
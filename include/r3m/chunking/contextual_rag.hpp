@@ -5,6 +5,7 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
 
 namespace r3m {
 namespace chunking {
@@ -59,7 +60,7 @@ public:
      */
     std::string generate_chunk_context(
         const DocumentChunk& chunk,
-        const std::string& document_summary
+        std::string_view document_summary
     );
     
     /**
@@ -84,7 +85,7 @@ private:
     
     // Helper methods
     std::string create_document_summary_prompt(const std::vector<DocumentChunk>& chunks);
-    std::string create_chunk_context_prompt(const DocumentChunk& chunk, const std::string& document_summary);
+    std::string create_chunk_context_prompt(const DocumentChunk& chunk, std::string_view document_summary);
     std::string simulate_llm_response(const std::string& prompt);
     size_t count_tokens(const std::string& text) const;
 };
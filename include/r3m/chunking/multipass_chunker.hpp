@@ -3,6 +3,7 @@
 #include "r3m/chunking/tokenizer.hpp"
 #include "r3m/chunking/sentence_chunker.hpp"
 #include "r3m/chunking/chunk_models.hpp"
+#include "r3m/parallel/optimized_thread_pool.hpp"
 #include <memory>
 #include <vector>
 
@@ -56,6 +57,10 @@ public:
     
     /**
      * @brief Generate mini-chunks from regular chunks
+     * 
+     * Each regular chunk is split independently (in parallel when a pool is
+     * set); mini chunks keep their parents' order and are numbered after.
+     * 
      * @param chunks Regular chunks
      * @return Vector of mini-chunks
      */
@@ -68,6 +73,11 @@ public:
      */
     std::vector<DocumentChunk> generate_large_chunks(const std::vector<DocumentChunk>& chunks);
     
+    /**
+     * @brief Assemble mini and large chunks on a shared pool (nullptr: calling thread)
+     */
+    void set_thread_pool(parallel::OptimizedThreadPool* pool) { thread_pool_ = pool; }
+    
     /**
      * @brief Get configuration
      */
@@ -85,19 +95,20 @@ private:
     bool enable_large_chunks_;
     size_t mini_chunk_size_;
     size_t large_chunk_ratio_;
+    parallel::OptimizedThreadPool* thread_pool_ = nullptr; // Not owned
     
     // Helper methods
-    std::string extract_blurb(const std::string& text) const;
-    std::vector<std::string> get_mini_chunk_texts(const std::string& chunk_text) const;
+    size_t blurb_length(std::string_view text) const;
+    std::vector<std::string> get_mini_chunk_texts(std::string_view chunk_text) const;
     std::string create_metadata_string(const std::unordered_map<std::string, std::string>& metadata) const;
     std::string create_metadata_keyword(const std::unordered_map<std::string, std::string>& metadata) const;
     DocumentChunk create_chunk(
         int chunk_id,
         const std::string& document_id,
-        const std::string& content,
-        const std::string& title_prefix,
-        const std::string& metadata_semantic,
-        const std::string& metadata_keyword,
+        SharedText content,
+        const SharedText& title_prefix,
+        const SharedText& metadata_semantic,
+        const SharedText& metadata_keyword,
         bool is_continuation = false
     ) const;
 };
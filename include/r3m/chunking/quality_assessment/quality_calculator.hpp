@@ -1,6 +1,10 @@
 #pragma once
 
+#include "r3m/utils/simd_kernels.hpp"
+
+#include <span>
 #include <string>
+#include <string_view>
 #include <unordered_set>
 #include <sstream>
 #include <cctype>
@@ -10,41 +14,83 @@ namespace r3m {
 namespace chunking {
 namespace quality_assessment {
 
+/**
+ * @brief All quality metrics of one chunk, from a single scan of its text
+ *
+ * Words are runs of non-whitespace bytes (as operator>> splits them) and a
+ * word containing '.', '!' or '?' ends a sentence. Distinct counts stop where
+ * their score saturates.
+ */
+struct ChunkQuality {
+    size_t word_count = 0;
+    size_t sentence_count = 0;
+    size_t distinct_words = 0;          // Capped at 100
+    size_t distinct_alphanumeric = 0;   // Distinct [0-9A-Za-z] bytes, capped at 50
+    
+    double word_diversity = 0.0;
+    double sentence_structure = 0.0;
+    double information_density = 0.0;
+    double quality_score = 0.0;
+};
+
 /**
  * @brief Quality calculator for document chunks
  * 
  * Provides methods to calculate various quality metrics for document chunks,
  * including word diversity, sentence structure, and information density.
+ * score() computes all of them in one pass: whitespace and sentence-mark
+ * bitmaps from the SIMD kernels give word and sentence boundaries, distinct
+ * characters go into a 256-bit presence mask, and distinct words into a small
+ * fixed-size table that is no longer filled once the diversity score saturates.
  */
 class QualityCalculator {
 public:
+    /**
+     * @brief Calculate every quality metric of a chunk in one pass
+     * @param text The text to analyze
+     * @return Counts and scores (scores between 0.0 and 1.0)
+     */
+    static ChunkQuality score(std::string_view text);
+    
+    /**
+     * @brief score() with a specific kernel table (for differential testing)
+     */
+    static ChunkQuality score(std::string_view text, const utils::SIMDKernels& kernels);
+    
+    /**
+     * @brief Score many chunks, reusing the scan state between them
+     * @param texts Chunk texts
+     * @param out Receives score(texts[i]) at index i; must be as long as texts
+     */
+    static void score_batch(std::span<const std::string_view> texts, std::span<ChunkQuality> out);
+    
     /**
      * @brief Calculate word diversity score
      * @param text The text to analyze
      * @return Diversity score between 0.0 and 1.0
      */
-    static double calculate_word_diversity(const std::string& text);
+    static double calculate_word_diversity(std::string_view text);
     
     /**
      * @brief Calculate sentence structure score
      * @param text The text to analyze
      * @return Sentence structure score between 0.0 and 1.0
      */
-    static double calculate_sentence_structure(const std::string& text);
+    static double calculate_sentence_structure(std::string_view text);
     
     /**
      * @brief Calculate information density score
      * @param text The text to analyze
      * @return Information density score between 0.0 and 1.0
      */
-    static double calculate_information_density(const std::string& text);
+    static double calculate_information_density(std::string_view text);
     
     /**
      * @brief Calculate overall quality score
      * @param text The text to analyze
      * @return Overall quality score between 0.0 and 1.0
      */
-    static double calculate_quality_score(const std::string& text);
+    static double calculate_quality_score(std::string_view text);
 };
 
 } // namespace quality_assessment
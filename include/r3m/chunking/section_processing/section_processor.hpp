@@ -1,11 +1,15 @@
 #pragma once
 
 #include "r3m/chunking/chunk_models.hpp"
+#include "r3m/chunking/quality_assessment/quality_calculator.hpp"
 #include "r3m/chunking/tokenizer.hpp"
-#include "r3m/chunking/token_management/token_cache.hpp"
+#include "r3m/chunking/token_management/shared_token_cache.hpp"
 #include "r3m/chunking/sentence_chunker.hpp"
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
@@ -24,18 +28,30 @@ struct DocumentSection {
     bool is_oversized = false;
     int token_count = 0;
     
+    // With content empty, the section is [offset, offset + length) of the
+    // document text (DocumentInfo::full_content) instead of a copy of it
+    size_t offset = 0;
+    size_t length = 0;
+    
     DocumentSection() = default;
     DocumentSection(const std::string& c, const std::string& l = "")
         : content(c), link(l) {}
+    
+    std::string_view text(std::string_view document_text) const {
+        if (!content.empty()) {
+            return content;
+        }
+        return document_text.substr(std::min(offset, document_text.size()), length);
+    }
 };
 
 /**
  * @brief Token management result for section processing
  */
 struct TokenManagementResult {
-    std::string title_prefix;
-    std::string metadata_suffix_semantic;
-    std::string metadata_suffix_keyword;
+    SharedText title_prefix;              // Shared by every chunk of the document
+    SharedText metadata_suffix_semantic;
+    SharedText metadata_suffix_keyword;
     int title_tokens = 0;
     int metadata_tokens = 0;
     int content_token_limit = 0;
@@ -57,6 +73,67 @@ struct TokenManagementResult {
  */
 class SectionProcessor {
 public:
+    /**
+     * @brief Incremental section combiner
+     * 
+     * Sections are added one at a time and each chunk is handed to the sink as
+     * soon as it is complete, so only the chunk being assembled is kept in
+     * memory. process_sections_with_combinations is this stream run over a
+     * vector of sections. With score_chunks false, chunks are emitted without
+     * quality metrics and the caller is expected to score them (in batch).
+     */
+    class CombineStream {
+    public:
+        using ChunkSink = std::function<void(DocumentChunk&&)>;
+        
+        CombineStream(
+            SectionProcessor& processor,
+            const TokenManagementResult& token_result,
+            const std::string& document_id,
+            const std::string& source_type,
+            const std::string& semantic_identifier,
+            ChunkSink sink,
+            bool score_chunks = true
+        );
+        
+        /**
+         * @brief Add the next section of the document
+         * @param section Document section
+         * @param document_text Text a section without content is a slice of
+         */
+        void add_section(const DocumentSection& section, std::string_view document_text = {});
+        
+        /**
+         * @brief Flush the chunk being assembled (always emits at least one chunk)
+         */
+        void finish();
+        
+        int chunks_emitted() const { return chunk_id_; }
+        
+    private:
+        SectionProcessor& processor_;
+        TokenManagementResult token_result_;
+        std::string document_id_;
+        std::string source_type_;
+        std::string semantic_identifier_;
+        ChunkSink sink_;
+        
+        std::unordered_map<int, std::string> link_offsets_;
+        SharedText::Buffer chunk_head_;   // Sole section of the pending chunk (not copied)
+        std::string chunk_text_;          // Pending chunk once it combines several sections
+        int chunk_id_ = 0;
+        int separator_tokens_ = 0;
+        int separator_cleaned_length_ = 0;
+        int chunk_cleaned_length_ = 0;    // precompare_cleanup_length of the pending chunk
+        int chunk_token_count_ = 0;       // Section tokens plus separator tokens of the pending chunk
+        bool score_chunks_ = true;
+        
+        DocumentChunk make_chunk(SharedText content, const std::string& link,
+                                 const std::string& image_file_id, bool is_continuation);
+        SharedText take_pending_text();
+        void flush_text_chunk(bool attach_links);
+    };
+    
     /**
      * @brief Constructor
      * @param tokenizer Shared pointer to tokenizer
@@ -72,6 +149,8 @@ public:
      * @param document_id Document identifier
      * @param source_type Source type
      * @param semantic_identifier Semantic identifier
+     * @param score_chunks Compute quality metrics (false: left for score_chunk)
+     * @param document_text Text that sections without content are slices of
      * @return Vector of document chunks
      */
     std::vector<DocumentChunk> process_sections_with_combinations(
@@ -79,7 +158,9 @@ public:
         const TokenManagementResult& token_result,
         const std::string& document_id,
         const std::string& source_type,
-        const std::string& semantic_identifier
+        const std::string& semantic_identifier,
+        bool score_chunks = true,
+        std::string_view document_text = {}
     );
     
     /**
@@ -105,13 +186,17 @@ public:
     );
     
     /**
-     * @brief Split oversized chunk using optimized approach
+     * @brief Split oversized chunk at token boundaries without copying
+     * 
+     * Cuts text before every content_token_limit-th token span, so the pieces
+     * keep the original spacing and punctuation; only whitespace between
+     * pieces is dropped.
      * @param text Text to split
      * @param content_token_limit Content token limit
-     * @return Vector of split texts
+     * @return Views into text, in order
      */
-    std::vector<std::string> split_oversized_chunk_optimized(
-        const std::string& text,
+    std::vector<std::string_view> split_oversized_chunk_optimized(
+        std::string_view text,
         int content_token_limit
     );
     
@@ -127,7 +212,7 @@ public:
     );
     
     /**
-     * @brief Create chunk from section
+     * @brief Create chunk from section (copies the section text once)
      * @param section Document section
      * @param chunk_id Chunk identifier
      * @param document_id Document identifier
@@ -144,19 +229,78 @@ public:
         const DocumentSection& section,
         int chunk_id,
         const std::string& document_id,
-        const std::string& title_prefix,
-        const std::string& metadata_suffix_semantic,
-        const std::string& metadata_suffix_keyword,
+        const SharedText& title_prefix,
+        const SharedText& metadata_suffix_semantic,
+        const SharedText& metadata_suffix_keyword,
+        int content_token_limit,
+        const std::string& source_type,
+        const std::string& semantic_identifier,
+        bool is_continuation
+    );
+    
+    /**
+     * @brief Create chunk over shared content
+     * @param content Chunk text (typically a slice of the section buffer)
+     * @param link Source link of the content
+     * @param image_file_id Associated image file
+     * Remaining parameters as for create_chunk_from_section
+     * @return Document chunk
+     */
+    DocumentChunk create_chunk(
+        SharedText content,
+        const std::string& link,
+        const std::string& image_file_id,
+        int chunk_id,
+        const std::string& document_id,
+        const SharedText& title_prefix,
+        const SharedText& metadata_suffix_semantic,
+        const SharedText& metadata_suffix_keyword,
         int content_token_limit,
         const std::string& source_type,
         const std::string& semantic_identifier,
         bool is_continuation
     );
+    
+    /**
+     * @brief Calculate quality metrics of a chunk (thread-safe)
+     * @param chunk Document chunk
+     */
+    static void score_chunk(DocumentChunk& chunk);
+    
+    /**
+     * @brief Assign metrics already computed for a chunk (see QualityCalculator::score_batch)
+     * @param chunk Document chunk
+     * @param quality Metrics of chunk.content
+     */
+    static void apply_quality(DocumentChunk& chunk, const quality_assessment::ChunkQuality& quality);
 
 private:
     std::shared_ptr<Tokenizer> tokenizer_;
-    std::unique_ptr<token_management::OptimizedTokenCache> optimized_cache_;
+    token_management::SharedTokenCache* token_counts_; // Process-wide, not owned
     std::unique_ptr<SentenceChunker> chunk_splitter_;
+    
+    int cached_token_count(std::string_view text) const {
+        return token_counts_->get_token_count(*tokenizer_, text);
+    }
+    
+    // create_chunk without quality metrics, given the token counts of the
+    // title prefix and semantic metadata suffix
+    DocumentChunk build_chunk(
+        SharedText content,
+        const std::string& link,
+        const std::string& image_file_id,
+        int chunk_id,
+        const std::string& document_id,
+        const SharedText& title_prefix,
+        const SharedText& metadata_suffix_semantic,
+        const SharedText& metadata_suffix_keyword,
+        int title_tokens,
+        int metadata_tokens,
+        int content_token_limit,
+        const std::string& source_type,
+        const std::string& semantic_identifier,
+        bool is_continuation
+    );
 };
 
 } // namespace section_processing
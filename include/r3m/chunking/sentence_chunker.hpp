@@ -2,6 +2,7 @@
 
 #include "r3m/chunking/tokenizer.hpp"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 
@@ -13,6 +14,8 @@ namespace chunking {
  * 
  * Intelligent text chunking with sentence boundary detection
  * that respects sentence boundaries and token limits.
+ * Each sentence is tokenized once and chunk totals are summed incrementally,
+ * so chunking is linear in the input size.
  */
 class SentenceChunker {
 public:
@@ -37,7 +40,7 @@ public:
      * @param text Input text to chunk
      * @return Vector of text chunks
      */
-    std::vector<std::string> chunk(const std::string& text) const;
+    std::vector<std::string> chunk(std::string_view text) const;
     
     /**
      * @brief Get chunk size
@@ -55,16 +58,32 @@ private:
     size_t chunk_overlap_;
     std::string return_type_;
     
+    /**
+     * @brief Cleaned sentence stored in a shared buffer with its token count
+     */
+    struct Sentence {
+        size_t offset;
+        size_t length;
+        size_t tokens;
+    };
+    
     // Helper methods
-    std::vector<std::string> split_into_sentences(const std::string& text) const;
+    void split_into_sentences(
+        std::string_view text,
+        std::string& buffer,
+        std::vector<Sentence>& sentences
+    ) const;
     std::vector<std::string> merge_sentences_into_chunks(
-        const std::vector<std::string>& sentences
+        const std::string& buffer,
+        const std::vector<Sentence>& sentences
     ) const;
-    bool should_start_new_chunk(
-        const std::string& current_chunk,
-        const std::string& next_sentence
+    void add_sentence(
+        std::string_view raw,
+        std::string& buffer,
+        std::vector<Sentence>& sentences,
+        std::string& scratch
     ) const;
-    std::string clean_sentence(const std::string& sentence) const;
+    static void clean_sentence(std::string_view sentence, std::string& out);
 };
 
 } // namespace chunking
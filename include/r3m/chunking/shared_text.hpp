@@ -0,0 +1,143 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace r3m {
+namespace chunking {
+
+/**
+ * @brief Immutable slice of a shared, reference-counted text buffer
+ *
+ * Chunks of one document slice the same cleaned text and point at the same
+ * title/metadata strings instead of each owning copies. A std::string is only
+ * produced by str() (or substr()) when a chunk is serialized.
+ */
+class SharedText {
+public:
+    using Buffer = std::shared_ptr<const std::string>;
+    static constexpr size_t npos = std::string_view::npos;
+
+    SharedText() = default;
+
+    // Take ownership of a string (empty strings allocate nothing)
+    SharedText(std::string text) {
+        if (!text.empty()) {
+            length_ = text.size();
+            buffer_ = std::make_shared<const std::string>(std::move(text));
+        }
+    }
+
+    SharedText(const char* text) : SharedText(std::string(text)) {}
+
+    // Whole buffer
+    SharedText(Buffer buffer)
+        : buffer_(std::move(buffer)), length_(buffer_ ? buffer_->size() : 0) {}
+
+    // Span [offset, offset + length) of a buffer
+    SharedText(Buffer buffer, size_t offset, size_t length)
+        : buffer_(std::move(buffer)), offset_(offset), length_(length) {}
+
+    std::string_view view() const {
+        return buffer_ ? std::string_view(buffer_->data() + offset_, length_) : std::string_view();
+    }
+    operator std::string_view() const { return view(); }
+
+    // Materialize a copy
+    std::string str() const { return std::string(view()); }
+
+    size_t size() const { return length_; }
+    size_t length() const { return length_; }
+    bool empty() const { return length_ == 0; }
+    const char* data() const { return view().data(); }
+    std::string_view::const_iterator begin() const { return view().begin(); }
+    std::string_view::const_iterator end() const { return view().end(); }
+    char operator[](size_t pos) const { return view()[pos]; }
+
+    size_t find(std::string_view needle, size_t pos = 0) const { return view().find(needle, pos); }
+    size_t find(char c, size_t pos = 0) const { return view().find(c, pos); }
+
+    // Copying substring, like std::string::substr
+    std::string substr(size_t pos, size_t count = npos) const { return std::string(view().substr(pos, count)); }
+
+    // Sharing substring
+    SharedText slice(size_t pos, size_t count = npos) const {
+        if (pos >= length_) {
+            return SharedText();
+        }
+        return SharedText(buffer_, offset_ + pos, std::min(count, length_ - pos));
+    }
+
+    /**
+     * @brief Share text with this buffer when it is found at cursor
+     *
+     * Splitters return pieces of their input in order, possibly without the
+     * whitespace between them. If text starts at cursor (after skipping
+     * whitespace) it is returned as a slice and cursor moves past it; otherwise
+     * text is kept as an owned copy.
+     */
+    SharedText slice_matching(std::string&& text, size_t& cursor) const {
+        std::string_view source = view();
+        size_t pos = std::min(cursor, source.size());
+        while (pos < source.size() && std::isspace(static_cast<unsigned char>(source[pos]))) {
+            ++pos;
+        }
+        if (!text.empty() && source.substr(pos, text.size()) == text) {
+            cursor = pos + text.size();
+            return slice(pos, text.size());
+        }
+        return SharedText(std::move(text));
+    }
+
+    const Buffer& buffer() const { return buffer_; }
+
+    void clear() {
+        buffer_.reset();
+        offset_ = 0;
+        length_ = 0;
+    }
+
+    friend bool operator==(const SharedText& lhs, std::string_view rhs) { return lhs.view() == rhs; }
+
+    friend std::ostream& operator<<(std::ostream& os, const SharedText& text) { return os << text.view(); }
+
+private:
+    Buffer buffer_;
+    size_t offset_ = 0;
+    size_t length_ = 0;
+};
+
+/**
+ * @brief Immutable list of texts shared by every chunk that refers to it
+ */
+class SharedTextList {
+public:
+    SharedTextList() = default;
+    explicit SharedTextList(std::vector<SharedText> items)
+        : items_(std::make_shared<const std::vector<SharedText>>(std::move(items))) {}
+
+    size_t size() const { return items_ ? items_->size() : 0; }
+    bool empty() const { return size() == 0; }
+    const SharedText& operator[](size_t index) const { return (*items_)[index]; }
+
+    std::vector<SharedText>::const_iterator begin() const { return items_ ? items_->begin() : empty_list().begin(); }
+    std::vector<SharedText>::const_iterator end() const { return items_ ? items_->end() : empty_list().end(); }
+
+    const std::shared_ptr<const std::vector<SharedText>>& items() const { return items_; }
+
+private:
+    std::shared_ptr<const std::vector<SharedText>> items_;
+
+    static const std::vector<SharedText>& empty_list() {
+        static const std::vector<SharedText> empty;
+        return empty;
+    }
+};
+
+} // namespace chunking
+} // namespace r3m
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "r3m/chunking/tokenizer.hpp"
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace r3m {
+namespace chunking {
+namespace token_management {
+
+/**
+ * @brief Process-wide token-count cache shared by every chunker and thread
+ *
+ * Entries are keyed by a 64-bit wyhash of the text seeded with the
+ * tokenizer's cache_key(), so counts of different tokenizers never mix and no
+ * text is stored. The key space is split over lock-striped shards; each shard
+ * holds at most capacity / SHARD_COUNT entries and evicts with CLOCK (an
+ * entry hit since the hand last passed gets a second chance). Counting on a
+ * miss happens outside the shard lock.
+ *
+ * Strings repeated across a batch (title prefixes, metadata suffixes, the
+ * section separator, recurring headers and footers) are counted once.
+ */
+class SharedTokenCache {
+public:
+    static constexpr size_t SHARD_COUNT = 64;
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t entries = 0;
+        size_t capacity = 0;
+
+        double hit_rate() const {
+            uint64_t lookups = hits + misses;
+            return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+        }
+    };
+
+    /**
+     * @brief Constructor
+     * @param capacity Maximum number of cached counts (at least one per shard)
+     */
+    explicit SharedTokenCache(size_t capacity = DEFAULT_CAPACITY);
+
+    SharedTokenCache(const SharedTokenCache&) = delete;
+    SharedTokenCache& operator=(const SharedTokenCache&) = delete;
+
+    /**
+     * @brief The cache shared by the whole process
+     */
+    static SharedTokenCache& instance();
+
+    /**
+     * @brief Get token count for text with caching (thread-safe)
+     * @param tokenizer Tokenizer that counts on a miss
+     * @param text Text to count tokens for
+     * @return Number of tokens
+     */
+    int get_token_count(const Tokenizer& tokenizer, std::string_view text);
+
+    /**
+     * @brief Hits, misses and evictions since construction or the last clear()
+     */
+    Stats stats() const;
+
+    /**
+     * @brief Drop every entry and reset the statistics (of every tokenizer
+     * and thread in the process, for the instance())
+     */
+    void clear();
+
+    /**
+     * @brief Drop the entries counted by one tokenizer; other tokenizers'
+     * entries and the statistics are kept
+     * @param tokenizer Tokenizer whose current cache_key() seeded the entries
+     */
+    void clear(const Tokenizer& tokenizer);
+
+private:
+    struct Slot {
+        uint64_t key = 0;
+        uint64_t tokenizer_key = 0;  // Seed of key, so one tokenizer's entries can be dropped
+        int count = 0;
+        bool referenced = false;
+    };
+
+    struct alignas(64) Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, uint32_t> index; // Key -> slot
+        std::vector<Slot> slots;                      // Grows up to the shard capacity
+        size_t hand = 0;                              // CLOCK hand
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+    };
+
+    size_t shard_capacity_;
+    std::array<Shard, SHARD_COUNT> shards_;
+
+    Shard& shard_for(uint64_t key) { return shards_[key % SHARD_COUNT]; }
+
+    // Stores a count computed outside the lock (another thread may have
+    // stored it meanwhile)
+    void insert(Shard& shard, uint64_t key, uint64_t tokenizer_key, int count);
+};
+
+} // namespace token_management
+} // namespace chunking
+} // namespace r3m
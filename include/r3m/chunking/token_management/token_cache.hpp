@@ -1,6 +1,8 @@
 #pragma once
 
 #include "r3m/chunking/tokenizer.hpp"
+#include "r3m/utils/bump_arena.hpp"
+#include "r3m/utils/hash.hpp"
 #include <unordered_map>
 #include <string>
 #include <string_view>
@@ -14,14 +16,17 @@ namespace token_management {
 /**
  * @brief Optimized token cache with string_view for high performance
  * 
- * Provides efficient token counting with caching using string_view
- * for minimal memory overhead and maximum performance.
+ * Keys are views of copies held in a bump arena, whose blocks never move,
+ * so a key stays valid however many entries follow it (until clear()).
+ * Lookups hash with wyhash; a miss counts the caller's view directly and
+ * copies the text once, into the arena. Not thread-safe: one cache per
+ * owner (SharedTokenCache is the cache shared between threads).
  */
 class OptimizedTokenCache {
 private:
-    std::unordered_map<std::string_view, int> cache_;
+    std::unordered_map<std::string_view, int, utils::WyHash> cache_;
     std::shared_ptr<Tokenizer> tokenizer_;
-    std::vector<std::string> string_storage_; // Keep strings alive
+    utils::BumpArena key_storage_; // Key bytes, stable addresses
     
 public:
     /**
@@ -41,6 +46,9 @@ public:
      * @brief Clear the cache
      */
     void clear();
+    
+    size_t size() const { return cache_.size(); }
+    size_t key_bytes() const { return key_storage_.bytes_allocated(); }
 };
 
 /**
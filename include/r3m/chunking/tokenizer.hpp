@@ -1,17 +1,32 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 namespace r3m {
 namespace chunking {
 
+/**
+ * @brief Byte range [begin, end) of one token in the text it came from
+ */
+struct TokenSpan {
+    size_t begin = 0;
+    size_t end = 0;
+    
+    bool operator==(const TokenSpan&) const = default;
+};
+
 /**
  * @brief Base tokenizer interface for chunking operations
  * 
  * Provides token counting and encoding capabilities for document processing.
- * This is the foundation for all chunking operations.
+ * This is the foundation for all chunking operations. Tokenizers with token
+ * ids (BPE, ...) extend it as AdvancedTokenizer; all of them are created by
+ * TokenizerFactory. Implementations must be safe to call concurrently.
  */
 class Tokenizer {
 public:
@@ -25,11 +40,14 @@ public:
     virtual size_t count_tokens(const std::string& text) const = 0;
     
     /**
-     * @brief Encode text into tokens
-     * @param text Input text
-     * @return Vector of token strings
+     * @brief Count tokens in a view (e.g. a chunk slice) without a std::string
+     * 
+     * The default copies into a std::string; tokenizers that can count in
+     * place override it.
      */
-    virtual std::vector<std::string> encode(const std::string& text) const = 0;
+    virtual size_t count_tokens(std::string_view text) const {
+        return count_tokens(std::string(text));
+    }
     
     /**
      * @brief Tokenize text into individual tokens
@@ -38,11 +56,38 @@ public:
      */
     virtual std::vector<std::string> tokenize(const std::string& text) const = 0;
     
+    /**
+     * @brief Byte offsets of the tokens, in order, instead of token strings
+     * 
+     * Lets callers cut the original text at token boundaries without copying
+     * it or losing its spacing. Not capped by get_max_tokens(). The default
+     * looks up each tokenize() result in the text; a token that does not
+     * appear verbatim (normalized by the tokenizer) gets an empty span where
+     * the search stopped.
+     */
+    virtual std::vector<TokenSpan> token_spans(std::string_view text) const;
+    
     /**
      * @brief Get maximum tokens for this tokenizer
      * @return Maximum token limit
      */
     virtual size_t get_max_tokens() const = 0;
+    
+    /**
+     * @brief Identity of this tokenizer's counts in shared caches
+     * 
+     * Unique per instance; a tokenizer whose counts change (new vocabulary)
+     * takes a new key so cached counts of the old one are never returned.
+     */
+    uint64_t cache_key() const { return cache_key_; }
+
+protected:
+    void renew_cache_key() { cache_key_ = next_cache_key(); }
+
+private:
+    static uint64_t next_cache_key();
+    
+    uint64_t cache_key_ = next_cache_key();
 };
 
 /**
@@ -57,8 +102,10 @@ public:
     ~BasicTokenizer() override = default;
     
     size_t count_tokens(const std::string& text) const override;
-    std::vector<std::string> encode(const std::string& text) const override;
+    size_t count_tokens(std::string_view text) const override;
+    std::vector<std::string> encode(const std::string& text) const;
     std::vector<std::string> tokenize(const std::string& text) const override;
+    std::vector<TokenSpan> token_spans(std::string_view text) const override;
     size_t get_max_tokens() const override { return max_tokens_; }
     
 private:
@@ -67,6 +114,10 @@ private:
     // Helper methods
     std::vector<std::string> split_text(const std::string& text) const;
     bool is_punctuation(char c) const;
+    
+    // Calls on_token(begin, end) for each word and punctuation mark
+    template <typename OnToken>
+    void for_each_token(std::string_view text, OnToken&& on_token) const;
 };
 
 /**
@@ -75,11 +126,38 @@ private:
 class TokenizerFactory {
 public:
     enum class Type {
-        BASIC,
-        // Future: BPE, SENTENCEPIECE, etc.
+        BASIC,     // Words and punctuation, SIMD counted (default)
+        SIMPLE,    // Whitespace-separated words
+        SENTENCE,  // Words plus sentence-ending punctuation
+        BPE        // Byte-level BPE (vocab.json / merges.txt)
     };
     
-    static std::unique_ptr<Tokenizer> create(Type type, size_t max_tokens = 8192);
+    static std::shared_ptr<Tokenizer> create(Type type, size_t max_tokens = 8192);
+    
+    /**
+     * @brief Type from its configuration name ("basic", "simple", "sentence", "bpe")
+     * @throws std::invalid_argument for any other name
+     */
+    static Type parse_type(const std::string& name);
+    
+    /**
+     * @brief Create the tokenizer described by the chunking.tokenizer.* settings
+     * 
+     * - chunking.tokenizer.type: basic (default), simple, sentence or bpe
+     * - chunking.tokenizer.max_tokens: count cap of the basic tokenizer (8192)
+     * - chunking.tokenizer.vocab_file / chunking.tokenizer.merges_file: the
+     *   BPE model to load (both required for bpe)
+     * 
+     * @throws std::invalid_argument / std::runtime_error for an unknown type,
+     *         bpe without both model files, or a model that cannot be loaded
+     */
+    static std::shared_ptr<Tokenizer> create_from_config(const std::unordered_map<std::string, std::string>& config);
+    
+    /**
+     * @brief Shorthand for create(parse_type(type)) with default settings
+     *        ("bpe" is the untrained byte-level tokenizer)
+     */
+    static std::shared_ptr<Tokenizer> create_from_config(const std::string& type);
 };
 
 } // namespace chunking
@@ -1,10 +1,20 @@
 #pragma once
 
+#include "r3m/core/config_snapshot.hpp"
+
 #include <string>
 #include <unordered_map>
 #include <memory>
 #include <optional>
 #include <vector>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 
 namespace r3m {
 namespace core {
@@ -13,10 +23,17 @@ namespace core {
  * @brief Configuration Manager - Handles all configuration loading and management
  *
  * Supports:
- * - YAML configuration files
+ * - YAML configuration files (nested mappings flatten to dot notation keys)
  * - Environment variable overrides
  * - Default values
  * - Configuration validation
+ * - Typed snapshots with hot reload
+ *
+ * Precedence, lowest first: load_defaults, the file, then values set
+ * through load_from_map, load_from_environment or set_value. All of them
+ * survive a reload. Every successful load publishes a
+ * new immutable ConfigSnapshot; readers take it with snapshot() and keep
+ * using their copy for as long as they hold it.
  */
 class ConfigManager {
 public:
@@ -47,6 +64,49 @@ public:
      */
     bool load_from_map(const std::unordered_map<std::string, std::string>& config_map);
 
+    /**
+     * @brief Set values used where the file (or an override) has none
+     * @param defaults Map of configuration key-value pairs
+     * @return true if the resulting configuration parses
+     */
+    bool load_defaults(const std::unordered_map<std::string, std::string>& defaults);
+
+    /**
+     * @brief Re-read the file given to load_config and publish a new snapshot
+     * @return true if the file was read and parsed; the old values stay otherwise
+     */
+    bool reload();
+
+    /**
+     * @brief reload() if the file's modification time changed since the last load
+     * @return true if a new snapshot was published
+     */
+    bool reload_if_changed();
+
+    /**
+     * @brief Poll the configuration file from a background thread
+     * @param interval Time between modification checks
+     * @param on_reload Called with each snapshot published by a reload
+     */
+    void watch(std::chrono::milliseconds interval,
+               std::function<void(std::shared_ptr<const ConfigSnapshot>)> on_reload);
+
+    /**
+     * @brief Stop the thread started by watch() (also done on destruction)
+     */
+    void stop_watching();
+
+    /**
+     * @brief Latest published snapshot (lock-free; never null)
+     */
+    std::shared_ptr<const ConfigSnapshot> snapshot() const { return snapshot_.load(); }
+
+    /**
+     * @brief Build and publish a snapshot of the current values
+     * @return false if a value does not parse (the previous snapshot stays)
+     */
+    bool publish_snapshot();
+
     /**
      * @brief Validate configuration
      * @return true if configuration is valid
@@ -93,7 +153,7 @@ public:
     std::vector<std::string> get_string_array(const std::string& key) const;
 
     /**
-     * @brief Set configuration value
+     * @brief Set configuration value (published with the next snapshot)
      * @param key Configuration key
      * @param value String value
      */
@@ -174,11 +234,29 @@ public:
 
 private:
     // Configuration storage
-    std::unordered_map<std::string, std::string> config_values_;
+    mutable std::shared_mutex values_mutex_;
+    std::unordered_map<std::string, std::string> config_values_;  // Defaults, file and overrides merged
+    std::unordered_map<std::string, std::string> defaults_;
+    std::unordered_map<std::string, std::string> file_values_;
+    std::unordered_map<std::string, std::string> overrides_;
     std::string config_file_path_;
+    std::filesystem::file_time_type config_file_time_{};
+
+    // Published snapshots
+    std::atomic<std::shared_ptr<const ConfigSnapshot>> snapshot_;
+    std::atomic<uint64_t> snapshot_version_{0};
+
+    // File watcher
+    std::thread watcher_;
+    std::mutex watcher_mutex_;
+    std::condition_variable watcher_cv_;
+    bool stop_watcher_ = false;
 
     // Private methods
-    bool parse_yaml_file(const std::string& file_path);
+    static bool parse_yaml_file(const std::string& file_path, std::unordered_map<std::string, std::string>& values);
+    bool merge_values(std::unordered_map<std::string, std::string> defaults,
+                      std::unordered_map<std::string, std::string> file_values);
+    void set_override(const std::string& key, const std::string& value);
     bool parse_environment_variables();
     std::string get_env_value(const std::string& key) const;
     std::vector<std::string> split_key(const std::string& key) const;
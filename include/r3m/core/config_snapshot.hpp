@@ -0,0 +1,57 @@
+#pragma once
+
+#include "r3m/quality/assessor.hpp"
+#include "r3m/chunking/advanced_chunker.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace r3m {
+namespace core {
+
+/**
+ * @brief Immutable, fully parsed view of one configuration version
+ *
+ * Built once from the flat key-value map and shared by pointer, so the hot
+ * path reads typed fields instead of looking up and parsing strings per
+ * document. A snapshot never changes after build(); a reload publishes a new
+ * one and work that already holds the old pointer finishes with it.
+ */
+struct ConfigSnapshot {
+    uint64_t version = 0;
+
+    // document_processing.*
+    size_t batch_size = 0;
+    size_t max_workers = 0;
+    bool enable_chunking = false;
+    bool enable_memory_pooling = true;     // Per-worker task arenas
+
+    // document_processing.quality_filtering.*
+    quality::QualityConfig quality;
+
+    // chunking.*
+    chunking::AdvancedChunker::Config chunker;
+
+    // The flat map the snapshot was parsed from, for components that are
+    // still initialized from key-value pairs (pipeline, formats, tokenizer)
+    std::unordered_map<std::string, std::string> values;
+
+    /**
+     * @brief Parse a configuration map into a snapshot
+     * @param values Flat configuration (dot notation keys)
+     * @param version Version number reported by the snapshot
+     * @throws std::invalid_argument or std::out_of_range if a numeric value does not parse
+     */
+    static std::shared_ptr<const ConfigSnapshot> build(std::unordered_map<std::string, std::string> values,
+                                                       uint64_t version = 0);
+
+    /**
+     * @brief Whether other needs a different tokenizer or chunker than this snapshot
+     */
+    bool chunking_differs(const ConfigSnapshot& other) const;
+};
+
+} // namespace core
+} // namespace r3m
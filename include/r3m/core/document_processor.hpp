@@ -1,5 +1,6 @@
 #pragma once
 
+#include "r3m/core/config_snapshot.hpp"
 #include "r3m/processing/pipeline.hpp"
 #include "r3m/quality/assessor.hpp"
 #include "r3m/parallel/optimized_thread_pool.hpp"
@@ -9,6 +10,8 @@
 #include "r3m/chunking/tokenizer.hpp"
 
 #include <string>
+#include <string_view>
+#include <span>
 #include <vector>
 #include <unordered_map>
 #include <chrono>
@@ -24,6 +27,7 @@ struct DocumentResult {
     std::string file_extension;
     size_t file_size = 0;
     std::string text_content;
+    std::vector<formats::TextSection> sections;  // Structural sections of text_content
     std::unordered_map<std::string, std::string> metadata;
     bool processing_success = false;
     std::string error_message;
@@ -63,6 +67,12 @@ struct ProcessingStats {
     double avg_task_time_ms = 0.0;
     double parallel_efficiency = 0.0;
     size_t optimal_batch_size = 0;
+    
+    // Process-wide token-count cache
+    size_t token_cache_hits = 0;
+    size_t token_cache_misses = 0;
+    size_t token_cache_entries = 0;
+    double token_cache_hit_rate = 0.0;
 };
 
 /**
@@ -83,10 +93,24 @@ public:
     
     // Initialize with configuration
     bool initialize(const std::unordered_map<std::string, std::string>& config);
+    bool initialize(std::shared_ptr<const ConfigSnapshot> snapshot);
+    
+    /**
+     * @brief Switch to a newer configuration without stopping
+     * 
+     * Quality filtering and chunking settings take effect for documents
+     * started after the call; documents in flight finish with the snapshot
+     * (and chunker) they started with. A new tokenizer and chunker are built
+     * only if their settings changed. Worker count, pipeline and format
+     * settings are read once by initialize().
+     * @return false if the new chunking components could not be created (nothing changes)
+     */
+    bool apply_config(std::shared_ptr<const ConfigSnapshot> snapshot);
+    std::shared_ptr<const ConfigSnapshot> get_config_snapshot() const { return state_.load()->config; }
     
     // Core processing methods
     DocumentResult process_document(const std::string& file_path);
-    DocumentResult process_document_from_memory(const std::string& file_name, const std::vector<uint8_t>& file_data);
+    DocumentResult process_document_from_memory(const std::string& file_name, std::span<const uint8_t> file_data);
     
     // Parallel processing methods
     std::vector<DocumentResult> process_documents_parallel(const std::vector<std::string>& file_paths);
@@ -95,6 +119,19 @@ public:
     
     // Chunking methods
     chunking::ChunkingResult process_document_with_chunking(const std::string& file_path);
+    
+    /**
+     * @brief Chunk a document without holding its full text in memory
+     * 
+     * Plain text files are read block by block through a memory map and chunks are
+     * handed to on_chunk as soon as they are complete; max_text_length is not
+     * applied. Other formats need the whole document to parse, so they are
+     * processed normally and their chunks replayed through on_chunk.
+     * The returned result carries statistics only (text_content and chunks are empty).
+     */
+    DocumentResult process_document_streaming(const std::string& file_path,
+                                              const chunking::AdvancedChunker::ChunkCallback& on_chunk);
+    
     std::vector<chunking::ChunkingResult> process_documents_with_chunking(const std::vector<std::string>& file_paths);
     
     // Utility methods
@@ -115,31 +152,40 @@ public:
 private:
     // Modular components
     std::unique_ptr<processing::PipelineOrchestrator> pipeline_;
-    std::unique_ptr<quality::QualityAssessor> quality_assessor_;
     std::unique_ptr<formats::FormatProcessor> format_processor_;
     std::unique_ptr<parallel::OptimizedThreadPool> thread_pool_;
     
-    // Configuration
-    std::unordered_map<std::string, std::string> config_;
+    // Configuration and the chunker built from it (null while chunking is
+    // disabled), replaced together by apply_config. Each document loads them
+    // once and passes them down, so a reload never changes either mid-document.
+    struct ProcessingState {
+        std::shared_ptr<const ConfigSnapshot> config;
+        std::shared_ptr<chunking::AdvancedChunker> chunker;
+    };
+    std::atomic<std::shared_ptr<const ProcessingState>> state_;
+    std::mutex reload_mutex_;  // Serializes apply_config
     size_t batch_size_;
     size_t max_workers_;
-    bool enable_chunking_;
     bool initialized_;
     
     // Statistics
     mutable std::mutex stats_mutex_;
     ProcessingStats stats_;
     
-    // Chunking components
-    std::shared_ptr<chunking::Tokenizer> tokenizer_;
-    std::unique_ptr<chunking::AdvancedChunker> chunker_;
-    
     // Private methods
-    void initialize_chunking_components();
-    chunking::AdvancedChunker::Config create_chunker_config();
-    chunking::AdvancedChunker::DocumentInfo create_document_info(const std::string& file_path, const std::string& text_content, const std::unordered_map<std::string, std::string>& metadata);
-    
-    DocumentResult process_single_document(const std::string& file_path);
+    std::shared_ptr<chunking::AdvancedChunker> create_chunker(const ConfigSnapshot& snapshot) const;
+    chunking::AdvancedChunker::DocumentInfo create_document_info(const std::string& file_path, std::string&& text_content, std::unordered_map<std::string, std::string>&& metadata, const std::vector<formats::TextSection>& sections, const chunking::Tokenizer& tokenizer);
+    chunking::ChunkingResult chunk_processed_document(const std::string& file_path, DocumentResult& result,
+                                                      chunking::AdvancedChunker& chunker);
+    void attach_chunks(const std::string& file_path, DocumentResult& result, chunking::AdvancedChunker* chunker);
+    
+    DocumentResult process_document(const std::string& file_path, const ProcessingState& state);
+    DocumentResult process_single_document(const std::string& file_path, const ConfigSnapshot& config);
+    DocumentResult process_single_buffer(const std::string& file_name, std::string_view data, const ConfigSnapshot& config);
+    DocumentResult begin_result(const std::string& file_path) const;
+    void complete_document(DocumentResult& result, std::string&& text_content, const ConfigSnapshot& config);
+    bool should_filter_document(const DocumentResult& result, const ConfigSnapshot& config) const;
+    void finish_result(DocumentResult& result);
     void update_stats(const DocumentResult& result);
     
     // Performance optimization methods
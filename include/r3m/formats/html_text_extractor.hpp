@@ -0,0 +1,38 @@
+#pragma once
+
+#include "r3m/formats/text_section.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace r3m {
+namespace formats {
+
+/**
+ * @brief Single-pass HTML to text extractor
+ *
+ * Scans the raw bytes at the HTML tokenizer level instead of building a DOM,
+ * so no state beyond the output grows with the document. Text is emitted
+ * with character references decoded; comments, doctypes and the contents of
+ * script, style, noscript and other non-rendered raw-text elements are
+ * skipped.
+ *
+ * Block-level elements (p, h1-h6, li, tr, div, ...) end the current block.
+ * Blocks are separated by a blank line and can be reported as TextSections,
+ * anchored at the id of the element that opened them or "block=<n>". Table
+ * cells are separated by a space and <br> by a newline.
+ */
+class HtmlTextExtractor {
+public:
+    /**
+     * @brief Extract the visible text of a document
+     * @param html Document bytes (need not be NUL-terminated)
+     * @param blocks Receives the start of each block in the result (optional)
+     * @return Extracted text
+     */
+    static std::string extract(std::string_view html, std::vector<TextSection>* blocks = nullptr);
+};
+
+} // namespace formats
+} // namespace r3m
@@ -1,10 +1,17 @@
 #pragma once
 
+#include "r3m/formats/text_section.hpp"
+
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 
 namespace r3m {
+namespace parallel {
+class OptimizedThreadPool;
+}
+
 namespace formats {
 
 enum class FileType {
@@ -21,6 +28,15 @@ public:
 
     bool initialize(const std::unordered_map<std::string, std::string>& config);
     
+    /**
+     * @brief Pool for page-parallel PDF extraction
+     * 
+     * Large PDFs are split into page ranges that run as a fork/join on the
+     * pool, each range on its own poppler document. nullptr (the default)
+     * extracts every page on the calling thread.
+     */
+    void set_thread_pool(parallel::OptimizedThreadPool* pool);
+    
     // Format detection and processing
     FileType detect_file_type(const std::string& file_path) const;
     std::string get_file_extension(const std::string& file_path) const;
@@ -28,9 +44,21 @@ public:
     std::vector<std::string> get_supported_extensions() const;
     
     // Text extraction for different formats
-    std::string process_plain_text(const std::string& file_path);
-    std::string process_pdf(const std::string& file_path);
-    std::string process_html(const std::string& file_path);
+    std::string process_plain_text(const std::string& file_path, size_t max_length = std::string::npos);
+    // PDF text is UTF-8 with pages separated by blank lines, HTML text has its
+    // blocks separated by blank lines; sections (if given) receives where each
+    // page ("page=<n>") or block starts in the result
+    std::string process_pdf(const std::string& file_path, std::vector<TextSection>* sections = nullptr);
+    std::string process_html(const std::string& file_path, std::vector<TextSection>* sections = nullptr);
+    
+    // Section boundaries of plain text: Markdown structure for .md / .mdx,
+    // paragraphs for .txt; other plain text formats stay a single section
+    void split_sections(const std::string& file_path, std::string_view text, std::vector<TextSection>& sections) const;
+    
+    // Text extraction from in-memory buffers (no temporary files)
+    std::string process_plain_text_from_memory(std::string_view data);
+    std::string process_pdf_from_memory(std::string_view data, std::vector<TextSection>* sections = nullptr);
+    std::string process_html_from_memory(std::string_view data, std::vector<TextSection>* sections = nullptr);
     
     // Text cleaning and normalization
     std::string normalize_whitespace(const std::string& text);
@@ -43,6 +71,8 @@ private:
     std::vector<std::string> plain_text_extensions_;
     std::vector<std::string> pdf_extensions_;
     std::vector<std::string> html_extensions_;
+    std::vector<std::string> markdown_extensions_;
+    std::vector<std::string> paragraph_extensions_;
     
     // Configuration settings
     bool encoding_detection_;
@@ -50,8 +80,7 @@ private:
     bool remove_html_tags_;
     bool normalize_whitespace_;
     
-    // Helper function for HTML processing
-    void extract_text_from_node(void* node, std::string& text);
+    parallel::OptimizedThreadPool* thread_pool_ = nullptr; // Not owned
 };
 
 } // namespace formats
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "r3m/formats/text_section.hpp"
+
+#include <string_view>
+#include <vector>
+
+namespace r3m {
+namespace formats {
+
+/**
+ * @brief Structural section boundaries for text formats
+ *
+ * Finds where sections start in a single scan over the lines of the raw
+ * text, before it is cleaned (cleaning collapses the blank lines and line
+ * starts the structure is read from). Nothing is copied: the result is one
+ * TextSection per section, like the pages and blocks of PDF and HTML.
+ */
+class SectionSplitter {
+public:
+    /**
+     * @brief Markdown: a section per heading and per fenced code block
+     *
+     * ATX (#) and setext (=== / ---) headings start a section anchored at
+     * the heading's slug ("getting-started", "getting-started-1" for the
+     * second one). A fenced block (``` or ~~~) is a section of its own, so a
+     * heading-like line inside it never splits it. Text before the first
+     * heading or after a fence is anchored "section=<n>".
+     */
+    static void split_markdown(std::string_view text, std::vector<TextSection>& sections);
+
+    /**
+     * @brief Plain text: a section per paragraph (runs of non-blank lines)
+     *
+     * Paragraphs are anchored "para=<n>"; lines holding only whitespace
+     * separate them.
+     */
+    static void split_paragraphs(std::string_view text, std::vector<TextSection>& sections);
+};
+
+} // namespace formats
+} // namespace r3m
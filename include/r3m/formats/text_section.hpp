@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace r3m {
+namespace formats {
+
+/**
+ * @brief Start of a structural section (PDF page, HTML block) in extracted text
+ *
+ * The offset is kept in step with the text when it is cleaned; the anchor is
+ * appended to the document link ("<file>#<anchor>") of the section's chunks.
+ */
+struct TextSection {
+    size_t offset = 0;
+    std::string anchor;
+    
+    bool operator==(const TextSection&) const = default;
+};
+
+} // namespace formats
+} // namespace r3m
@@ -1,7 +1,9 @@
 #pragma once
 
+#include "r3m/parallel/work_stealing_deque.hpp"
+
 #include <thread>
-#include <queue>
+#include <deque>
 #include <mutex>
 #include <condition_variable>
 #include <functional>
@@ -9,7 +11,12 @@
 #include <atomic>
 #include <vector>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <type_traits>
+#include <stdexcept>
+#include <cstdint>
+#include <cstdlib>
 
 #ifdef __linux__
 #include <pthread.h>
@@ -25,20 +32,28 @@ namespace parallel {
  * Implements advanced parallel processing optimizations:
  * - Single pool strategy to avoid dual thread pool conflicts
  * - Thread affinity for better cache locality
- * - Work stealing for improved load balancing
- * - Memory pooling to reduce allocation overhead
+ * - Work stealing: each worker owns a lock-free Chase–Lev deque. Tasks
+ *   submitted from inside a worker go onto that worker's deque; tasks from
+ *   other threads go through a shared injection queue. Idle workers steal
+ *   from random victims.
+ * - Targeted wakeups: idle workers park on their own condition variable and
+ *   a submit wakes at most one of them, and only when no worker is already
+ *   searching for work (avoids the thundering herd of a shared queue)
+ * - Memory pooling: each worker owns a monotonic arena that serves
+ *   utils::task_memory_resource() while it runs a task and is released in
+ *   one step when the task returns
  * - Optimal batch sizing based on CPU cores
  */
 class OptimizedThreadPool {
 public:
-    explicit OptimizedThreadPool(size_t num_threads = 0);
+    explicit OptimizedThreadPool(size_t num_threads = 0, bool memory_pooling = true);
     ~OptimizedThreadPool();
     
     // Disable copy constructor and assignment
     OptimizedThreadPool(const OptimizedThreadPool&) = delete;
     OptimizedThreadPool& operator=(const OptimizedThreadPool&) = delete;
     
-    // Submit single task
+    // Submit single task (onto the caller's deque when called from a worker)
     template<typename F, typename... Args>
     auto submit(F&& f, Args&&... args) -> std::future<typename std::invoke_result_t<F, Args...>>;
     
@@ -46,15 +61,33 @@ public:
     template<typename F>
     auto submit_batch(const std::vector<std::function<F()>>& tasks) -> std::vector<std::future<F>>;
     
-    // Get current queue size
+    /**
+     * @brief Fork/join over the index range [0, count)
+     * 
+     * The range is cut into blocks of grain indices that idle workers claim
+     * one at a time; the calling thread claims blocks too and returns once
+     * every block has finished. Safe to call from inside a pool task (nested
+     * fork/join never blocks on queued work). The first exception thrown by
+     * body is rethrown in the caller.
+     */
+    void parallel_for(size_t count, size_t grain, const std::function<void(size_t begin, size_t end)>& body);
+    
+    // Get current queue size (approximate while workers run)
     size_t get_queue_size() const;
     
     // Check if shutdown
     bool is_shutdown() const;
     
-    // Shutdown the thread pool
+    // Shutdown the thread pool (queued tasks are run first)
     void shutdown();
     
+    // Scheduler statistics
+    size_t get_thread_count() const { return threads_.size(); }
+    size_t get_tasks_processed() const;
+    size_t get_work_steals() const;
+    double get_average_task_time_ms() const;
+    bool has_memory_pooling() const { return memory_pooling_; }
+    
     // Get optimal batch size based on CPU cores
     static size_t get_optimal_batch_size();
     
@@ -62,67 +95,129 @@ public:
     static void disable_library_parallelism();
 
 private:
+    // Type-erased task; the deques hold raw pointers, ownership passes to the runner
+    struct Task {
+        virtual ~Task() = default;
+        virtual void run() = 0;
+    };
+    
+    template<typename F>
+    struct TaskImpl final : Task {
+        explicit TaskImpl(F&& f) : fn(std::move(f)) {}
+        void run() override { fn(); }
+        F fn;
+    };
+    
+    // Queue a task: local deque from a worker, injection queue otherwise
+    void enqueue(std::unique_ptr<Task> task);
+    
     // Thread worker function
     void worker_thread(size_t thread_id);
     
     // Set thread affinity for better cache locality
     void set_thread_affinity(size_t thread_id);
     
+    // Take work from the injection queue, then from random victims
+    Task* find_task(size_t thread_id);
+    Task* take_injected(size_t thread_id);
+    
     // Work stealing implementation
-    std::function<void()> steal_task(size_t thread_id);
+    Task* steal_task(size_t thread_id);
+    
+    // Whether any queue holds work (used before parking)
+    bool has_pending_work() const;
+    
+    // Wake one parked worker unless a worker is already searching
+    void wake_idle_worker();
     
-    // Memory pool for reducing allocation overhead
-    class MemoryPool {
+    // Park until woken; returns true if woken by wake_idle_worker (the worker
+    // is then counted as searching), false if work or shutdown was found first
+    bool park(size_t thread_id, bool searching);
+    
+    void run_task(size_t thread_id, Task* task);
+    
+    /**
+     * Per-worker monotonic arena for task temporaries. Allocation bumps a
+     * pointer in a preallocated block (overflow blocks come from the heap),
+     * deallocation is a no-op, and release() drops everything at once while
+     * keeping the initial block. A task that overflowed grows the initial
+     * block to its high-water mark (up to MAX_MEMORY_POOL_SIZE), so steady
+     * state needs no heap calls and touches no new pages; a grown block
+     * shrinks back to the peak of the last MEMORY_POOL_SHRINK_WINDOW tasks
+     * (at least MEMORY_POOL_SIZE). Used only by its own worker thread.
+     */
+    class MemoryPool final : public std::pmr::memory_resource {
     public:
-        MemoryPool(size_t pool_size = 1024 * 1024); // 1MB default
-        ~MemoryPool();
+        explicit MemoryPool(size_t pool_size = MEMORY_POOL_SIZE);
         
-        void* allocate(size_t size);
-        void deallocate(void* ptr);
+        // Free everything allocated since the last release
+        void release();
+        
+        size_t capacity() const { return block_size_; }
         
     private:
-        struct Block {
-            void* data;
-            size_t size;
-            bool used;
-        };
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+        
+        void reset_block(size_t size);
         
-        std::vector<Block> blocks_;
-        std::mutex pool_mutex_;
+        // Block that fits used bytes plus headroom for alignment padding
+        static size_t block_size_for(size_t used);
+        
+        std::unique_ptr<std::byte[]> initial_block_;
+        size_t block_size_ = 0;
+        std::optional<std::pmr::monotonic_buffer_resource> arena_;
+        size_t bytes_since_release_ = 0;
+        size_t recent_peak_ = 0;             // Largest task since the last resize
+        size_t releases_since_resize_ = 0;
     };
     
-    // Thread-local storage for memory pools
-    struct ThreadLocalData {
+    // Per-worker state, cache-line aligned so workers don't share lines
+    struct alignas(64) ThreadLocalData {
         std::unique_ptr<MemoryPool> memory_pool;
-        std::queue<std::function<void()>> local_queue;
-        std::mutex local_mutex;
+        WorkStealingDeque<Task*> deque;
+        
+        // Parking slot: only this worker waits on it
+        std::mutex park_mutex;
+        std::condition_variable park_cv;
+        bool notified = false;
+        
+        // Statistics, written by this worker only
+        std::atomic<size_t> tasks_processed{0};
+        std::atomic<size_t> work_steals{0};
+        std::atomic<uint64_t> task_time_ns{0};
+        
+        uint64_t rng_state;
         
-        ThreadLocalData() : memory_pool(std::make_unique<MemoryPool>()) {}
+        ThreadLocalData(uint64_t seed, bool memory_pooling)
+            : memory_pool(memory_pooling ? std::make_unique<MemoryPool>() : nullptr), rng_state(seed) {}
     };
     
     // Member variables
     std::vector<std::thread> threads_;
     std::vector<std::unique_ptr<ThreadLocalData>> thread_data_;
     
-    // Global task queue (for work stealing)
-    std::queue<std::function<void()>> global_queue_;
+    // Injection queue for tasks submitted from outside the pool
+    std::deque<Task*> global_queue_;
     mutable std::mutex queue_mutex_;
-    std::condition_variable condition_;
+    std::atomic<size_t> global_queue_size_{0};
+    
+    // Parking: ids of parked workers, and how many workers are searching
+    std::mutex sleep_mutex_;
+    std::vector<size_t> sleepers_;
+    std::atomic<size_t> num_sleeping_{0};
+    std::atomic<size_t> num_searching_{0};
     
     // Control variables
     std::atomic<bool> shutdown_{false};
-    std::atomic<size_t> active_tasks_{0};
-    
-    // Performance monitoring
-    mutable std::mutex stats_mutex_;
-    size_t total_tasks_processed_{0};
-    std::atomic<size_t> work_steals_{0};
-    double avg_task_time_ms_{0.0};
+    bool memory_pooling_;
     
     // Optimal configuration
-    static constexpr size_t MAX_QUEUE_SIZE = 10000;
-    static constexpr size_t WORK_STEAL_THRESHOLD = 5;
+    static constexpr size_t MAX_INJECT_BATCH = 32;   // Tasks moved from the injection queue at once
     static constexpr size_t MEMORY_POOL_SIZE = 1024 * 1024; // 1MB per thread
+    static constexpr size_t MAX_MEMORY_POOL_SIZE = 8 * 1024 * 1024; // Largest retained block
+    static constexpr size_t MEMORY_POOL_SHRINK_WINDOW = 16; // Tasks between shrink checks
 };
 
 // Template implementations
@@ -130,23 +225,12 @@ template<typename F, typename... Args>
 auto OptimizedThreadPool::submit(F&& f, Args&&... args) -> std::future<typename std::invoke_result_t<F, Args...>> {
     using return_type = typename std::invoke_result_t<F, Args...>;
     
-    auto task = std::make_shared<std::packaged_task<return_type()>>(
+    std::packaged_task<return_type()> task(
         std::bind(std::forward<F>(f), std::forward<Args>(args)...)
     );
     
-    std::future<return_type> result = task->get_future();
-    
-    {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
-        if (shutdown_) {
-            throw std::runtime_error("ThreadPool is shutdown");
-        }
-        
-        global_queue_.emplace([task]() { (*task)(); });
-        active_tasks_.fetch_add(1);
-    }
-    
-    condition_.notify_one();
+    std::future<return_type> result = task.get_future();
+    enqueue(std::make_unique<TaskImpl<std::packaged_task<return_type()>>>(std::move(task)));
     return result;
 }
 
@@ -162,6 +246,18 @@ auto OptimizedThreadPool::submit_batch(const std::vector<std::function<F()>>& ta
     return futures;
 }
 
+/**
+ * @brief parallel_for on pool, or a plain loop when there is no pool
+ */
+inline void parallel_for(OptimizedThreadPool* pool, size_t count, size_t grain,
+                         const std::function<void(size_t begin, size_t end)>& body) {
+    if (pool && count > grain) {
+        pool->parallel_for(count, grain, body);
+    } else if (count > 0) {
+        body(0, count);
+    }
+}
+
 // Static methods
 inline size_t OptimizedThreadPool::get_optimal_batch_size() {
     size_t cpu_cores = std::thread::hardware_concurrency();
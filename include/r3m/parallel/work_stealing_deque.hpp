@@ -0,0 +1,150 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace r3m {
+namespace parallel {
+
+/**
+ * @brief Lock-free Chase–Lev work-stealing deque
+ *
+ * The owning worker pushes and pops at the bottom (LIFO, cache-warm); any
+ * other thread may steal from the top (FIFO, oldest and usually largest work).
+ * Only the owner may call push() and pop(). Follows the C11 formulation of
+ * Lê, Pop, Cohen and Zappa Nardelli, "Correct and Efficient Work-Stealing for
+ * Weak Memory Models" (PPoPP 2013).
+ *
+ * T must be a pointer type; nullptr is returned when no element is available.
+ * Arrays replaced on growth are kept until the deque is destroyed, because a
+ * concurrent thief may still be reading from them.
+ */
+template<typename T>
+class WorkStealingDeque {
+    static_assert(std::is_pointer_v<T>, "WorkStealingDeque stores pointers");
+
+public:
+    explicit WorkStealingDeque(size_t initial_capacity = 1024)
+        : array_(new Array(round_up_pow2(initial_capacity))) {
+        arrays_.emplace_back(array_.load(std::memory_order_relaxed));
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only
+    void push(T item) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        Array* a = array_.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(a->capacity) - 1) {
+            a = grow(a, t, b);
+        }
+        a->put(b, item);
+        // Release store (rather than a release fence plus relaxed store) so
+        // thieves acquiring bottom_ also see the task the pointer refers to
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    // Owner only
+    T pop() {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* a = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            // Empty
+            bottom_.store(b + 1, std::memory_order_release);
+            return nullptr;
+        }
+
+        T item = a->get(b);
+        if (t == b) {
+            // Last element: race thieves for it
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_release);
+        }
+        return item;
+    }
+
+    // Any thread; returns nullptr when empty or when another thief won the race
+    T steal() {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+
+        if (t >= b) {
+            return nullptr;
+        }
+
+        Array* a = array_.load(std::memory_order_acquire);
+        T item = a->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    // Approximate when called concurrently
+    size_t size() const {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:
+    struct Array {
+        size_t capacity;
+        size_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+
+        explicit Array(size_t cap) : capacity(cap), mask(cap - 1), slots(new std::atomic<T>[cap]) {}
+
+        T get(int64_t index) const {
+            return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+        }
+        void put(int64_t index, T item) {
+            slots[static_cast<size_t>(index) & mask].store(item, std::memory_order_relaxed);
+        }
+    };
+
+    static size_t round_up_pow2(size_t n) {
+        size_t cap = 2;
+        while (cap < n) {
+            cap <<= 1;
+        }
+        return cap;
+    }
+
+    Array* grow(Array* old, int64_t t, int64_t b) {
+        auto bigger = std::make_unique<Array>(old->capacity * 2);
+        for (int64_t i = t; i < b; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        Array* next = bigger.get();
+        arrays_.push_back(std::move(bigger));
+        array_.store(next, std::memory_order_release);
+        return next;
+    }
+
+    // Owner (bottom) and thieves (top) on separate cache lines
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    alignas(64) std::atomic<Array*> array_;
+    std::vector<std::unique_ptr<Array>> arrays_;  // Owner only; retired arrays live until destruction
+};
+
+} // namespace parallel
+} // namespace r3m
@@ -1,10 +1,12 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <chrono>
 #include <memory>
+#include <mutex>
 #include "r3m/formats/processor.hpp"
 
 namespace r3m {
@@ -38,12 +40,26 @@ public:
 
     bool initialize(const std::unordered_map<std::string, std::string>& config);
     
-    // Pipeline coordination
-    bool validate_file(const std::string& file_path, PipelineStage& stage);
-    bool extract_text(const std::string& file_path, PipelineStage& stage, std::string& text_content);
-    bool clean_text(std::string& text_content, PipelineStage& stage);
+    // Pool for page-parallel PDF extraction (nullptr: calling thread)
+    void set_thread_pool(parallel::OptimizedThreadPool* pool);
+    
+    // Pipeline coordination. sections receives the start of each PDF page,
+    // HTML block, Markdown heading / fenced block or text paragraph (empty for
+    // other formats); clean_text keeps it in step with the cleaned text.
+    // Streaming callers pass enforce_size_limit = false: they map the file
+    // and never hold it whole, so max_file_size does not apply.
+    bool validate_file(const std::string& file_path, PipelineStage& stage, bool enforce_size_limit = true);
+    bool extract_text(const std::string& file_path, PipelineStage& stage, std::string& text_content,
+                      std::vector<formats::TextSection>* sections = nullptr);
+    bool clean_text(std::string& text_content, PipelineStage& stage, std::vector<formats::TextSection>* sections = nullptr);
     bool extract_metadata(const std::string& file_path, PipelineStage& stage, std::unordered_map<std::string, std::string>& metadata);
     
+    // In-memory pipeline stages (file_name is only used for type detection and metadata)
+    bool validate_buffer(const std::string& file_name, size_t data_size, PipelineStage& stage);
+    bool extract_text_from_memory(const std::string& file_name, std::string_view data, PipelineStage& stage, std::string& text_content,
+                                  std::vector<formats::TextSection>* sections = nullptr);
+    bool extract_metadata_from_memory(const std::string& file_name, size_t data_size, PipelineStage& stage, std::unordered_map<std::string, std::string>& metadata);
+    
     // Metrics and statistics
     PipelineMetrics get_metrics() const;
     void update_metrics(const PipelineStage& stage, bool success, size_t text_length = 0);
@@ -65,6 +81,9 @@ private:
     bool remove_html_tags_;
     bool normalize_whitespace_;
     bool extract_metadata_;
+    
+    // Shared post-extraction checks (empty content, max_text_length_)
+    bool finish_extraction(const std::string& source, PipelineStage& stage, std::string& text_content);
 };
 
 } // namespace processing
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace r3m {
@@ -15,6 +16,53 @@ struct QualityMetrics {
     size_t unique_words = 0;
     size_t sentence_count = 0;
     size_t technical_terms = 0;
+    bool unique_words_estimated = false;  // unique_words is a sketch estimate
+};
+
+// Counts gathered from a document in a single pass
+struct TextCounts {
+    size_t text_length = 0;
+    size_t unique_words = 0;      // Distinct words after trimming non-alphanumeric ends
+    size_t sentence_count = 0;    // Number of '.', '!' and '?' characters
+    size_t technical_terms = 0;   // Words containing a digit or one of _-.#@
+    bool unique_words_estimated = false;  // unique_words came from a sketch
+};
+
+// Weights of the content quality score (quality_filtering.quality_weights.*)
+struct QualityWeights {
+    double length_factor = 0.3;
+    double word_diversity_factor = 0.3;
+    double sentence_structure_factor = 0.2;
+    double information_density_factor = 0.2;
+};
+
+// Weights of the information density (quality_filtering.density_weights.*)
+struct DensityWeights {
+    double unique_word_ratio = 0.4;
+    double technical_term_density = 0.3;
+    double sentence_complexity = 0.3;
+};
+
+// How distinct words are counted (quality_filtering.unique_words.*)
+struct UniqueWordCounting {
+    enum class Mode {
+        AUTO,         // Exact below approximate_threshold bytes, sketch from there on
+        EXACT,        // Hash set of every distinct word
+        APPROXIMATE   // HyperLogLog sketch: memory independent of vocabulary size
+    };
+    
+    Mode mode = Mode::AUTO;
+    size_t approximate_threshold = 2 * 1024 * 1024;  // Bytes
+    double approximate_error = 0.01;                 // Relative standard error of the sketch
+};
+
+// Normalization constants (quality_filtering.quality_thresholds.*)
+struct QualityThresholds {
+    double length_normalization = 1000.0;
+    double word_diversity_normalization = 5.0;
+    double sentence_normalization = 10.0;
+    double technical_term_normalization = 10.0;
+    double sentence_complexity_normalization = 100.0;
 };
 
 struct QualityConfig {
@@ -25,6 +73,10 @@ struct QualityConfig {
     size_t max_content_length = 1000000;
     bool filter_empty_documents = true;
     bool filter_low_quality_documents = true;
+    QualityWeights quality_weights;
+    DensityWeights density_weights;
+    QualityThresholds thresholds;
+    UniqueWordCounting unique_words;
 };
 
 class QualityAssessor {
@@ -34,27 +86,38 @@ public:
 
     bool initialize(const std::unordered_map<std::string, std::string>& config);
     
+    // Parse document_processing.quality_filtering.* (throws if a number does not parse)
+    static QualityConfig parse_config(const std::unordered_map<std::string, std::string>& config);
+    
     // Quality assessment
     QualityMetrics assess_quality(const std::string& text_content);
     bool filter_document(const QualityMetrics& metrics) const;
     bool is_high_quality_content(const QualityMetrics& metrics) const;
     
+    // Same, against an explicit configuration instead of the one given to initialize
+    static QualityMetrics assess_quality(std::string_view text_content, const QualityConfig& config);
+    static bool filter_document(const QualityMetrics& metrics, const QualityConfig& config);
+    static bool is_high_quality_content(const QualityMetrics& metrics, const QualityConfig& config);
+    
     // Quality calculations
     double calculate_content_quality_score(const std::string& text);
     double calculate_information_density(const std::string& text);
     
+    // Word, sentence and technical-term counts in one pass over text; words
+    // are split on whitespace exactly as TextUtils::get_unique_words does.
+    // Distinct words are counted as counting says (exactly by default).
+    static TextCounts count_text(std::string_view text, const UniqueWordCounting& counting = {UniqueWordCounting::Mode::EXACT});
+    
     // Configuration
     QualityConfig get_config() const { return config_; }
 
 private:
     QualityConfig config_;
-    std::unordered_map<std::string, std::string> config_map_; // Store full config for weights/thresholds
     
-    // Helper methods for quality calculation
-    size_t count_unique_words(const std::string& text);
-    size_t count_sentences(const std::string& text);
-    size_t count_technical_terms(const std::string& text);
-    std::string determine_quality_reason(const QualityMetrics& metrics);
+    // Scores computed from counts already gathered by count_text
+    static double content_quality_score(const TextCounts& counts, const QualityConfig& config);
+    static double information_density(const TextCounts& counts, const QualityConfig& config);
+    static std::string determine_quality_reason(const QualityMetrics& metrics, const QualityConfig& config);
 };
 
 } // namespace quality
@@ -31,6 +31,9 @@ public:
     api::Config get_config() const { return config_; }
 
 private:
+    static constexpr const char* CONFIG_PATH = "configs/dev/config.yaml";
+    static constexpr std::chrono::seconds CONFIG_RELOAD_INTERVAL{2};
+    
     // Server components
     api::Config config_;
     std::shared_ptr<core::DocumentProcessor> processor_;
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace r3m::utils {
+
+/**
+ * @brief Bump-pointer arena with stable addresses
+ *
+ * Memory comes from a list of blocks that are never moved or resized, so
+ * pointers and views into the arena stay valid until reset(). Allocation
+ * bumps an offset in the current block; blocks double from INITIAL_BLOCK_SIZE
+ * up to MAX_BLOCK_SIZE, and requests larger than that get a block of their
+ * own. Individual allocations are never freed.
+ */
+class BumpArena {
+public:
+    static constexpr size_t INITIAL_BLOCK_SIZE = 4 * 1024;       // 4KB
+    static constexpr size_t MAX_BLOCK_SIZE = 1024 * 1024;        // 1MB
+
+    BumpArena() = default;
+    BumpArena(const BumpArena&) = delete;
+    BumpArena& operator=(const BumpArena&) = delete;
+    BumpArena(BumpArena&&) noexcept = default;
+    BumpArena& operator=(BumpArena&&) noexcept = default;
+
+    /**
+     * @brief Allocate size bytes aligned to alignment (a power of two)
+     */
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * @brief Copy text into the arena and return a view of the copy
+     */
+    std::string_view store(std::string_view text);
+
+    /**
+     * @brief Release every block (invalidates all pointers into the arena)
+     */
+    void reset();
+
+    size_t bytes_allocated() const { return bytes_allocated_; }  // Requested bytes
+    size_t bytes_reserved() const { return bytes_reserved_; }    // Block capacity
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        size_t size = 0;
+    };
+
+    std::vector<Block> blocks_;
+    std::byte* cursor_ = nullptr;
+    std::byte* end_ = nullptr;
+    size_t next_block_size_ = INITIAL_BLOCK_SIZE;
+    size_t bytes_allocated_ = 0;
+    size_t bytes_reserved_ = 0;
+
+    void add_block(size_t min_size);
+};
+
+} // namespace r3m::utils
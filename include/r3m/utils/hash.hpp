@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace r3m::utils {
+
+/**
+ * @brief wyhash (final version 4): fast 64-bit non-cryptographic hash
+ *
+ * Used to key caches by content. Values are not stable across platforms of
+ * different endianness, so they must not be persisted.
+ */
+namespace wyhash_detail {
+
+inline constexpr uint64_t SECRET[4] = {
+    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull
+};
+
+inline void mum(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(r);
+    b = static_cast<uint64_t>(r >> 64);
+#else
+    uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a), lb = static_cast<uint32_t>(b);
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+    a = lo;
+    b = hi;
+#endif
+}
+
+inline uint64_t mix(uint64_t a, uint64_t b) {
+    mum(a, b);
+    return a ^ b;
+}
+
+inline uint64_t read8(const uint8_t* p) {
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline uint64_t read4(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline uint64_t read3(const uint8_t* p, size_t k) {
+    return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+} // namespace wyhash_detail
+
+inline uint64_t wyhash(const void* key, size_t len, uint64_t seed = 0) {
+    using namespace wyhash_detail;
+    const uint8_t* p = static_cast<const uint8_t*>(key);
+    seed ^= mix(seed ^ SECRET[0], SECRET[1]);
+    uint64_t a;
+    uint64_t b;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (read4(p) << 32) | read4(p + ((len >> 3) << 2));
+            b = (read4(p + len - 4) << 32) | read4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = read3(p, len);
+            b = 0;
+        } else {
+            a = b = 0;
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed;
+            uint64_t see2 = seed;
+            do {
+                seed = mix(read8(p) ^ SECRET[1], read8(p + 8) ^ seed);
+                see1 = mix(read8(p + 16) ^ SECRET[2], read8(p + 24) ^ see1);
+                see2 = mix(read8(p + 32) ^ SECRET[3], read8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = mix(read8(p) ^ SECRET[1], read8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = read8(p + i - 16);
+        b = read8(p + i - 8);
+    }
+    a ^= SECRET[1];
+    b ^= seed;
+    mum(a, b);
+    return mix(a ^ SECRET[0] ^ len, b ^ SECRET[1]);
+}
+
+inline uint64_t wyhash(std::string_view text, uint64_t seed = 0) {
+    return wyhash(text.data(), text.size(), seed);
+}
+
+/**
+ * @brief Hash functor for string_view-keyed unordered containers
+ */
+struct WyHash {
+    size_t operator()(std::string_view text) const { return static_cast<size_t>(wyhash(text)); }
+};
+
+} // namespace r3m::utils
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace r3m::utils {
+
+/**
+ * @brief HyperLogLog distinct-count sketch over 64-bit hashes
+ *
+ * Estimates how many distinct values were added using 2^precision one-byte
+ * registers, independent of how many values or distinct values there are.
+ * The relative standard error is about 1.04 / sqrt(2^precision); small
+ * counts use linear counting and are close to exact. Callers hash their
+ * values (wyhash for words) and add the hashes.
+ */
+class HyperLogLog {
+public:
+    static constexpr int MIN_PRECISION = 4;
+    static constexpr int MAX_PRECISION = 18;     // 256KB of registers
+
+    /**
+     * @brief Sketch with the smallest precision whose standard error is at most relative_error
+     * @param relative_error Target relative standard error (clamped to the supported precisions)
+     */
+    explicit HyperLogLog(double relative_error);
+
+    /**
+     * @brief Precision for a target relative standard error
+     */
+    static int precision_for_error(double relative_error);
+
+    void add_hash(uint64_t hash) {
+        const size_t index = static_cast<size_t>(hash >> (64 - precision_));
+        const uint64_t rest = hash << precision_;
+        // Position of the first set bit in the remaining bits (a zero rest
+        // gets the largest rank)
+        const uint8_t rank = rest == 0 ? static_cast<uint8_t>(64 - precision_ + 1)
+                                       : static_cast<uint8_t>(std::countl_zero(rest) + 1);
+        if (rank > registers_[index]) {
+            registers_[index] = rank;
+        }
+    }
+
+    /**
+     * @brief Estimated number of distinct hashes added
+     */
+    size_t estimate() const;
+
+    /**
+     * @brief Expected relative standard error of estimate()
+     */
+    double standard_error() const;
+
+    int precision() const { return precision_; }
+    size_t memory_bytes() const { return registers_.size(); }
+
+    void clear();
+
+private:
+    int precision_;
+    std::vector<uint8_t> registers_;
+};
+
+} // namespace r3m::utils
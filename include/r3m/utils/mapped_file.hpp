@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+namespace r3m::utils {
+
+/**
+ * @brief Read-only view of a file's bytes backed by mmap
+ *
+ * Large files are mapped with MADV_SEQUENTIAL so extraction can read them
+ * through a std::string_view without copying them into a stream first.
+ * Files below MMAP_THRESHOLD are read into an owned buffer instead, where a
+ * single read() is cheaper than setting up a mapping.
+ */
+class MappedFile {
+public:
+    static constexpr size_t MMAP_THRESHOLD = 64 * 1024;  // 64KB
+
+    /**
+     * @brief Open and map (or read) a file
+     * @param file_path Path of the file to open
+     * @throws std::runtime_error if the file cannot be opened or read
+     */
+    explicit MappedFile(const std::string& file_path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * @brief View over the file contents (valid while this object lives)
+     */
+    std::string_view view() const { return std::string_view(data_, size_); }
+
+    size_t size() const { return size_; }
+    bool is_mapped() const { return mapped_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    std::string buffer_;  // Small-file fallback storage
+
+    void release();
+};
+
+} // namespace r3m::utils
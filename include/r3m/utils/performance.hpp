@@ -171,6 +171,7 @@ public:
     // Static utility functions
     static double get_current_time_ms();
     static size_t get_current_memory_usage();
+    static size_t get_page_faults();  // Minor + major page faults of the process so far
     static std::string format_time(double milliseconds);
     static std::string format_memory(size_t bytes);
     static std::string format_throughput(double operations_per_second);
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace r3m::utils {
+
+/**
+ * @brief Instruction sets SIMDUtils has kernels for
+ */
+enum class SIMDIsa {
+    Scalar,
+    SSE42,
+    AVX2,
+    AVX512BW,
+    NEON
+};
+
+/**
+ * @brief 256-entry byte set laid out for nibble-lookup membership tests
+ *
+ * Bit (hi & 7) of rows[lo] is set when byte (hi << 4 | lo) is a member;
+ * low_rows covers bytes below 0x80 and high_rows the rest. Kept trivial (no
+ * member initializers) so kernel translation units emit no shared inline code
+ * for it; value-initialize with ByteSet{}.
+ */
+struct ByteSet {
+    uint8_t low_rows[16];
+    uint8_t high_rows[16];
+};
+
+/**
+ * @brief Table of text-scanning kernels compiled for one instruction set
+ *
+ * Each ISA's kernels live in their own translation unit built with that ISA's
+ * compiler flags (src/utils/simd_kernels_*.cpp), so no other code is compiled
+ * for instructions the host may lack. SIMDUtils picks one table at startup from
+ * cpuid and calls through it. All kernels return identical results.
+ *
+ * Bitmap outputs hold bit (i % 64) of word (i / 64) for position i and must
+ * have room for (len + 63) / 64 words; bits past len are cleared.
+ */
+struct SIMDKernels {
+    const char* name;
+    SIMDIsa isa;
+
+    // Occurrences of target
+    size_t (*count_byte)(const char* data, size_t len, char target);
+
+    // Bytes that are members of set
+    size_t (*count_set)(const char* data, size_t len, const ByteSet& set);
+
+    // Bitmap of bytes that are members of set
+    void (*set_mask)(const char* data, size_t len, const ByteSet& set, uint64_t* bits);
+
+    // Bitmap of positions i < len with data[i] == first and data[i + 1] == second
+    // (reads data[len])
+    void (*pair_mask)(const char* data, size_t len, char first, char second, uint64_t* bits);
+
+    // Offset of the first occurrence of pattern, or SIZE_MAX
+    size_t (*find_substring)(const char* data, size_t len, const char* pattern, size_t pattern_len);
+
+    // Word tokens: runs of bytes in neither set, plus one per punctuation byte.
+    // in_word carries the state across consecutive calls.
+    size_t (*count_word_tokens)(const char* data, size_t len, const ByteSet& spaces,
+                                const ByteSet& punctuation, bool* in_word);
+};
+
+// Kernel tables, defined by the per-ISA translation units that are compiled in
+extern const SIMDKernels scalar_kernels;
+#if defined(R3M_SSE42_ENABLED)
+extern const SIMDKernels sse42_kernels;
+#endif
+#if defined(R3M_AVX2_ENABLED)
+extern const SIMDKernels avx2_kernels;
+#endif
+#if defined(R3M_AVX512_ENABLED)
+extern const SIMDKernels avx512bw_kernels;
+#endif
+#if defined(R3M_SIMD_ARM_ENABLED)
+extern const SIMDKernels neon_kernels;
+#endif
+
+} // namespace r3m::utils
@@ -1,17 +1,11 @@
 #pragma once
 
+#include "r3m/utils/simd_kernels.hpp"
+
 #include <string>
+#include <string_view>
 #include <vector>
 
-// Cross-platform SIMD support
-#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
-    #include <immintrin.h>  // x86 intrinsics
-    #define R3M_SIMD_X86_AVAILABLE
-#elif defined(__aarch64__) || defined(__arm64__)
-    #include <arm_neon.h>   // ARM NEON intrinsics
-    #define R3M_SIMD_ARM_AVAILABLE
-#endif
-
 namespace r3m::utils {
 
 class SIMDUtils {
@@ -34,6 +28,10 @@ public:
     // SIMD-optimized token counting (approximate)
     static size_t count_tokens_simd(const std::string& text);
     
+    // Exact BasicTokenizer token count: whitespace-separated words, with each
+    // punctuation character a token of its own (no max_tokens cap applied)
+    static size_t count_word_tokens_simd(std::string_view text);
+    
     // SIMD-optimized string splitting by delimiter
     static std::vector<std::string> split_by_delimiter_simd(const std::string& text, char delimiter);
     
@@ -49,15 +47,24 @@ public:
     // Text normalization for vector search
     static std::string normalize_for_search_simd(const std::string& text);
     
-    // Check if CPU supports SIMD
+    // Check if the active kernels use SIMD instructions
     static bool supports_simd();
     
-    // Check if CPU supports AVX2 (x86 only)
+    // Check if the host CPU can run the AVX2 kernels (x86 only)
     static bool supports_avx2();
     
-    // Check if CPU supports AVX-512 (x86 only)
+    // Check if the host CPU can run the AVX-512BW kernels (x86 only)
     static bool supports_avx512();
     
+    // Kernel table selected once at startup: the widest instruction set that is
+    // both compiled in and reported by cpuid. The R3M_SIMD_ISA environment
+    // variable (scalar, sse4.2, avx2, avx512bw, neon) can force a narrower one.
+    static const SIMDKernels& kernels();
+    
+    // Kernels for a specific instruction set, or nullptr if they are not
+    // compiled in or the host CPU lacks the instructions
+    static const SIMDKernels* kernels_for(SIMDIsa isa);
+    
     // Scalar fallback implementations for testing
     static size_t count_char_scalar(const std::string& text, char target);
     static size_t find_substring_scalar(const std::string& text, const std::string& pattern);
@@ -65,6 +72,7 @@ public:
     static size_t count_punctuation_scalar(const std::string& text);
     static std::string clean_text_scalar(const std::string& text, const std::vector<char>& chars_to_remove);
     static size_t count_tokens_scalar(const std::string& text);
+    static size_t count_word_tokens_scalar(std::string_view text);
     static std::vector<std::string> split_by_delimiter_scalar(const std::string& text, char delimiter);
     
     // BPE and advanced text processing scalar fallbacks
@@ -72,10 +80,6 @@ public:
     static std::vector<size_t> find_sentence_boundaries_scalar(const std::string& text);
     static std::vector<size_t> find_pattern_scalar(const std::string& text, const std::string& pattern);
     static std::string normalize_for_search_scalar(const std::string& text);
-
-private:
-    // Helper function to verify CPU capabilities
-    static void check_cpu_support();
 };
 
 } // namespace r3m::utils 
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory_resource>
+
+namespace r3m::utils {
+
+/**
+ * @brief Memory resource for temporaries of the task running on this thread
+ *
+ * Inside an OptimizedThreadPool task (with memory pooling enabled) this is the
+ * worker's monotonic arena, which is released in one step when the task
+ * returns; on any other thread it is std::pmr::get_default_resource(). Only
+ * allocations that are gone before the enclosing function returns may use it:
+ * nothing that ends up in a result, a cache, or data shared with other tasks.
+ * Nothing is reclaimed before the task ends, so use it for a few temporaries
+ * per document, not for ones created per chunk or per block.
+ */
+std::pmr::memory_resource* task_memory_resource();
+
+/**
+ * @brief Makes resource this thread's task memory resource for the scope's lifetime
+ *
+ * A null resource selects the default resource. Scopes nest; the previous
+ * resource is restored on destruction.
+ */
+class TaskMemoryScope {
+public:
+    explicit TaskMemoryScope(std::pmr::memory_resource* resource);
+    ~TaskMemoryScope();
+
+    TaskMemoryScope(const TaskMemoryScope&) = delete;
+    TaskMemoryScope& operator=(const TaskMemoryScope&) = delete;
+
+private:
+    std::pmr::memory_resource* previous_;
+};
+
+} // namespace r3m::utils
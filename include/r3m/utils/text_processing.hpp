@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <regex>
 #include <utility>
@@ -14,7 +15,11 @@ public:
     
     // Core text processing functions
     static std::string clean_text(const std::string& text);
+    // clean_text(text) == text without building the string
+    static bool is_clean_text(std::string_view text);
     static std::string shared_precompare_cleanup(const std::string& text);
+    // shared_precompare_cleanup(text).length() without building the string
+    static size_t precompare_cleanup_length(std::string_view text);
     static std::string remove_punctuation(const std::string& text);
     static std::string replace_whitespaces_with_space(const std::string& text);
     static std::string escape_newlines(const std::string& text);
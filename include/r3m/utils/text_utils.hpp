@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <regex>
 #include <algorithm>
@@ -17,6 +18,13 @@ public:
     static std::string clean_text_content(const std::string& text);
     static std::string trim_whitespace(const std::string& text);
     
+    // Single forward pass equivalent to remove_html_tags (if strip_html_tags),
+    // normalize_whitespace (if collapse_whitespace) and clean_text_content, in
+    // that order, with byte-identical output. offsets (sorted positions in
+    // text, e.g. page starts) are updated to the matching positions in the result.
+    static std::string clean_document_text(std::string_view text, bool strip_html_tags, bool collapse_whitespace,
+                                           std::vector<size_t>* offsets = nullptr);
+    
     // Text analysis
     static std::vector<std::string> split_into_words(const std::string& text);
     static std::set<std::string> get_unique_words(const std::string& text);
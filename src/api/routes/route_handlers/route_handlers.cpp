@@ -2,8 +2,6 @@
 #include "r3m/api/routes/response_handler/response_handler.hpp"
 #include "r3m/api/routes/serialization/serializer.hpp"
 #include "r3m/utils/text_utils.hpp"
-#include <filesystem>
-#include <fstream>
 #include <iostream>
 
 #ifdef R3M_HTTP_ENABLED
@@ -34,35 +32,26 @@ crow::response handle_process_document(const crow::request& req, std::shared_ptr
         }
         
         // Extract file path or content
-        std::string file_path;
+        core::DocumentResult result;
         if (body.has("file_path")) {
-            file_path = body["file_path"].s();
+            std::string file_path = body["file_path"].s();
+            std::cout << "Processing file: " << file_path << std::endl;
+            result = processor->process_document(file_path);
         } else if (body.has("file_content")) {
-            // Save uploaded content to data directory
-            std::string filename = "upload_" + response_handler::generate_job_id() + ".txt";
-            file_path = "data/" + filename;
+            // Process uploaded content directly from the request buffer
+            std::string file_name = body.has("file_name") ? std::string(body["file_name"].s())
+                                                          : "upload_" + response_handler::generate_job_id() + ".txt";
+            std::string content = body["file_content"].s();
             
-            // Create data directory if it doesn't exist
-            std::filesystem::create_directories("data");
-            
-            std::ofstream file(file_path);
-            if (!file.is_open()) {
-                res.code = 500;
-                res.body = response_handler::create_response(false, "Failed to save uploaded file");
-                return res;
-            }
-            file << body["file_content"].s();
-            file.close();
+            std::cout << "Processing uploaded content: " << file_name << std::endl;
+            result = processor->process_document_from_memory(file_name, std::span<const uint8_t>(
+                reinterpret_cast<const uint8_t*>(content.data()), content.size()));
         } else {
             res.code = 400;
             res.body = response_handler::create_response(false, "Missing file_path or file_content");
             return res;
         }
         
-        // Process the document
-        std::cout << "Processing file: " << file_path << std::endl;
-        auto result = processor->process_document(file_path);
-        
         // Create response with chunking information
         std::string response_data = serialization::serialize_document_result_with_chunks(result);
         
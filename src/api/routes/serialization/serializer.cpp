@@ -43,11 +43,11 @@ std::string serialize_document_result_with_chunks(const core::DocumentResult& re
         if (!first_chunk) response_data += ",";
         response_data += "{";
         response_data += "\"chunk_id\":" + std::to_string(chunk.chunk_id) + ",";
-        response_data += "\"content\":\"" + json_utils::escape_json_string(chunk.content) + "\",";
-        response_data += "\"blurb\":\"" + json_utils::escape_json_string(chunk.blurb) + "\",";
-        response_data += "\"title_prefix\":\"" + json_utils::escape_json_string(chunk.title_prefix) + "\",";
-        response_data += "\"metadata_suffix_semantic\":\"" + json_utils::escape_json_string(chunk.metadata_suffix_semantic) + "\",";
-        response_data += "\"metadata_suffix_keyword\":\"" + json_utils::escape_json_string(chunk.metadata_suffix_keyword) + "\",";
+        response_data += "\"content\":\"" + json_utils::escape_json_string(chunk.content.str()) + "\",";
+        response_data += "\"blurb\":\"" + json_utils::escape_json_string(chunk.blurb.str()) + "\",";
+        response_data += "\"title_prefix\":\"" + json_utils::escape_json_string(chunk.title_prefix.str()) + "\",";
+        response_data += "\"metadata_suffix_semantic\":\"" + json_utils::escape_json_string(chunk.metadata_suffix_semantic.str()) + "\",";
+        response_data += "\"metadata_suffix_keyword\":\"" + json_utils::escape_json_string(chunk.metadata_suffix_keyword.str()) + "\",";
         response_data += "\"quality_score\":" + std::to_string(chunk.quality_score) + ",";
         response_data += "\"information_density\":" + std::to_string(chunk.information_density) + ",";
         response_data += "\"is_high_quality\":" + std::string(chunk.is_high_quality ? "true" : "false") + ",";
@@ -115,11 +115,11 @@ std::string serialize_batch_results_with_chunks(const std::vector<core::Document
             if (!first_chunk) response_data += ",";
             response_data += "{";
             response_data += "\"chunk_id\":" + std::to_string(chunk.chunk_id) + ",";
-            response_data += "\"content\":\"" + json_utils::escape_json_string(chunk.content) + "\",";
-            response_data += "\"blurb\":\"" + json_utils::escape_json_string(chunk.blurb) + "\",";
-            response_data += "\"title_prefix\":\"" + json_utils::escape_json_string(chunk.title_prefix) + "\",";
-            response_data += "\"metadata_suffix_semantic\":\"" + json_utils::escape_json_string(chunk.metadata_suffix_semantic) + "\",";
-            response_data += "\"metadata_suffix_keyword\":\"" + json_utils::escape_json_string(chunk.metadata_suffix_keyword) + "\",";
+            response_data += "\"content\":\"" + json_utils::escape_json_string(chunk.content.str()) + "\",";
+            response_data += "\"blurb\":\"" + json_utils::escape_json_string(chunk.blurb.str()) + "\",";
+            response_data += "\"title_prefix\":\"" + json_utils::escape_json_string(chunk.title_prefix.str()) + "\",";
+            response_data += "\"metadata_suffix_semantic\":\"" + json_utils::escape_json_string(chunk.metadata_suffix_semantic.str()) + "\",";
+            response_data += "\"metadata_suffix_keyword\":\"" + json_utils::escape_json_string(chunk.metadata_suffix_keyword.str()) + "\",";
             response_data += "\"quality_score\":" + std::to_string(chunk.quality_score) + ",";
             response_data += "\"information_density\":" + std::to_string(chunk.information_density) + ",";
             response_data += "\"is_high_quality\":" + std::string(chunk.is_high_quality ? "true" : "false") + ",";
@@ -156,11 +156,11 @@ std::string serialize_chunking_result(const chunking::ChunkingResult& result) {
         if (!first_chunk) response_data += ",";
         response_data += "{";
         response_data += "\"chunk_id\":" + std::to_string(chunk.chunk_id) + ",";
-        response_data += "\"content\":\"" + json_utils::escape_json_string(chunk.content) + "\",";
-        response_data += "\"blurb\":\"" + json_utils::escape_json_string(chunk.blurb) + "\",";
-        response_data += "\"title_prefix\":\"" + json_utils::escape_json_string(chunk.title_prefix) + "\",";
-        response_data += "\"metadata_suffix_semantic\":\"" + json_utils::escape_json_string(chunk.metadata_suffix_semantic) + "\",";
-        response_data += "\"metadata_suffix_keyword\":\"" + json_utils::escape_json_string(chunk.metadata_suffix_keyword) + "\",";
+        response_data += "\"content\":\"" + json_utils::escape_json_string(chunk.content.str()) + "\",";
+        response_data += "\"blurb\":\"" + json_utils::escape_json_string(chunk.blurb.str()) + "\",";
+        response_data += "\"title_prefix\":\"" + json_utils::escape_json_string(chunk.title_prefix.str()) + "\",";
+        response_data += "\"metadata_suffix_semantic\":\"" + json_utils::escape_json_string(chunk.metadata_suffix_semantic.str()) + "\",";
+        response_data += "\"metadata_suffix_keyword\":\"" + json_utils::escape_json_string(chunk.metadata_suffix_keyword.str()) + "\",";
         response_data += "\"quality_score\":" + std::to_string(chunk.quality_score) + ",";
         response_data += "\"information_density\":" + std::to_string(chunk.information_density) + ",";
         response_data += "\"is_high_quality\":" + std::string(chunk.is_high_quality ? "true" : "false") + ",";
@@ -198,7 +198,10 @@ std::string serialize_performance_metrics(const core::ProcessingStats& stats) {
     response_data += "\"filtered_out\":" + std::to_string(stats.filtered_out) + ",";
     response_data += "\"avg_processing_time_ms\":" + std::to_string(stats.avg_processing_time_ms) + ",";
     response_data += "\"total_text_extracted\":" + std::to_string(stats.total_text_extracted) + ",";
-    response_data += "\"avg_content_quality_score\":" + std::to_string(stats.avg_content_quality_score);
+    response_data += "\"avg_content_quality_score\":" + std::to_string(stats.avg_content_quality_score) + ",";
+    response_data += "\"token_cache_hits\":" + std::to_string(stats.token_cache_hits) + ",";
+    response_data += "\"token_cache_misses\":" + std::to_string(stats.token_cache_misses) + ",";
+    response_data += "\"token_cache_hit_rate\":" + std::to_string(stats.token_cache_hit_rate);
     response_data += "}";
     return response_data;
 }
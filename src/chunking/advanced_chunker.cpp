@@ -1,5 +1,6 @@
 #include "r3m/chunking/advanced_chunker.hpp"
 #include "r3m/utils/text_processing.hpp"
+#include "r3m/utils/task_memory.hpp"
 #include <algorithm>
 #include <sstream>
 #include <chrono>
@@ -9,12 +10,13 @@
 namespace r3m {
 namespace chunking {
 
-
+// Chunks per fork/join block: a chunk takes tens of microseconds to score,
+// so blocks of this size keep scheduling overhead small
+static constexpr size_t PARALLEL_CHUNK_GRAIN = 8;
 
 AdvancedChunker::AdvancedChunker(std::shared_ptr<Tokenizer> tokenizer, const Config& config)
     : tokenizer_(tokenizer), config_(config), 
-      token_cache_(std::make_unique<token_management::TokenCache>(tokenizer)),
-      optimized_cache_(std::make_unique<token_management::OptimizedTokenCache>(tokenizer)),
+      token_counts_(&token_management::SharedTokenCache::instance()),
       section_processor_(std::make_unique<section_processing::SectionProcessor>(tokenizer)) {
     initialize_components();
 }
@@ -40,6 +42,7 @@ void AdvancedChunker::initialize_components() {
         multipass_chunker_ = std::make_unique<MultipassChunker>(
             tokenizer_, true, true, config_.mini_chunk_size, config_.large_chunk_ratio, config_.chunk_token_limit
         );
+        multipass_chunker_->set_thread_pool(thread_pool_);
     }
     
     if (config_.enable_contextual_rag) {
@@ -52,10 +55,6 @@ void AdvancedChunker::initialize_components() {
 ChunkingResult AdvancedChunker::process_document(const DocumentInfo& document) {
     auto start_time = std::chrono::high_resolution_clock::now();
     
-    // Clear caches for fresh start
-    token_cache_->clear();
-    optimized_cache_->clear();
-    
     ChunkingResult result;
     
     try {
@@ -65,13 +64,15 @@ ChunkingResult AdvancedChunker::process_document(const DocumentInfo& document) {
         // Step 2: Process sections
         auto chunks = process_sections(document, token_result);
         
-        // Step 3: Apply quality filtering
-        chunks = apply_quality_filtering(chunks);
+        // Step 3: Score chunks in parallel, then apply quality filtering
+        score_chunks(chunks);
+        chunks = apply_quality_filtering(std::move(chunks));
         
         // Step 4: Apply multipass indexing if enabled
         if (config_.enable_multipass && multipass_chunker_) {
             auto large_chunks = multipass_chunker_->generate_large_chunks(chunks);
-            chunks.insert(chunks.end(), large_chunks.begin(), large_chunks.end());
+            chunks.insert(chunks.end(), std::make_move_iterator(large_chunks.begin()),
+                          std::make_move_iterator(large_chunks.end()));
         }
         
         // Step 5: Apply contextual RAG if enabled
@@ -80,24 +81,33 @@ ChunkingResult AdvancedChunker::process_document(const DocumentInfo& document) {
         }
         
         // Step 6: Calculate final statistics
-        result.chunks = chunks;
         result.total_chunks = chunks.size();
         result.successful_chunks = chunks.size();
         result.failed_chunks = 0;
     
-    // Calculate quality metrics
-    double total_quality = 0.0;
-    double total_density = 0.0;
-    size_t high_quality_count = 0;
-    
-        for (const auto& chunk : chunks) {
-        total_quality += chunk.quality_score;
-        total_density += chunk.information_density;
+        // Count content tokens in parallel; sums are taken in chunk order
+        std::pmr::vector<size_t> content_tokens(chunks.size(), utils::task_memory_resource());
+        parallel::parallel_for(thread_pool_, chunks.size(), PARALLEL_CHUNK_GRAIN,
+            [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    content_tokens[i] = tokenizer_->count_tokens(chunks[i].content.view());
+                }
+            });
+        
+        // Calculate quality metrics
+        double total_quality = 0.0;
+        double total_density = 0.0;
+        size_t high_quality_count = 0;
+        
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            const auto& chunk = chunks[i];
+            total_quality += chunk.quality_score;
+            total_density += chunk.information_density;
             if (chunk.is_high_quality) high_quality_count++;
             
             result.total_title_tokens += chunk.title_tokens;
             result.total_metadata_tokens += chunk.metadata_tokens;
-            result.total_content_tokens += static_cast<size_t>(tokenizer_->count_tokens(chunk.content));
+            result.total_content_tokens += content_tokens[i];
             result.total_rag_tokens += chunk.contextual_rag_reserved_tokens;
         }
         
@@ -106,6 +116,7 @@ ChunkingResult AdvancedChunker::process_document(const DocumentInfo& document) {
             result.avg_information_density = total_density / chunks.size();
         }
         result.high_quality_chunks = high_quality_count;
+        result.chunks = std::move(chunks);
         
     } catch (const std::exception& e) {
         result.failed_chunks = 1;
@@ -130,13 +141,163 @@ std::vector<ChunkingResult> AdvancedChunker::process_documents(const std::vector
     return results;
 }
 
+ChunkingResult AdvancedChunker::process_document_stream(
+    const DocumentInfo& document,
+    const BlockSource& next_block,
+    const ChunkCallback& on_chunk) {
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    ChunkingResult result;
+    double total_quality = 0.0;
+    double total_density = 0.0;
+    
+    try {
+        // The document length is unknown up front: unless the caller supplied
+        // total_tokens, assume it spans more than one chunk.
+        int doc_tokens = document.total_tokens > 0 ? document.total_tokens : config_.chunk_token_limit + 1;
+        auto token_result = manage_tokens(document, doc_tokens);
+        
+        const bool use_large_chunks = config_.enable_multipass && multipass_chunker_;
+        const size_t large_chunk_ratio = static_cast<size_t>(std::max(1, config_.large_chunk_ratio));
+        std::vector<DocumentChunk> large_window;
+        int large_chunk_id = 0;
+        
+        // Contextual RAG only applies once the document is known to span two or
+        // more chunks, so the first chunk is held back until a second one arrives.
+        std::vector<DocumentChunk> held_chunks;
+        bool multi_chunk = false;
+        SharedText doc_summary;  // One buffer shared by every chunk
+        
+        auto deliver = [&](DocumentChunk&& chunk) {
+            total_quality += chunk.quality_score;
+            total_density += chunk.information_density;
+            if (chunk.is_high_quality) result.high_quality_chunks++;
+            
+            result.total_title_tokens += chunk.title_tokens;
+            result.total_metadata_tokens += chunk.metadata_tokens;
+            result.total_content_tokens += static_cast<size_t>(tokenizer_->count_tokens(chunk.content));
+            result.total_rag_tokens += chunk.contextual_rag_reserved_tokens;
+            result.total_chunks++;
+            result.successful_chunks++;
+            
+            on_chunk(std::move(chunk));
+        };
+        
+        auto add_context = [&](DocumentChunk& chunk) {
+            chunk.contextual_rag_reserved_tokens = config_.contextual_rag_reserved_tokens;
+            chunk.doc_summary = doc_summary;
+            chunk.chunk_context = contextual_rag_->is_chunk_summary_enabled()
+                ? contextual_rag_->generate_chunk_context(chunk, doc_summary) : "";
+        };
+        
+        auto contextualize_and_deliver = [&](DocumentChunk&& chunk) {
+            if (!config_.enable_contextual_rag || !contextual_rag_) {
+                deliver(std::move(chunk));
+                return;
+            }
+            if (!multi_chunk) {
+                held_chunks.push_back(std::move(chunk));
+                if (held_chunks.size() < 2) {
+                    return;
+                }
+                multi_chunk = true;
+                if (contextual_rag_->is_document_summary_enabled()) {
+                    doc_summary = contextual_rag_->generate_document_summary(held_chunks);
+                }
+                for (auto& held : held_chunks) {
+                    add_context(held);
+                    deliver(std::move(held));
+                }
+                held_chunks.clear();
+                return;
+            }
+            add_context(chunk);
+            deliver(std::move(chunk));
+        };
+        
+        auto flush_large_window = [&]() {
+            if (large_window.empty()) return;
+            auto large_chunks = multipass_chunker_->generate_large_chunks(large_window);
+            large_window.clear();
+            for (auto& large_chunk : large_chunks) {
+                large_chunk.chunk_id = large_chunk_id;
+                large_chunk.large_chunk_id = large_chunk_id;
+                large_chunk_id++;
+                contextualize_and_deliver(std::move(large_chunk));
+            }
+        };
+        
+        section_processing::SectionProcessor::CombineStream stream(
+            *section_processor_, token_result, document.document_id,
+            document.source_type, document.semantic_identifier,
+            [&](DocumentChunk&& chunk) {
+                if (!passes_quality_filter(chunk)) {
+                    return;
+                }
+                if (use_large_chunks) {
+                    large_window.push_back(chunk);
+                }
+                contextualize_and_deliver(std::move(chunk));
+                if (use_large_chunks && large_window.size() >= large_chunk_ratio) {
+                    flush_large_window();
+                }
+            });
+        
+        section_processing::DocumentSection block;
+        while (next_block(block)) {
+            stream.add_section(block);
+            block = section_processing::DocumentSection();
+        }
+        stream.finish();
+        
+        if (use_large_chunks) {
+            flush_large_window();
+        }
+        
+        // A document that produced a single chunk gets no contextual RAG
+        for (auto& held : held_chunks) {
+            held.contextual_rag_reserved_tokens = 0;
+            held.doc_summary.clear();
+            held.chunk_context.clear();
+            deliver(std::move(held));
+        }
+        
+        if (result.total_chunks > 0) {
+            result.avg_quality_score = total_quality / result.total_chunks;
+            result.avg_information_density = total_density / result.total_chunks;
+        }
+        result.failed_chunks = 0;
+        
+    } catch (const std::exception& e) {
+        result.failed_chunks = 1;
+        result.successful_chunks = 0;
+    }
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
+    result.processing_time_ms = duration.count() / 1000.0;
+    
+    return result;
+}
+
 section_processing::TokenManagementResult AdvancedChunker::manage_tokens(const DocumentInfo& document) {
+    int doc_tokens = 0;
+    if (config_.enable_contextual_rag) {
+        // Prefer the precomputed document count so callers need not duplicate the text in full_content
+        doc_tokens = document.total_tokens > 0 ? document.total_tokens
+                                               : static_cast<int>(tokenizer_->count_tokens(document.full_content));
+    }
+    return manage_tokens(document, doc_tokens);
+}
+
+section_processing::TokenManagementResult AdvancedChunker::manage_tokens(const DocumentInfo& document, int doc_tokens) {
     section_processing::TokenManagementResult result;
     
     // Step 1: Extract title blurb
     std::string title_blurb = extract_title_blurb(document.title);
     result.title_prefix = title_blurb.empty() ? "" : title_blurb + "\n";
-    result.title_tokens = static_cast<int>(tokenizer_->count_tokens(result.title_prefix));
+    result.title_tokens = token_counts_->get_token_count(*tokenizer_, result.title_prefix);
     
     // Step 2: Process metadata
     if (config_.include_metadata && !document.metadata.empty()) {
@@ -144,9 +305,9 @@ section_processing::TokenManagementResult AdvancedChunker::manage_tokens(const D
             document.metadata, true
         );
         
-        result.metadata_suffix_semantic = metadata_result.first;
-        result.metadata_suffix_keyword = metadata_result.second;
-        result.metadata_tokens = optimized_cache_->get_token_count(result.metadata_suffix_semantic);
+        result.metadata_suffix_semantic = std::move(metadata_result.first);
+        result.metadata_suffix_keyword = std::move(metadata_result.second);
+        result.metadata_tokens = token_counts_->get_token_count(*tokenizer_, result.metadata_suffix_semantic);
         
         // Check if metadata is too large
         if (MetadataProcessor::is_metadata_too_large(result.metadata_tokens, config_.chunk_token_limit)) {
@@ -158,7 +319,6 @@ section_processing::TokenManagementResult AdvancedChunker::manage_tokens(const D
     
     // Step 3: Check if document fits in single chunk
     if (config_.enable_contextual_rag) {
-        int doc_tokens = optimized_cache_->get_token_count(document.full_content);
         result.single_chunk_fits = (doc_tokens + result.title_tokens + result.metadata_tokens <= config_.chunk_token_limit);
         
         // Expand context size based on whether chunk context and doc summary are used
@@ -201,53 +361,61 @@ std::vector<DocumentChunk> AdvancedChunker::process_sections(
     const DocumentInfo& document,
     const section_processing::TokenManagementResult& token_result) {
     
-    // Use the section processor for advanced section combination logic
+    // Use the section processor for advanced section combination logic;
+    // chunks are scored afterwards in one parallel pass
     return section_processor_->process_sections_with_combinations(
         document.sections, token_result, document.document_id, 
-        document.source_type, document.semantic_identifier
+        document.source_type, document.semantic_identifier, false, document.full_content
     );
 }
 
+void AdvancedChunker::score_chunks(std::vector<DocumentChunk>& chunks) {
+    parallel::parallel_for(thread_pool_, chunks.size(), PARALLEL_CHUNK_GRAIN,
+        [&chunks](size_t begin, size_t end) {
+            // Each task scores its range in one batch
+            std::vector<std::string_view> texts;
+            texts.reserve(end - begin);
+            for (size_t i = begin; i < end; ++i) {
+                texts.push_back(chunks[i].content.view());
+            }
+            std::vector<quality_assessment::ChunkQuality> scores(texts.size());
+            quality_assessment::QualityCalculator::score_batch(texts, scores);
+            for (size_t i = begin; i < end; ++i) {
+                section_processing::SectionProcessor::apply_quality(chunks[i], scores[i - begin]);
+            }
+        });
+}
+
+
 
 
 
+std::vector<DocumentChunk> AdvancedChunker::apply_quality_filtering(std::vector<DocumentChunk> chunks) {
+    chunks.erase(std::remove_if(chunks.begin(), chunks.end(),
+                                [this](const DocumentChunk& chunk) { return !passes_quality_filter(chunk); }),
+                 chunks.end());
+    return chunks;
+}
 
-std::vector<DocumentChunk> AdvancedChunker::apply_quality_filtering(const std::vector<DocumentChunk>& chunks) {
-    std::vector<DocumentChunk> filtered_chunks;
+bool AdvancedChunker::passes_quality_filter(const DocumentChunk& chunk) const {
+    // Check minimum content length
+    if (chunk.content.length() < 50) {
+        return false;
+    }
     
-    for (const auto& chunk : chunks) {
-        // Basic quality checks
-        bool is_valid = true;
-        
-        // Check minimum content length
-        if (chunk.content.length() < 50) {
-            is_valid = false;
-        }
-        
-        // Check quality score
-        if (chunk.quality_score < 0.3) {
-            is_valid = false;
-        }
-        
-        // Check information density
-        if (chunk.information_density < 0.1) {
-            is_valid = false;
-        }
-        
-        if (is_valid) {
-            filtered_chunks.push_back(chunk);
-        }
+    // Check quality score
+    if (chunk.quality_score < 0.3) {
+        return false;
     }
     
-    return filtered_chunks;
+    // Check information density
+    if (chunk.information_density < 0.1) {
+        return false;
+    }
+    
+    return true;
 }
 
-void AdvancedChunker::calculate_chunk_quality(DocumentChunk& chunk) {
-    // Calculate quality score using the quality calculator
-    chunk.quality_score = quality_assessment::QualityCalculator::calculate_quality_score(chunk.content);
-    chunk.information_density = quality_assessment::QualityCalculator::calculate_information_density(chunk.content);
-    chunk.is_high_quality = chunk.quality_score >= 0.7;
-}
 
 
 
@@ -256,11 +424,18 @@ void AdvancedChunker::update_config(const Config& config) {
     initialize_components();
 }
 
-void AdvancedChunker::clear_cache() {
-    if (token_cache_) {
-        token_cache_->clear();
+void AdvancedChunker::set_thread_pool(parallel::OptimizedThreadPool* pool) {
+    thread_pool_ = pool;
+    if (multipass_chunker_) {
+        multipass_chunker_->set_thread_pool(pool);
     }
 }
 
+void AdvancedChunker::clear_cache() {
+    // The cache is shared with other chunkers and threads: only this
+    // tokenizer's counts are dropped
+    token_counts_->clear(*tokenizer_);
+}
+
 } // namespace chunking
 } // namespace r3m 
\ No newline at end of file
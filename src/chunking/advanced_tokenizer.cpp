@@ -3,14 +3,42 @@
 #include "r3m/utils/simd_utils.hpp"
 #include <sstream>
 #include <algorithm>
+#include <cctype>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <functional>
+#include <stdexcept>
+#include <queue>
+#include <cstdint>
 
 namespace r3m::chunking {
 
+namespace {
+
+// Spans of the whitespace-separated words in text[begin, end), skipping
+// words that clean_text() removes entirely (as the >> / clean_text loops do)
+void append_word_spans(std::string_view text, size_t begin, size_t end, std::vector<TokenSpan>& spans) {
+    size_t pos = begin;
+    while (pos < end) {
+        while (pos < end && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            ++pos;
+        }
+        size_t word_begin = pos;
+        while (pos < end && !std::isspace(static_cast<unsigned char>(text[pos]))) {
+            ++pos;
+        }
+        if (pos > word_begin &&
+            !r3m::utils::TextProcessing::clean_text(std::string(text.substr(word_begin, pos - word_begin))).empty()) {
+            spans.push_back({word_begin, pos});
+        }
+    }
+}
+
+} // namespace
+
 // SimpleTokenizer implementation
-std::vector<int> SimpleTokenizer::encode(const std::string& text) {
+std::vector<int> SimpleTokenizer::encode(const std::string& text) const {
     auto tokens = split_text(text);
     std::vector<int> encoded;
     encoded.reserve(tokens.size());
@@ -22,11 +50,17 @@ std::vector<int> SimpleTokenizer::encode(const std::string& text) {
     return encoded;
 }
 
-std::vector<std::string> SimpleTokenizer::tokenize(const std::string& text) {
+std::vector<std::string> SimpleTokenizer::tokenize(const std::string& text) const {
     return split_text(text);
 }
 
-std::string SimpleTokenizer::decode(const std::vector<int>& tokens) {
+std::vector<TokenSpan> SimpleTokenizer::token_spans(std::string_view text) const {
+    std::vector<TokenSpan> spans;
+    append_word_spans(text, 0, text.size(), spans);
+    return spans;
+}
+
+std::string SimpleTokenizer::decode(const std::vector<int>& tokens) const {
     // Simple implementation - in practice you'd maintain a reverse mapping
     std::string result;
     for (int token_id : tokens) {
@@ -36,11 +70,11 @@ std::string SimpleTokenizer::decode(const std::vector<int>& tokens) {
     return result;
 }
 
-int SimpleTokenizer::count_tokens(const std::string& text) {
-    return static_cast<int>(split_text(text).size());
+size_t SimpleTokenizer::count_tokens(const std::string& text) const {
+    return split_text(text).size();
 }
 
-std::vector<std::string> SimpleTokenizer::split_text(const std::string& text) {
+std::vector<std::string> SimpleTokenizer::split_text(const std::string& text) const {
     std::vector<std::string> tokens;
     std::istringstream iss(text);
     std::string token;
@@ -56,7 +90,7 @@ std::vector<std::string> SimpleTokenizer::split_text(const std::string& text) {
     return tokens;
 }
 
-int SimpleTokenizer::hash_token(const std::string& token) {
+int SimpleTokenizer::hash_token(const std::string& token) const {
     std::hash<std::string> hasher;
     return static_cast<int>(hasher(token) % 1000000);
 }
@@ -68,7 +102,7 @@ SentenceTokenizer::SentenceTokenizer(bool preserve_punctuation)
       word_pattern_(R"(\b\w+\b)") {
 }
 
-std::vector<int> SentenceTokenizer::encode(const std::string& text) {
+std::vector<int> SentenceTokenizer::encode(const std::string& text) const {
     auto tokens = tokenize(text);
     std::vector<int> encoded;
     encoded.reserve(tokens.size());
@@ -80,7 +114,7 @@ std::vector<int> SentenceTokenizer::encode(const std::string& text) {
     return encoded;
 }
 
-std::vector<std::string> SentenceTokenizer::tokenize(const std::string& text) {
+std::vector<std::string> SentenceTokenizer::tokenize(const std::string& text) const {
     std::vector<std::string> tokens;
     
     // Split into sentences first
@@ -102,7 +136,32 @@ std::vector<std::string> SentenceTokenizer::tokenize(const std::string& text) {
     return tokens;
 }
 
-std::string SentenceTokenizer::decode(const std::vector<int>& tokens) {
+std::vector<TokenSpan> SentenceTokenizer::token_spans(std::string_view text) const {
+    // The words of each sentence, then an empty span at its end for the
+    // sentence mark token (the mark itself stays part of the last word)
+    std::vector<TokenSpan> spans;
+    auto add_sentence = [&](size_t begin, size_t end) {
+        append_word_spans(text, begin, end, spans);
+        char last_char = end > begin ? text[end - 1] : '\0';
+        if (preserve_punctuation_ && (last_char == '.' || last_char == '!' || last_char == '?')) {
+            spans.push_back({end, end});
+        }
+    };
+    
+    size_t start = 0;
+    for (size_t boundary : r3m::utils::SIMDUtils::find_sentence_boundaries_simd(std::string(text))) {
+        if (boundary > start) {
+            add_sentence(start, boundary + 1);
+        }
+        start = boundary + 1;
+    }
+    if (start < text.size()) {
+        add_sentence(start, text.size());
+    }
+    return spans;
+}
+
+std::string SentenceTokenizer::decode(const std::vector<int>& tokens) const {
     std::string result;
     for (int token_id : tokens) {
         // Simple decoding - in practice you'd use a reverse vocabulary
@@ -111,11 +170,11 @@ std::string SentenceTokenizer::decode(const std::vector<int>& tokens) {
     return result;
 }
 
-int SentenceTokenizer::count_tokens(const std::string& text) {
-    return static_cast<int>(tokenize(text).size());
+size_t SentenceTokenizer::count_tokens(const std::string& text) const {
+    return tokenize(text).size();
 }
 
-std::vector<std::string> SentenceTokenizer::split_sentences(const std::string& text) {
+std::vector<std::string> SentenceTokenizer::split_sentences(const std::string& text) const {
     std::vector<std::string> sentences;
     
     // Use SIMD-optimized sentence boundary detection
@@ -153,7 +212,7 @@ std::vector<std::string> SentenceTokenizer::split_sentences(const std::string& t
     return sentences;
 }
 
-std::vector<std::string> SentenceTokenizer::split_words(const std::string& text) {
+std::vector<std::string> SentenceTokenizer::split_words(const std::string& text) const {
     std::vector<std::string> words;
     std::istringstream iss(text);
     std::string word;
@@ -169,241 +228,720 @@ std::vector<std::string> SentenceTokenizer::split_words(const std::string& text)
     return words;
 }
 
-int SentenceTokenizer::hash_token(const std::string& token) {
+int SentenceTokenizer::hash_token(const std::string& token) const {
     std::hash<std::string> hasher;
     return static_cast<int>(hasher(token) % 1000000);
 }
 
 // BPETokenizer implementation
-BPETokenizer::BPETokenizer(size_t vocab_size) : vocab_size_(vocab_size) {
-    // Initialize with basic vocabulary
-    for (int i = 0; i < 128; ++i) {
-        std::string token = std::string(1, static_cast<char>(i));
-        vocab_[token] = i;
-        reverse_vocab_[i] = token;
+namespace {
+
+// GPT-2's reversible byte -> printable code point mapping, used for the
+// tokens stored in vocab.json and merges.txt
+struct ByteUnicode {
+    std::array<uint32_t, 256> to_code_point{};
+    std::array<int, 324> to_byte{}; // Every mapped code point is below 324
+    
+    ByteUnicode() {
+        to_byte.fill(-1);
+        uint32_t next = 256;
+        for (uint32_t b = 0; b < 256; ++b) {
+            bool printable = (b >= '!' && b <= '~') || (b >= 0xA1 && b <= 0xAC) || (b >= 0xAE && b <= 0xFF);
+            to_code_point[b] = printable ? b : next++;
+            to_byte[to_code_point[b]] = static_cast<int>(b);
+        }
     }
+};
+
+const ByteUnicode& byte_unicode() {
+    static const ByteUnicode table;
+    return table;
 }
 
-std::vector<int> BPETokenizer::encode(const std::string& text) {
-    auto tokens = tokenize(text);
-    std::vector<int> encoded;
-    encoded.reserve(tokens.size());
-    
-    for (const auto& token : tokens) {
-        auto it = vocab_.find(token);
-        if (it != vocab_.end()) {
-            encoded.push_back(it->second);
+void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+// Token bytes -> vocab.json form
+std::string bytes_to_unicode(const std::string& bytes) {
+    std::string out;
+    out.reserve(bytes.size() * 2);
+    for (unsigned char b : bytes) {
+        append_utf8(out, byte_unicode().to_code_point[b]);
+    }
+    return out;
+}
+
+// vocab.json form -> token bytes; false if it holds a code point outside the mapping
+bool unicode_to_bytes(std::string_view text, std::string& bytes) {
+    bytes.clear();
+    for (size_t i = 0; i < text.size();) {
+        unsigned char lead = static_cast<unsigned char>(text[i]);
+        uint32_t cp;
+        size_t length;
+        if (lead < 0x80) {
+            cp = lead;
+            length = 1;
+        } else if ((lead & 0xE0) == 0xC0 && i + 1 < text.size()) {
+            cp = ((lead & 0x1F) << 6) | (static_cast<unsigned char>(text[i + 1]) & 0x3F);
+            length = 2;
         } else {
-            // Unknown token - use a default ID
-            encoded.push_back(0);
+            return false;
+        }
+        if (cp >= byte_unicode().to_byte.size() || byte_unicode().to_byte[cp] < 0) {
+            return false;
         }
+        bytes += static_cast<char>(byte_unicode().to_byte[cp]);
+        i += length;
     }
-    
-    return encoded;
+    return true;
 }
 
-std::vector<std::string> BPETokenizer::tokenize(const std::string& text) {
-    return byte_pair_encode(text);
+void write_json_string(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            const char* hex = "0123456789abcdef";
+            out << "\\u00" << hex[(c >> 4) & 0xF] << hex[c & 0xF];
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
 }
 
-std::string BPETokenizer::decode(const std::vector<int>& tokens) {
-    std::vector<std::string> token_strings;
-    token_strings.reserve(tokens.size());
+// Reader for the flat {"token": id, ...} object of vocab.json
+class VocabJsonReader {
+public:
+    explicit VocabJsonReader(std::string_view json) : json_(json) {}
+    
+    template <typename Entry>
+    void read(Entry&& on_entry) {
+        expect('{');
+        if (peek() == '}') {
+            ++pos_;
+            return;
+        }
+        while (true) {
+            std::string token = read_string();
+            expect(':');
+            int id = read_int();
+            on_entry(std::move(token), id);
+            char c = next();
+            if (c == '}') {
+                return;
+            }
+            if (c != ',') {
+                fail();
+            }
+        }
+    }
+
+private:
+    std::string_view json_;
+    size_t pos_ = 0;
     
-    for (int token_id : tokens) {
-        auto it = reverse_vocab_.find(token_id);
-        if (it != reverse_vocab_.end()) {
-            token_strings.push_back(it->second);
-        } else {
-            token_strings.push_back("<UNK>");
+    [[noreturn]] void fail() const {
+        throw std::runtime_error("Invalid vocabulary JSON at byte " + std::to_string(pos_));
+    }
+    
+    char peek() {
+        while (pos_ < json_.size() && std::isspace(static_cast<unsigned char>(json_[pos_]))) {
+            ++pos_;
+        }
+        if (pos_ >= json_.size()) {
+            fail();
         }
+        return json_[pos_];
     }
     
-    return byte_pair_decode(token_strings);
-}
+    char next() {
+        char c = peek();
+        ++pos_;
+        return c;
+    }
+    
+    void expect(char c) {
+        if (next() != c) {
+            fail();
+        }
+    }
+    
+    int read_int() {
+        peek();
+        size_t start = pos_;
+        while (pos_ < json_.size() && std::isdigit(static_cast<unsigned char>(json_[pos_]))) {
+            ++pos_;
+        }
+        if (pos_ == start || pos_ - start > 9) {
+            fail();
+        }
+        return std::stoi(std::string(json_.substr(start, pos_ - start)));
+    }
+    
+    uint32_t read_hex4() {
+        if (pos_ + 4 > json_.size()) {
+            fail();
+        }
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = json_[pos_++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= static_cast<uint32_t>(c - '0');
+            else if (c >= 'a' && c <= 'f') value |= static_cast<uint32_t>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') value |= static_cast<uint32_t>(c - 'A' + 10);
+            else fail();
+        }
+        return value;
+    }
+    
+    std::string read_string() {
+        expect('"');
+        std::string out;
+        while (pos_ < json_.size()) {
+            char c = json_[pos_++];
+            if (c == '"') {
+                return out;
+            }
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= json_.size()) {
+                break;
+            }
+            switch (json_[pos_++]) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    uint32_t cp = read_hex4();
+                    if (cp >= 0xD800 && cp <= 0xDBFF && json_.compare(pos_, 2, "\\u") == 0) {
+                        pos_ += 2;
+                        uint32_t low = read_hex4();
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(out, cp);
+                    break;
+                }
+                default:
+                    fail();
+            }
+        }
+        fail();
+    }
+};
 
-int BPETokenizer::count_tokens(const std::string& text) {
-    return static_cast<int>(tokenize(text).size());
+bool is_ascii_letter(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
 }
 
-void BPETokenizer::train(const std::vector<std::string>& corpus) {
-    build_vocabulary(corpus);
+bool is_pretoken_space(unsigned char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
 }
 
-void BPETokenizer::save_vocabulary(const std::string& filename) {
-    std::ofstream file(filename);
-    if (file.is_open()) {
-        for (const auto& [token, id] : vocab_) {
-            file << id << "\t" << token << "\n";
-        }
-        file.close();
+// Letter runs (non-ASCII bytes count as letters), digit runs and runs of anything else
+enum class CharClass { Letter, Digit, Other };
+
+CharClass char_class(unsigned char c) {
+    if (is_ascii_letter(c) || c >= 0x80) {
+        return CharClass::Letter;
     }
+    if (c >= '0' && c <= '9') {
+        return CharClass::Digit;
+    }
+    return CharClass::Other;
 }
 
-void BPETokenizer::load_vocabulary(const std::string& filename) {
-    std::ifstream file(filename);
-    if (file.is_open()) {
-        vocab_.clear();
-        reverse_vocab_.clear();
-        
-        std::string line;
-        while (std::getline(file, line)) {
-            size_t tab_pos = line.find('\t');
-            if (tab_pos != std::string::npos) {
-                int id = std::stoi(line.substr(0, tab_pos));
-                std::string token = line.substr(tab_pos + 1);
-                vocab_[token] = id;
-                reverse_vocab_[id] = token;
-            }
+// Length of the contraction ('s 't 're 've 'm 'll 'd) at text[pos] == '\'', or 0
+size_t contraction_length(std::string_view text, size_t pos) {
+    if (pos + 1 >= text.size()) {
+        return 0;
+    }
+    char c = text[pos + 1];
+    if (c == 's' || c == 't' || c == 'm' || c == 'd') {
+        return 2;
+    }
+    if (pos + 2 < text.size()) {
+        char d = text[pos + 2];
+        if ((c == 'r' && d == 'e') || (c == 'v' && d == 'e') || (c == 'l' && d == 'l')) {
+            return 3;
         }
-        file.close();
     }
+    return 0;
 }
 
-void BPETokenizer::build_vocabulary(const std::vector<std::string>& corpus) {
-    // Count character pairs using SIMD optimization
-    pair_freqs_.clear();
-    
-    for (const auto& text : corpus) {
-        // Extract all 2-character pairs from the vocabulary
-        std::vector<std::string> pairs;
-        for (const auto& [token, id] : vocab_) {
-            if (token.length() == 2) {
-                pairs.push_back(token);
+// Calls on_piece for every GPT-2 pre-token of text, in order
+template <typename Piece>
+void for_each_piece(std::string_view text, Piece&& on_piece) {
+    const size_t n = text.size();
+    size_t pos = 0;
+    while (pos < n) {
+        unsigned char c = static_cast<unsigned char>(text[pos]);
+        
+        if (c == '\'') {
+            size_t length = contraction_length(text, pos);
+            if (length > 0) {
+                on_piece(text.substr(pos, length));
+                pos += length;
+                continue;
             }
         }
         
-        // Use SIMD-optimized pair finding
-        auto positions = r3m::utils::SIMDUtils::find_bpe_pairs_simd(text, pairs);
-        
-        // Count pairs found by SIMD
-        for (size_t pos : positions) {
-            if (pos + 1 < text.length()) {
-                std::string pair = text.substr(pos, 2);
-                pair_freqs_[pair]++;
+        // " ?\p{L}+", " ?\p{N}+" and " ?[^\s\p{L}\p{N}]+"
+        size_t start = (c == ' ' && pos + 1 < n && !is_pretoken_space(static_cast<unsigned char>(text[pos + 1]))) ? pos + 1 : pos;
+        unsigned char first = static_cast<unsigned char>(text[start]);
+        if (!is_pretoken_space(first)) {
+            CharClass cls = char_class(first);
+            size_t end = start + 1;
+            while (end < n) {
+                unsigned char d = static_cast<unsigned char>(text[end]);
+                if (is_pretoken_space(d) || char_class(d) != cls) {
+                    break;
+                }
+                ++end;
             }
+            on_piece(text.substr(pos, end - pos));
+            pos = end;
+            continue;
         }
         
-        // Also count adjacent character pairs for new vocabulary building
-        for (size_t i = 0; i < text.length() - 1; ++i) {
-            std::string pair = text.substr(i, 2);
-            pair_freqs_[pair]++;
+        // "\s+(?!\S)|\s+": a run of whitespace leaves its last character to
+        // prefix the next word
+        size_t end = pos + 1;
+        while (end < n && is_pretoken_space(static_cast<unsigned char>(text[end]))) {
+            ++end;
         }
+        if (end < n && end - pos > 1) {
+            --end;
+        }
+        on_piece(text.substr(pos, end - pos));
+        pos = end;
     }
-    
-    // Build vocabulary through merges
-    while (vocab_.size() < vocab_size_ && !pair_freqs_.empty()) {
-        merge_pairs();
+}
+
+} // namespace
+
+BPETokenizer::BPETokenizer(size_t vocab_size) : vocab_size_(vocab_size) {
+    reset_to_bytes();
+}
+
+void BPETokenizer::reset_to_bytes() {
+    vocab_.clear();
+    reverse_vocab_.clear();
+    merges_.clear();
+    for (int b = 0; b < 256; ++b) {
+        byte_ids_[b] = add_token(std::string(1, static_cast<char>(b)));
     }
 }
 
-std::vector<std::string> BPETokenizer::byte_pair_encode(const std::string& text) {
-    std::vector<std::string> tokens;
-    
-    // Start with individual characters
-    for (char ch : text) {
-        tokens.push_back(std::string(1, ch));
+int BPETokenizer::add_token(const std::string& token) {
+    auto [it, inserted] = vocab_.emplace(token, static_cast<int>(reverse_vocab_.size()));
+    if (inserted) {
+        reverse_vocab_.push_back(token);
     }
-    
-    // If vocabulary is empty, just return character tokens
-    if (vocab_.size() <= 128) {
-        return tokens;
+    return it->second;
+}
+
+std::vector<std::string_view> BPETokenizer::pre_tokenize(std::string_view text) {
+    std::vector<std::string_view> pieces;
+    for_each_piece(text, [&pieces](std::string_view piece) { pieces.push_back(piece); });
+    return pieces;
+}
+
+void BPETokenizer::encode_piece(std::string_view piece, std::vector<int>& ids) const {
+    // Unknown bytes (only possible with a loaded vocabulary) encode as 0
+    auto byte_id = [this](char c) { return std::max(byte_ids_[static_cast<unsigned char>(c)], 0); };
+    if (piece.size() == 1) {
+        ids.push_back(byte_id(piece[0]));
+        return;
     }
     
-    // Extract all 2-character pairs from vocabulary for SIMD processing
-    std::vector<std::string> pairs;
-    for (const auto& [token, id] : vocab_) {
-        if (token.length() == 2) {
-            pairs.push_back(token);
+    // Doubly linked list of symbols; merged-away symbols get id -1
+    struct Symbol {
+        int id;
+        int prev;
+        int next;
+    };
+    // Candidate merge of symbols[left] with its right neighbour; stale
+    // candidates are detected when popped
+    struct Candidate {
+        int rank;
+        int left;
+        int left_id;
+        int right_id;
+        
+        bool operator>(const Candidate& other) const {
+            return rank != other.rank ? rank > other.rank : left > other.left;
         }
+    };
+    thread_local std::vector<Symbol> symbols;
+    thread_local std::vector<Candidate> heap;
+    
+    const int n = static_cast<int>(piece.size());
+    symbols.resize(piece.size());
+    heap.clear();
+    for (int i = 0; i < n; ++i) {
+        symbols[i] = {byte_id(piece[i]), i - 1, i + 1 < n ? i + 1 : -1};
     }
     
-    // Use SIMD-optimized pair finding for faster encoding
-    auto positions = r3m::utils::SIMDUtils::find_bpe_pairs_simd(text, pairs);
-    
-    // Process found pairs in reverse order to avoid index shifting issues
-    std::sort(positions.begin(), positions.end(), std::greater<size_t>());
-    
-    // Create a new tokens vector to avoid modifying while iterating
-    std::vector<std::string> result_tokens;
-    result_tokens.reserve(tokens.size());
+    auto push_candidate = [this](int left) {
+        if (left < 0 || symbols[left].next < 0) {
+            return;
+        }
+        int right = symbols[left].next;
+        auto it = merges_.find(pair_key(symbols[left].id, symbols[right].id));
+        if (it != merges_.end()) {
+            heap.push_back({it->second.rank, left, symbols[left].id, symbols[right].id});
+            std::push_heap(heap.begin(), heap.end(), std::greater<Candidate>());
+        }
+    };
+    for (int i = 0; i + 1 < n; ++i) {
+        push_candidate(i);
+    }
     
-    // Copy tokens and apply BPE merges
-    for (size_t i = 0; i < tokens.size(); ++i) {
-        bool merged = false;
+    // Lowest rank first; equal ranks merge left to right
+    while (!heap.empty()) {
+        std::pop_heap(heap.begin(), heap.end(), std::greater<Candidate>());
+        Candidate candidate = heap.back();
+        heap.pop_back();
         
-        // Check if this position should be merged
-        for (size_t pos : positions) {
-            if (pos == i && pos + 1 < text.length()) {
-                std::string pair = text.substr(pos, 2);
-                auto it = vocab_.find(pair);
-                if (it != vocab_.end()) {
-                    result_tokens.push_back(pair);
-                    i++; // Skip the next token since we merged it
-                    merged = true;
-                    break;
-                }
-            }
+        Symbol& left = symbols[candidate.left];
+        if (left.id != candidate.left_id || left.next < 0 || symbols[left.next].id != candidate.right_id) {
+            continue;
         }
         
-        if (!merged) {
-            result_tokens.push_back(tokens[i]);
+        Symbol& right = symbols[left.next];
+        left.id = merges_.at(pair_key(candidate.left_id, candidate.right_id)).id;
+        left.next = right.next;
+        if (right.next >= 0) {
+            symbols[right.next].prev = candidate.left;
         }
+        right.id = -1;
+        
+        push_candidate(left.prev);
+        push_candidate(candidate.left);
     }
     
-    return result_tokens;
+    for (int i = 0; i >= 0; i = symbols[i].next) {
+        ids.push_back(symbols[i].id);
+    }
+}
+
+std::vector<int> BPETokenizer::encode(const std::string& text) const {
+    std::vector<int> ids;
+    ids.reserve(text.size() / 3);
+    for_each_piece(text, [&](std::string_view piece) { encode_piece(piece, ids); });
+    return ids;
+}
+
+std::vector<std::string> BPETokenizer::tokenize(const std::string& text) const {
+    auto ids = encode(text);
+    std::vector<std::string> tokens;
+    tokens.reserve(ids.size());
+    for (int id : ids) {
+        tokens.push_back(reverse_vocab_[static_cast<size_t>(id)]);
+    }
+    return tokens;
+}
+
+std::vector<TokenSpan> BPETokenizer::token_spans(std::string_view text) const {
+    thread_local std::vector<int> ids;
+    std::vector<TokenSpan> spans;
+    spans.reserve(text.size() / 3);
+    for_each_piece(text, [&](std::string_view piece) {
+        ids.clear();
+        encode_piece(piece, ids);
+        
+        // Tokens are the piece's bytes in order; clamp in case a vocabulary
+        // without some single bytes substituted a token of another length
+        size_t begin = static_cast<size_t>(piece.data() - text.data());
+        const size_t piece_end = begin + piece.size();
+        for (size_t i = 0; i < ids.size(); ++i) {
+            size_t end = i + 1 == ids.size() ? piece_end
+                         : std::min(begin + reverse_vocab_[static_cast<size_t>(ids[i])].size(), piece_end);
+            spans.push_back({begin, end});
+            begin = end;
+        }
+    });
+    return spans;
 }
 
-std::string BPETokenizer::byte_pair_decode(const std::vector<std::string>& tokens) {
+std::string BPETokenizer::decode(const std::vector<int>& tokens) const {
+    // Token strings are the original bytes; unknown ids are dropped
     std::string result;
-    for (const auto& token : tokens) {
-        result += token;
+    for (int token_id : tokens) {
+        if (token_id >= 0 && static_cast<size_t>(token_id) < reverse_vocab_.size()) {
+            result += reverse_vocab_[static_cast<size_t>(token_id)];
+        }
     }
     return result;
 }
 
-void BPETokenizer::merge_pairs() {
-    if (pair_freqs_.empty()) return;
+size_t BPETokenizer::count_tokens(const std::string& text) const {
+    return count_tokens(std::string_view(text));
+}
+
+size_t BPETokenizer::count_tokens(std::string_view text) const {
+    // Ids of one piece at a time; only the count survives
+    thread_local std::vector<int> ids;
+    size_t count = 0;
+    for_each_piece(text, [&](std::string_view piece) {
+        ids.clear();
+        encode_piece(piece, ids);
+        count += ids.size();
+    });
+    return count;
+}
+
+void BPETokenizer::train(const std::vector<std::string>& corpus) {
+    renew_cache_key();
+    reset_to_bytes();
     
-    // Find the most frequent pair
-    auto max_pair = std::max_element(pair_freqs_.begin(), pair_freqs_.end(),
-        [](const auto& a, const auto& b) { return a.second < b.second; });
+    // Distinct pieces with their frequency; merges never cross pieces
+    std::unordered_map<std::string_view, size_t> piece_counts;
+    for (const auto& text : corpus) {
+        for_each_piece(text, [&piece_counts](std::string_view piece) { ++piece_counts[piece]; });
+    }
+    
+    std::vector<std::vector<int>> words;
+    std::vector<size_t> frequencies;
+    for (const auto& [piece, count] : piece_counts) {
+        if (piece.size() < 2) {
+            continue;
+        }
+        std::vector<int> word;
+        word.reserve(piece.size());
+        for (unsigned char c : piece) {
+            word.push_back(byte_ids_[c]);
+        }
+        words.push_back(std::move(word));
+        frequencies.push_back(count);
+    }
+    
+    // Pair counts, the words each pair was seen in, and a max-heap of
+    // (count, pair). Heap entries are not updated in place: a pair is pushed
+    // again whenever its count changes, and entries whose count no longer
+    // matches are skipped when they reach the top.
+    std::unordered_map<uint64_t, size_t> pair_counts;
+    std::unordered_map<uint64_t, std::vector<size_t>> pair_words;
+    std::vector<uint64_t> touched;
+    auto add_pairs = [&](const std::vector<int>& word, size_t w, int indexed_token) {
+        for (size_t i = 0; i + 1 < word.size(); ++i) {
+            const uint64_t key = pair_key(word[i], word[i + 1]);
+            pair_counts[key] += frequencies[w];
+            touched.push_back(key);
+            // Pairs without the new token were already in the word, so the
+            // word is already indexed under them
+            if (indexed_token < 0 || word[i] == indexed_token || word[i + 1] == indexed_token) {
+                pair_words[key].push_back(w);
+            }
+        }
+    };
+    auto remove_pairs = [&](const std::vector<int>& word, size_t w) {
+        for (size_t i = 0; i + 1 < word.size(); ++i) {
+            const uint64_t key = pair_key(word[i], word[i + 1]);
+            auto it = pair_counts.find(key);
+            if ((it->second -= frequencies[w]) == 0) {
+                pair_counts.erase(it);
+            }
+            touched.push_back(key);
+        }
+    };
+    for (size_t w = 0; w < words.size(); ++w) {
+        add_pairs(words[w], w, -1);
+    }
     
-    if (max_pair != pair_freqs_.end()) {
-        std::string new_token = max_pair->first;
-        int new_id = static_cast<int>(vocab_.size());
+    // Most frequent first; ties go to the smaller key so training is deterministic
+    using Candidate = std::pair<size_t, uint64_t>;
+    auto lower_priority = [](const Candidate& a, const Candidate& b) {
+        return a.first != b.first ? a.first < b.first : a.second > b.second;
+    };
+    std::priority_queue<Candidate, std::vector<Candidate>, decltype(lower_priority)> candidates(lower_priority);
+    for (const auto& [key, count] : pair_counts) {
+        candidates.emplace(count, key);
+    }
+    touched.clear();
+    
+    std::vector<size_t> merged_in(words.size(), SIZE_MAX);  // Last merge that rewrote each word
+    while (vocab_.size() < vocab_size_) {
+        while (!candidates.empty()) {
+            auto current = pair_counts.find(candidates.top().second);
+            if (current != pair_counts.end() && current->second == candidates.top().first) {
+                break;
+            }
+            candidates.pop();
+        }
+        if (candidates.empty() || candidates.top().first < 2) {
+            break;
+        }
+        
+        const uint64_t key = candidates.top().second;
+        candidates.pop();
+        const int left = static_cast<int>(key >> 32);
+        const int right = static_cast<int>(key & 0xFFFFFFFFu);
+        const int merged = add_token(reverse_vocab_[static_cast<size_t>(left)] + reverse_vocab_[static_cast<size_t>(right)]);
+        const size_t merge_index = merges_.size();
+        merges_.emplace(key, Merge{static_cast<int>(merge_index), merged});
         
-        vocab_[new_token] = new_id;
-        reverse_vocab_[new_id] = new_token;
+        // Only the words indexed under the pair; an entry is stale if an
+        // earlier merge already consumed the pair in that word
+        std::vector<size_t> containing = std::move(pair_words[key]);
+        pair_words.erase(key);
+        for (size_t w : containing) {
+            auto& word = words[w];
+            if (merged_in[w] == merge_index) {
+                continue;
+            }
+            bool contains = false;
+            for (size_t i = 0; i + 1 < word.size() && !contains; ++i) {
+                contains = word[i] == left && word[i + 1] == right;
+            }
+            if (!contains) {
+                continue;
+            }
+            merged_in[w] = merge_index;
+            
+            remove_pairs(word, w);
+            size_t out = 0;
+            for (size_t i = 0; i < word.size(); ++out) {
+                if (i + 1 < word.size() && word[i] == left && word[i + 1] == right) {
+                    word[out] = merged;
+                    i += 2;
+                } else {
+                    word[out] = word[i++];
+                }
+            }
+            word.resize(out);
+            add_pairs(word, w, merged);
+        }
         
-        // Remove the pair from frequencies
-        pair_freqs_.erase(max_pair);
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+        for (uint64_t changed : touched) {
+            auto it = pair_counts.find(changed);
+            if (it != pair_counts.end()) {
+                candidates.emplace(it->second, changed);
+            }
+        }
+        touched.clear();
     }
 }
 
-// TokenizerFactory implementation
-std::shared_ptr<AdvancedTokenizer> TokenizerFactory::create(Type type, const std::string& model_name) {
-    (void)model_name; // Suppress unused parameter warning
-    switch (type) {
-        case Type::SIMPLE:
-            return std::make_shared<SimpleTokenizer>();
-        case Type::SENTENCE:
-            return std::make_shared<SentenceTokenizer>();
-        case Type::BPE:
-            return std::make_shared<BPETokenizer>();
-        default:
-            return std::make_shared<SimpleTokenizer>();
+void BPETokenizer::save_vocabulary(const std::string& vocab_path, const std::string& merges_path) const {
+    std::ofstream vocab_file(vocab_path, std::ios::binary);
+    if (!vocab_file.is_open()) {
+        throw std::runtime_error("Failed to open vocabulary file: " + vocab_path);
+    }
+    vocab_file << "{";
+    bool first = true;
+    for (size_t id = 0; id < reverse_vocab_.size(); ++id) {
+        if (vocab_.count(reverse_vocab_[id]) == 0 || vocab_.at(reverse_vocab_[id]) != static_cast<int>(id)) {
+            continue;
+        }
+        vocab_file << (first ? "\n  " : ",\n  ");
+        write_json_string(vocab_file, bytes_to_unicode(reverse_vocab_[id]));
+        vocab_file << ": " << id;
+        first = false;
+    }
+    vocab_file << "\n}\n";
+    
+    std::vector<uint64_t> ranked(merges_.size());
+    for (const auto& [key, merge] : merges_) {
+        ranked[static_cast<size_t>(merge.rank)] = key;
+    }
+    std::ofstream merges_file(merges_path, std::ios::binary);
+    if (!merges_file.is_open()) {
+        throw std::runtime_error("Failed to open merges file: " + merges_path);
+    }
+    merges_file << "#version: 0.2\n";
+    for (uint64_t key : ranked) {
+        merges_file << bytes_to_unicode(reverse_vocab_[key >> 32]) << ' '
+                    << bytes_to_unicode(reverse_vocab_[key & 0xFFFFFFFFu]) << '\n';
     }
 }
 
-std::shared_ptr<AdvancedTokenizer> TokenizerFactory::create_from_config(const std::string& config) {
-    // Simple config parsing - in practice you'd use a proper parser
-    if (config.find("sentence") != std::string::npos) {
-        return std::make_shared<SentenceTokenizer>();
-    } else if (config.find("bpe") != std::string::npos) {
-        return std::make_shared<BPETokenizer>();
-    } else {
-        return std::make_shared<SimpleTokenizer>();
+void BPETokenizer::load_vocabulary(const std::string& vocab_path, const std::string& merges_path) {
+    std::ifstream vocab_file(vocab_path, std::ios::binary);
+    if (!vocab_file.is_open()) {
+        throw std::runtime_error("Failed to open vocabulary file: " + vocab_path);
+    }
+    std::string json((std::istreambuf_iterator<char>(vocab_file)), std::istreambuf_iterator<char>());
+    
+    std::unordered_map<std::string, int> vocab;
+    std::vector<std::string> reverse_vocab;
+    std::string bytes;
+    VocabJsonReader(json).read([&](std::string token, int id) {
+        if (!unicode_to_bytes(token, bytes)) {
+            throw std::runtime_error("Vocabulary token is not byte-level BPE: " + token);
+        }
+        if (static_cast<size_t>(id) >= reverse_vocab.size()) {
+            reverse_vocab.resize(static_cast<size_t>(id) + 1);
+        }
+        reverse_vocab[static_cast<size_t>(id)] = bytes;
+        vocab[bytes] = id;
+    });
+    
+    std::ifstream merges_file(merges_path, std::ios::binary);
+    if (!merges_file.is_open()) {
+        throw std::runtime_error("Failed to open merges file: " + merges_path);
+    }
+    
+    renew_cache_key();
+    vocab_ = std::move(vocab);
+    reverse_vocab_ = std::move(reverse_vocab);
+    merges_.clear();
+    for (int b = 0; b < 256; ++b) {
+        auto it = vocab_.find(std::string(1, static_cast<char>(b)));
+        byte_ids_[b] = it != vocab_.end() ? it->second : -1;
+    }
+    
+    // One "left right" merge per line, highest priority first; merges whose
+    // tokens are not in the vocabulary are skipped
+    std::string line;
+    std::string left;
+    std::string right;
+    while (std::getline(merges_file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        size_t space = line.find(' ');
+        if (line.empty() || line.rfind("#version", 0) == 0 || space == std::string::npos) {
+            continue;
+        }
+        if (!unicode_to_bytes(std::string_view(line).substr(0, space), left) ||
+            !unicode_to_bytes(std::string_view(line).substr(space + 1), right)) {
+            continue;
+        }
+        auto left_it = vocab_.find(left);
+        auto right_it = vocab_.find(right);
+        auto merged_it = vocab_.find(left + right);
+        if (left_it == vocab_.end() || right_it == vocab_.end() || merged_it == vocab_.end()) {
+            continue;
+        }
+        merges_.emplace(pair_key(left_it->second, right_it->second),
+                        Merge{static_cast<int>(merges_.size()), merged_it->second});
     }
 }
 
@@ -28,14 +28,14 @@ std::vector<DocumentChunk> ContextualRAG::add_contextual_summaries(
         // No need for contextual RAG if document fits in single chunk
         for (auto& chunk : chunks) {
             chunk.contextual_rag_reserved_tokens = 0;
-            chunk.doc_summary = "";
-            chunk.chunk_context = "";
+            chunk.doc_summary.clear();
+            chunk.chunk_context.clear();
         }
         return chunks;
     }
     
-    // Generate document summary if enabled
-    std::string document_summary;
+    // Generate document summary if enabled (one buffer shared by every chunk)
+    SharedText document_summary;
     if (use_document_summary_) {
         document_summary = generate_document_summary(chunks);
     }
@@ -48,7 +48,7 @@ std::vector<DocumentChunk> ContextualRAG::add_contextual_summaries(
         if (use_chunk_summary_) {
             chunk.chunk_context = generate_chunk_context(chunk, document_summary);
         } else {
-            chunk.chunk_context = "";
+            chunk.chunk_context.clear();
         }
     }
     
@@ -69,7 +69,7 @@ std::string ContextualRAG::generate_document_summary(const std::vector<DocumentC
 
 std::string ContextualRAG::generate_chunk_context(
     const DocumentChunk& chunk,
-    const std::string& document_summary
+    std::string_view document_summary
 ) {
     // Create chunk context prompt
     std::string prompt = create_chunk_context_prompt(chunk, document_summary);
@@ -105,7 +105,7 @@ std::string ContextualRAG::create_document_summary_prompt(const std::vector<Docu
 
 std::string ContextualRAG::create_chunk_context_prompt(
     const DocumentChunk& chunk,
-    const std::string& document_summary
+    std::string_view document_summary
 ) {
     std::stringstream ss;
     
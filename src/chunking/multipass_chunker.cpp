@@ -1,6 +1,9 @@
 #include "r3m/chunking/multipass_chunker.hpp"
+#include "r3m/utils/hash.hpp"
 #include <sstream>
 #include <algorithm>
+#include <cctype>
+#include <string_view>
 #include <unordered_set>
 
 namespace r3m {
@@ -44,30 +47,40 @@ ChunkingResult MultipassChunker::chunk_document(
         return result;
     }
     
-    // Create metadata strings
-    std::string metadata_semantic = create_metadata_string(metadata);
-    std::string metadata_keyword = create_metadata_keyword(metadata);
+    // Create metadata strings (shared by every chunk)
+    SharedText metadata_semantic = create_metadata_string(metadata);
+    SharedText metadata_keyword = create_metadata_keyword(metadata);
     
     // Create title prefix
-    std::string title_prefix = title.empty() ? "" : title + "\n";
+    SharedText title_prefix = title.empty() ? "" : title + "\n";
     
-    // Generate regular chunks
+    // Chunks slice one shared copy of the document
+    const SharedText document(content);
+    size_t cursor = 0;
+    
+    // Generate regular chunks (slicing is sequential, scoring runs in parallel)
     auto text_chunks = regular_chunker_->chunk(content);
-    std::vector<DocumentChunk> regular_chunks;
-    
-    for (size_t i = 0; i < text_chunks.size(); ++i) {
-        auto chunk = create_chunk(
-            i,
-            document_id,
-            text_chunks[i],
-            title_prefix,
-            metadata_semantic,
-            metadata_keyword,
-            i > 0
-        );
-        regular_chunks.push_back(chunk);
+    std::vector<SharedText> slices;
+    slices.reserve(text_chunks.size());
+    for (auto& text : text_chunks) {
+        slices.push_back(document.slice_matching(std::move(text), cursor));
     }
     
+    std::vector<DocumentChunk> regular_chunks(slices.size());
+    parallel::parallel_for(thread_pool_, slices.size(), 8, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            regular_chunks[i] = create_chunk(
+                i,
+                document_id,
+                std::move(slices[i]),
+                title_prefix,
+                metadata_semantic,
+                metadata_keyword,
+                i > 0
+            );
+        }
+    });
+    
     result.chunks = regular_chunks;
     result.total_chunks = regular_chunks.size();
     result.successful_chunks = regular_chunks.size();
@@ -120,26 +133,52 @@ std::vector<DocumentChunk> MultipassChunker::generate_mini_chunks(
         return mini_chunks;
     }
     
-    for (const auto& chunk : chunks) {
-        auto mini_texts = get_mini_chunk_texts(chunk.content);
-        
-        for (size_t i = 0; i < mini_texts.size(); ++i) {
-            auto mini_chunk = create_chunk(
-                mini_chunks.size(),
-                chunk.document_id,
-                mini_texts[i],
-                chunk.title_prefix,
-                chunk.metadata_suffix_semantic,
-                chunk.metadata_suffix_keyword,
-                i > 0
-            );
+    // Split every parent independently, then number the mini chunks in parent order
+    std::vector<std::vector<DocumentChunk>> per_parent(chunks.size());
+    parallel::parallel_for(thread_pool_, chunks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t p = begin; p < end; ++p) {
+            const auto& chunk = chunks[p];
             
-            // Set mini-chunk specific properties
-            mini_chunk.mini_chunk_texts = mini_texts;
-            mini_chunk.large_chunk_id = chunk.chunk_id;
-            mini_chunk.large_chunk_reference_ids = {chunk.chunk_id};
+            // Mini chunks slice their parent's text; siblings share one list of them
+            size_t cursor = 0;
+            std::vector<SharedText> mini_slices;
+            for (auto& mini_text : get_mini_chunk_texts(chunk.content)) {
+                mini_slices.push_back(chunk.content.slice_matching(std::move(mini_text), cursor));
+            }
+            SharedTextList mini_texts(mini_slices);
             
-            mini_chunks.push_back(mini_chunk);
+            auto& siblings = per_parent[p];
+            siblings.reserve(mini_slices.size());
+            for (size_t i = 0; i < mini_slices.size(); ++i) {
+                auto mini_chunk = create_chunk(
+                    0,
+                    chunk.document_id,
+                    mini_slices[i],
+                    chunk.title_prefix,
+                    chunk.metadata_suffix_semantic,
+                    chunk.metadata_suffix_keyword,
+                    i > 0
+                );
+                
+                // Set mini-chunk specific properties
+                mini_chunk.mini_chunk_texts = mini_texts;
+                mini_chunk.large_chunk_id = chunk.chunk_id;
+                mini_chunk.large_chunk_reference_ids = {chunk.chunk_id};
+                
+                siblings.push_back(std::move(mini_chunk));
+            }
+        }
+    });
+    
+    size_t total = 0;
+    for (const auto& siblings : per_parent) {
+        total += siblings.size();
+    }
+    mini_chunks.reserve(total);
+    for (auto& siblings : per_parent) {
+        for (auto& mini_chunk : siblings) {
+            mini_chunk.chunk_id = static_cast<int>(mini_chunks.size());
+            mini_chunks.push_back(std::move(mini_chunk));
         }
     }
     
@@ -149,52 +188,62 @@ std::vector<DocumentChunk> MultipassChunker::generate_mini_chunks(
 std::vector<DocumentChunk> MultipassChunker::generate_large_chunks(
     const std::vector<DocumentChunk>& chunks
 ) {
-    std::vector<DocumentChunk> large_chunks;
-    
     if (chunks.empty()) {
-        return large_chunks;
+        return {};
     }
     
-    // Group chunks into large chunks based on ratio
-    for (size_t i = 0; i < chunks.size(); i += large_chunk_ratio_) {
-        size_t end_idx = std::min(i + large_chunk_ratio_, chunks.size());
-        
-        // Combine content from multiple chunks
-        std::string combined_content;
-        std::vector<int> reference_ids;
-        
-        for (size_t j = i; j < end_idx; ++j) {
-            if (!combined_content.empty()) {
-                combined_content += "\n\n";
+    // Group chunks into large chunks based on ratio; groups are built in parallel
+    const size_t ratio = std::max<size_t>(large_chunk_ratio_, 1);
+    std::vector<DocumentChunk> large_chunks((chunks.size() + ratio - 1) / ratio);
+    
+    parallel::parallel_for(thread_pool_, large_chunks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t g = begin; g < end; ++g) {
+            size_t i = g * ratio;
+            size_t end_idx = std::min(i + ratio, chunks.size());
+            
+            // Combine content from multiple chunks
+            size_t combined_length = 0;
+            for (size_t j = i; j < end_idx; ++j) {
+                combined_length += chunks[j].content.size() + 2;
+            }
+            std::string combined_content;
+            combined_content.reserve(combined_length);
+            std::vector<int> reference_ids;
+            reference_ids.reserve(end_idx - i);
+            
+            for (size_t j = i; j < end_idx; ++j) {
+                if (!combined_content.empty()) {
+                    combined_content += "\n\n";
+                }
+                combined_content += chunks[j].content.view();
+                reference_ids.push_back(chunks[j].chunk_id);
             }
-            combined_content += chunks[j].content;
-            reference_ids.push_back(chunks[j].chunk_id);
+            
+            // Create large chunk
+            auto large_chunk = create_chunk(
+                static_cast<int>(g),
+                chunks[i].document_id,
+                std::move(combined_content),
+                chunks[i].title_prefix,
+                chunks[i].metadata_suffix_semantic,
+                chunks[i].metadata_suffix_keyword,
+                false
+            );
+            
+            // Set large chunk specific properties
+            large_chunk.large_chunk_id = static_cast<int>(g);
+            large_chunk.large_chunk_reference_ids = std::move(reference_ids);
+            
+            large_chunks[g] = std::move(large_chunk);
         }
-        
-        // Create large chunk
-        auto large_chunk = create_chunk(
-            large_chunks.size(),
-            chunks[i].document_id,
-            combined_content,
-            chunks[i].title_prefix,
-            chunks[i].metadata_suffix_semantic,
-            chunks[i].metadata_suffix_keyword,
-            false
-        );
-        
-        // Set large chunk specific properties
-        large_chunk.large_chunk_id = large_chunks.size();
-        large_chunk.large_chunk_reference_ids = reference_ids;
-        
-        large_chunks.push_back(large_chunk);
-    }
+    });
     
     return large_chunks;
 }
 
-std::string MultipassChunker::extract_blurb(const std::string& text) const {
+size_t MultipassChunker::blurb_length(std::string_view text) const {
     if (text.empty()) {
-        return "";
+        return 0;
     }
     
     // Extract first sentence or first 100 characters
@@ -213,17 +262,17 @@ std::string MultipassChunker::extract_blurb(const std::string& text) const {
         end_pos = std::min(end_pos, first_question + 1);
     }
     
-    std::string blurb = text.substr(0, std::min(end_pos, size_t(100)));
+    size_t length = std::min(end_pos, size_t(100));
     
     // Clean up the blurb
-    while (!blurb.empty() && std::isspace(blurb.back())) {
-        blurb.pop_back();
+    while (length > 0 && std::isspace(static_cast<unsigned char>(text[length - 1]))) {
+        length--;
     }
     
-    return blurb;
+    return length;
 }
 
-std::vector<std::string> MultipassChunker::get_mini_chunk_texts(const std::string& chunk_text) const {
+std::vector<std::string> MultipassChunker::get_mini_chunk_texts(std::string_view chunk_text) const {
     if (!mini_chunker_ || chunk_text.empty()) {
         return {};
     }
@@ -279,33 +328,43 @@ std::string MultipassChunker::create_metadata_keyword(
 DocumentChunk MultipassChunker::create_chunk(
     int chunk_id,
     const std::string& document_id,
-    const std::string& content,
-    const std::string& title_prefix,
-    const std::string& metadata_semantic,
-    const std::string& metadata_keyword,
+    SharedText content,
+    const SharedText& title_prefix,
+    const SharedText& metadata_semantic,
+    const SharedText& metadata_keyword,
     bool is_continuation
 ) const {
     DocumentChunk chunk;
     
     chunk.chunk_id = chunk_id;
     chunk.document_id = document_id;
-    chunk.blurb = extract_blurb(content);
-    chunk.content = content;
+    chunk.blurb = content.slice(0, blurb_length(content));
+    chunk.content = std::move(content);
     chunk.title_prefix = title_prefix;
     chunk.metadata_suffix_semantic = metadata_semantic;
     chunk.metadata_suffix_keyword = metadata_keyword;
     chunk.section_continuation = is_continuation;
     
-    // Calculate basic quality metrics
+    // Calculate basic quality metrics; words are views into the shared
+    // content, split on whitespace like operator>>
     size_t word_count = 0;
     size_t unique_words = 0;
-    std::unordered_set<std::string> words;
+    std::unordered_set<std::string_view, utils::WyHash> words;
     
-    std::stringstream ss(content);
-    std::string word;
-    while (ss >> word) {
-        word_count++;
-        words.insert(word);
+    std::string_view text = chunk.content.view();
+    size_t pos = 0;
+    while (pos < text.size()) {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            ++pos;
+        }
+        size_t begin = pos;
+        while (pos < text.size() && !std::isspace(static_cast<unsigned char>(text[pos]))) {
+            ++pos;
+        }
+        if (pos > begin) {
+            word_count++;
+            words.insert(text.substr(begin, pos - begin));
+        }
     }
     
     unique_words = words.size();
@@ -1,68 +1,252 @@
 #include "r3m/chunking/quality_assessment/quality_calculator.hpp"
+#include "r3m/utils/hash.hpp"
+#include "r3m/utils/simd_utils.hpp"
+
+#include <array>
+#include <bit>
 
 namespace r3m {
 namespace chunking {
 namespace quality_assessment {
 
-double QualityCalculator::calculate_word_diversity(const std::string& text) {
-    // Simple word diversity calculation
-    std::unordered_set<std::string> unique_words;
-    std::istringstream iss(text);
-    std::string word;
-    
-    while (iss >> word) {
-        unique_words.insert(word);
+namespace {
+
+using utils::ByteSet;
+using utils::SIMDKernels;
+
+// Scores saturate at these counts, so counting stops there
+constexpr size_t DIVERSITY_SATURATION = 100;    // Distinct words
+constexpr size_t DENSITY_SATURATION = 50;       // Distinct alphanumeric bytes
+constexpr double SENTENCE_LENGTH_SATURATION = 20.0;
+constexpr double LENGTH_SATURATION = 1000.0;
+
+// Bitmaps are built per window of this many bytes so they stay on the stack
+constexpr size_t SCAN_WINDOW = 4096;
+constexpr size_t WINDOW_WORDS = SCAN_WINDOW / 64;
+
+constexpr ByteSet make_byte_set(std::string_view members) {
+    ByteSet set{};
+    for (char ch : members) {
+        unsigned char c = static_cast<unsigned char>(ch);
+        uint8_t* rows = c < 0x80 ? set.low_rows : set.high_rows;
+        rows[c & 0x0F] |= static_cast<uint8_t>(1u << ((c >> 4) & 7));
     }
-    
-    return std::min(1.0, static_cast<double>(unique_words.size()) / 100.0);
+    return set;
 }
 
-double QualityCalculator::calculate_sentence_structure(const std::string& text) {
-    // Simple sentence structure calculation
-    int sentences = 0;
-    int words = 0;
-    
-    std::istringstream iss(text);
-    std::string word;
-    
-    while (iss >> word) {
-        words++;
-        if (word.find('.') != std::string::npos || 
-            word.find('!') != std::string::npos || 
-            word.find('?') != std::string::npos) {
-            sentences++;
+// std::isspace in the "C" locale, which is how operator>> splits words
+constexpr ByteSet WHITESPACE_SET = make_byte_set(" \t\n\v\f\r");
+constexpr ByteSet SENTENCE_MARK_SET = make_byte_set(".!?");
+
+// 256-bit mask of the bytes std::isalnum accepts in the "C" locale
+constexpr std::array<uint64_t, 4> make_alphanumeric_mask() {
+    std::array<uint64_t, 4> mask{};
+    auto add_range = [&mask](unsigned char first, unsigned char last) {
+        for (unsigned c = first; c <= last; ++c) {
+            mask[c >> 6] |= uint64_t{1} << (c & 63);
         }
+    };
+    add_range('0', '9');
+    add_range('A', 'Z');
+    add_range('a', 'z');
+    return mask;
+}
+
+constexpr std::array<uint64_t, 4> ALPHANUMERIC_MASK = make_alphanumeric_mask();
+
+size_t count_alphanumeric(const std::array<uint64_t, 4>& present) {
+    size_t count = 0;
+    for (size_t i = 0; i < present.size(); ++i) {
+        count += static_cast<size_t>(std::popcount(present[i] & ALPHANUMERIC_MASK[i]));
     }
-    
-    if (sentences == 0) return 0.0;
-    double avg_sentence_length = static_cast<double>(words) / sentences;
-    return std::min(1.0, avg_sentence_length / 20.0);
+    return count;
 }
 
-double QualityCalculator::calculate_information_density(const std::string& text) {
-    // Simple information density calculation
-    std::unordered_set<char> chars;
-    
-    for (char c : text) {
-        if (std::isalnum(c)) {
-            chars.insert(c);
+/**
+ * Open-addressing set for the first DIVERSITY_SATURATION distinct words.
+ * Holds views into the scanned text; the table is sized for a load factor
+ * below 0.4 so probes stay short.
+ */
+class SaturatingWordSet {
+public:
+    void clear() {
+        slots_.fill(Slot{});
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    bool saturated() const { return size_ >= DIVERSITY_SATURATION; }
+
+    void insert(std::string_view word) {
+        const uint64_t hash = utils::wyhash(word);
+        size_t index = static_cast<size_t>(hash) & (CAPACITY - 1);
+        while (slots_[index].length != 0) {
+            const Slot& slot = slots_[index];
+            if (slot.hash == hash && std::string_view(slot.data, slot.length) == word) {
+                return;
+            }
+            index = (index + 1) & (CAPACITY - 1);
         }
+        slots_[index] = Slot{hash, word.data(), word.size()};
+        ++size_;
     }
-    
-    return std::min(1.0, static_cast<double>(chars.size()) / 50.0);
+
+private:
+    static constexpr size_t CAPACITY = 256;
+
+    // Words are never empty, so length 0 marks a free slot
+    struct Slot {
+        uint64_t hash = 0;
+        const char* data = nullptr;
+        size_t length = 0;
+    };
+
+    std::array<Slot, CAPACITY> slots_{};
+    size_t size_ = 0;
+};
+
+// Word and sentence state carried from one 64-byte bitmap word to the next
+struct ScanState {
+    bool previous_in_word = false;   // Byte before the current bitmap word was not whitespace
+    bool start_since_mark = false;   // A word started after the last sentence mark
+    size_t word_begin = 0;           // Offset of the open word (while collecting words)
+    bool word_open = false;
+};
+
+ChunkQuality score_text(std::string_view text, const SIMDKernels& kernels, SaturatingWordSet& words) {
+    ChunkQuality quality;
+    words.clear();
+
+    const char* data = text.data();
+    const size_t length = text.size();
+    std::array<uint64_t, 4> present{};
+    bool density_saturated = false;
+    ScanState state;
+
+    uint64_t spaces[WINDOW_WORDS];
+    uint64_t marks[WINDOW_WORDS];
+
+    for (size_t window = 0; window < length; window += SCAN_WINDOW) {
+        const size_t window_length = std::min(SCAN_WINDOW, length - window);
+        const char* window_data = data + window;
+
+        // Distinct bytes: until the density score saturates, OR each byte
+        // into the presence mask and check once per window
+        if (!density_saturated) {
+            for (size_t i = 0; i < window_length; ++i) {
+                const unsigned char c = static_cast<unsigned char>(window_data[i]);
+                present[c >> 6] |= uint64_t{1} << (c & 63);
+            }
+            density_saturated = count_alphanumeric(present) >= DENSITY_SATURATION;
+        }
+
+        kernels.set_mask(window_data, window_length, WHITESPACE_SET, spaces);
+        kernels.set_mask(window_data, window_length, SENTENCE_MARK_SET, marks);
+
+        const size_t bitmap_words = (window_length + 63) / 64;
+        for (size_t k = 0; k < bitmap_words; ++k) {
+            const size_t remaining = window_length - k * 64;
+            const uint64_t valid = remaining >= 64 ? ~uint64_t{0} : (uint64_t{1} << remaining) - 1;
+            const uint64_t in_word = ~spaces[k] & valid;
+            const uint64_t after_word = (in_word << 1) | uint64_t{state.previous_in_word};
+            const uint64_t starts = in_word & ~after_word;
+
+            quality.word_count += static_cast<size_t>(std::popcount(starts));
+
+            // A word ends a sentence if it contains a mark, so a mark counts
+            // when some word started between the previous mark and it
+            uint64_t pending_marks = marks[k];
+            uint64_t consumed = 0;
+            while (pending_marks != 0) {
+                const int bit = std::countr_zero(pending_marks);
+                const uint64_t through_mark = bit == 63 ? ~uint64_t{0} : (uint64_t{2} << bit) - 1;
+                if (state.start_since_mark || (starts & through_mark & ~consumed) != 0) {
+                    ++quality.sentence_count;
+                }
+                state.start_since_mark = false;
+                consumed = through_mark;
+                pending_marks &= pending_marks - 1;
+            }
+            state.start_since_mark = state.start_since_mark || (starts & ~consumed) != 0;
+
+            // Collect distinct words from start/end boundaries until saturated
+            if (!words.saturated()) {
+                const size_t base = window + k * 64;
+                uint64_t boundaries = starts | (spaces[k] & valid & after_word);
+                while (boundaries != 0 && !words.saturated()) {
+                    const size_t position = base + static_cast<size_t>(std::countr_zero(boundaries));
+                    if (state.word_open) {
+                        words.insert(std::string_view(data + state.word_begin, position - state.word_begin));
+                        state.word_open = false;
+                    } else {
+                        state.word_begin = position;
+                        state.word_open = true;
+                    }
+                    boundaries &= boundaries - 1;
+                }
+            }
+
+            state.previous_in_word = remaining >= 64 ? (in_word >> 63) != 0
+                                                     : ((in_word >> (remaining - 1)) & 1) != 0;
+        }
+    }
+    if (state.word_open && !words.saturated()) {
+        words.insert(std::string_view(data + state.word_begin, length - state.word_begin));
+    }
+
+    quality.distinct_alphanumeric = std::min(count_alphanumeric(present), DENSITY_SATURATION);
+    quality.distinct_words = std::min(words.size(), DIVERSITY_SATURATION);
+
+    quality.word_diversity = std::min(1.0, static_cast<double>(quality.distinct_words) /
+                                               static_cast<double>(DIVERSITY_SATURATION));
+    if (quality.sentence_count != 0) {
+        double avg_sentence_length = static_cast<double>(quality.word_count) / quality.sentence_count;
+        quality.sentence_structure = std::min(1.0, avg_sentence_length / SENTENCE_LENGTH_SATURATION);
+    }
+    quality.information_density = std::min(1.0, static_cast<double>(quality.distinct_alphanumeric) /
+                                                    static_cast<double>(DENSITY_SATURATION));
+
+    double length_factor = std::min(1.0, static_cast<double>(length) / LENGTH_SATURATION);
+    quality.quality_score = (length_factor * 0.3 + quality.word_diversity * 0.3 +
+                             quality.sentence_structure * 0.2 + quality.information_density * 0.2);
+    return quality;
+}
+
+} // namespace
+
+ChunkQuality QualityCalculator::score(std::string_view text) {
+    return score(text, utils::SIMDUtils::kernels());
+}
+
+ChunkQuality QualityCalculator::score(std::string_view text, const utils::SIMDKernels& kernels) {
+    SaturatingWordSet words;
+    return score_text(text, kernels, words);
+}
+
+void QualityCalculator::score_batch(std::span<const std::string_view> texts, std::span<ChunkQuality> out) {
+    const SIMDKernels& kernels = utils::SIMDUtils::kernels();
+    SaturatingWordSet words;
+    for (size_t i = 0; i < texts.size(); ++i) {
+        out[i] = score_text(texts[i], kernels, words);
+    }
+}
+
+double QualityCalculator::calculate_word_diversity(std::string_view text) {
+    return score(text).word_diversity;
+}
+
+double QualityCalculator::calculate_sentence_structure(std::string_view text) {
+    return score(text).sentence_structure;
+}
+
+double QualityCalculator::calculate_information_density(std::string_view text) {
+    return score(text).information_density;
 }
 
-double QualityCalculator::calculate_quality_score(const std::string& text) {
-    // Calculate quality score (0.0 - 1.0)
-    double length_factor = std::min(1.0, static_cast<double>(text.length()) / 1000.0);
-    double word_diversity = calculate_word_diversity(text);
-    double sentence_structure = calculate_sentence_structure(text);
-    double information_density = calculate_information_density(text);
-    
-    return (length_factor * 0.3 + word_diversity * 0.3 + 
-            sentence_structure * 0.2 + information_density * 0.2);
+double QualityCalculator::calculate_quality_score(std::string_view text) {
+    return score(text).quality_score;
 }
 
 } // namespace quality_assessment
 } // namespace chunking
-} // namespace r3m 
\ No newline at end of file
+} // namespace r3m
@@ -8,9 +8,23 @@ namespace r3m {
 namespace chunking {
 namespace section_processing {
 
+namespace {
+
+std::string_view trim_whitespace(std::string_view text) {
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+} // namespace
+
 SectionProcessor::SectionProcessor(
     std::shared_ptr<Tokenizer> tokenizer)
-    : tokenizer_(tokenizer), optimized_cache_(std::make_unique<token_management::OptimizedTokenCache>(tokenizer)) {
+    : tokenizer_(tokenizer), token_counts_(&token_management::SharedTokenCache::instance()) {
     
     // Initialize chunk splitter for oversized sections
     chunk_splitter_ = std::make_unique<SentenceChunker>(
@@ -23,179 +37,203 @@ std::vector<DocumentChunk> SectionProcessor::process_sections_with_combinations(
     const TokenManagementResult& token_result,
     const std::string& document_id,
     const std::string& source_type,
-    const std::string& semantic_identifier) {
+    const std::string& semantic_identifier,
+    bool score_chunks,
+    std::string_view document_text) {
     
     std::vector<DocumentChunk> chunks;
     chunks.reserve(sections.size() + 1); // Pre-allocate for efficiency
     
-    std::unordered_map<int, std::string> link_offsets;
-    std::string chunk_text("");
-    chunk_text.reserve(token_result.content_token_limit * 4); // Pre-allocate string capacity
+    CombineStream stream(*this, token_result, document_id, source_type, semantic_identifier,
+                         [&chunks](DocumentChunk&& chunk) { chunks.push_back(std::move(chunk)); },
+                         score_chunks);
     
-    int chunk_id = 0;
+    for (const auto& section : sections) {
+        stream.add_section(section, document_text);
+    }
+    stream.finish();
     
-    // Pre-cache common strings using string_view
+    return chunks;
+}
+
+SectionProcessor::CombineStream::CombineStream(
+    SectionProcessor& processor,
+    const TokenManagementResult& token_result,
+    const std::string& document_id,
+    const std::string& source_type,
+    const std::string& semantic_identifier,
+    ChunkSink sink,
+    bool score_chunks)
+    : processor_(processor), token_result_(token_result), document_id_(document_id),
+      source_type_(source_type), semantic_identifier_(semantic_identifier), sink_(std::move(sink)),
+      score_chunks_(score_chunks) {
+    
+    // The separator is counted once per process through the shared cache
+    separator_tokens_ = processor_.cached_token_count(utils::TextProcessing::SECTION_SEPARATOR);
+    separator_cleaned_length_ = static_cast<int>(
+        utils::TextProcessing::precompare_cleanup_length(utils::TextProcessing::SECTION_SEPARATOR));
+}
+
+DocumentChunk SectionProcessor::CombineStream::make_chunk(
+    SharedText content, const std::string& link, const std::string& image_file_id, bool is_continuation) {
+    auto chunk = processor_.build_chunk(
+        std::move(content), link, image_file_id, chunk_id_++, document_id_,
+        token_result_.title_prefix, token_result_.metadata_suffix_semantic,
+        token_result_.metadata_suffix_keyword, token_result_.title_tokens,
+        token_result_.metadata_tokens, token_result_.content_token_limit,
+        source_type_, semantic_identifier_, is_continuation
+    );
+    if (score_chunks_) {
+        score_chunk(chunk);
+    }
+    return chunk;
+}
+
+SharedText SectionProcessor::CombineStream::take_pending_text() {
+    // A chunk of a single section shares that section's buffer; a combined
+    // chunk hands its assembled string over without copying it
+    SharedText text = chunk_head_ ? SharedText(std::move(chunk_head_)) : SharedText(std::move(chunk_text_));
+    chunk_head_.reset();
+    chunk_text_.clear();
+    chunk_cleaned_length_ = 0;
+    chunk_token_count_ = 0;
+    return text;
+}
+
+void SectionProcessor::CombineStream::flush_text_chunk(bool attach_links) {
+    if (!chunk_head_ && chunk_text_.empty()) {
+        return;
+    }
+    
+    auto chunk = make_chunk(take_pending_text(), "", "", false);
+    if (attach_links) {
+        chunk.source_links = link_offsets_;
+    }
+    sink_(std::move(chunk));
+    
+    link_offsets_.clear();
+}
+
+void SectionProcessor::CombineStream::add_section(const DocumentSection& section, std::string_view document_text) {
     const std::string_view section_separator = utils::TextProcessing::SECTION_SEPARATOR;
-    const int separator_tokens = optimized_cache_->get_token_count(section_separator);
     
-    // Pre-allocate vectors for efficiency
-    std::vector<std::string> section_texts;
-    std::vector<int> section_token_counts;
-    section_texts.reserve(sections.size());
-    section_token_counts.reserve(sections.size());
+    // Text that cleaning would leave unchanged is read in place; only other
+    // text is cleaned into a copy
+    const std::string_view raw_text = section.text(document_text);
+    const bool already_clean = utils::TextProcessing::is_clean_text(raw_text);
+    std::string cleaned = already_clean ? std::string() : utils::TextProcessing::clean_text(std::string(raw_text));
+    const std::string_view section_text = already_clean ? raw_text : std::string_view(cleaned);
     
-    // Pre-process all sections to avoid repeated operations
-    for (const auto& section : sections) {
-        std::string cleaned_text = utils::TextProcessing::clean_text(section.content);
-        if (!cleaned_text.empty()) {
-            section_texts.push_back(cleaned_text);
-            section_token_counts.push_back(optimized_cache_->get_token_count(cleaned_text));
-        } else {
-            section_texts.push_back("");
-            section_token_counts.push_back(0);
-        }
+    // Skip empty sections
+    if (section_text.empty()) {
+        return;
     }
-    
-    for (size_t section_idx = 0; section_idx < sections.size(); ++section_idx) {
-        const auto& section = sections[section_idx];
-        const auto& section_text = section_texts[section_idx];
-        const int section_token_count = section_token_counts[section_idx];
-        
-        // Skip empty sections
-        if (section_text.empty()) {
-            continue;
-        }
-        
-        std::string_view section_link_text = section.link;
-        std::string_view image_url = section.image_file_id;
+    // A count the caller supplied is for the uncleaned text
+    const int section_token_count = already_clean && section.token_count > 0
+        ? section.token_count : processor_.cached_token_count(section_text);
+    
+    // The buffer chunks slice is only built when the section starts a chunk
+    // or is emitted on its own; section_text is not read afterwards
+    auto take_section_buffer = [&]() -> SharedText::Buffer {
+        return std::make_shared<const std::string>(already_clean ? std::string(section_text) : std::move(cleaned));
+    };
+    
+    const std::string& section_link_text = section.link;
+    const std::string& image_url = section.image_file_id;
+    
+    // CASE 1: If this section has an image, force a separate chunk
+    if (!image_url.empty()) {
+        // First, finalize any existing text chunk
+        flush_text_chunk(false);
         
-        // CASE 1: If this section has an image, force a separate chunk
-        if (!image_url.empty()) {
-            // First, finalize any existing text chunk
-            if (!chunk_text.empty()) {
-                auto chunk = create_chunk_from_section(
-                    DocumentSection(std::string(chunk_text), ""), chunk_id++, document_id,
-                    token_result.title_prefix, token_result.metadata_suffix_semantic,
-                    token_result.metadata_suffix_keyword, token_result.content_token_limit,
-                    source_type, semantic_identifier, false
-                );
-                chunks.push_back(chunk);
-                chunk_text.clear();
-                chunk_text.reserve(token_result.content_token_limit * 4);
-                link_offsets.clear();
-            }
-            
-            // Create a chunk specifically for this image section
-            DocumentSection image_section{std::string(section_text), std::string(section_link_text)};
-            image_section.image_file_id = std::string(image_url);
-            auto chunk = create_chunk_from_section(
-                image_section, chunk_id++, document_id,
-                token_result.title_prefix, token_result.metadata_suffix_semantic,
-                token_result.metadata_suffix_keyword, token_result.content_token_limit,
-                source_type, semantic_identifier, false
-            );
-            chunks.push_back(chunk);
-            continue;
-        }
+        // Create a chunk specifically for this image section
+        sink_(make_chunk(SharedText(take_section_buffer()), section_link_text, image_url, false));
+        return;
+    }
+    
+    // CASE 2: Normal text section - use pre-computed token count
+    if (section_token_count > token_result_.content_token_limit) {
+        // Finalize existing chunk
+        flush_text_chunk(true);
         
-        // CASE 2: Normal text section - use pre-computed token count
-        if (section_token_count > token_result.content_token_limit) {
-            // Finalize existing chunk
-            if (!chunk_text.empty()) {
-                auto chunk = create_chunk_from_section(
-                    DocumentSection(std::string(chunk_text), ""), chunk_id++, document_id,
-                    token_result.title_prefix, token_result.metadata_suffix_semantic,
-                    token_result.metadata_suffix_keyword, token_result.content_token_limit,
-                    source_type, semantic_identifier, false
-                );
-                chunk.source_links = link_offsets;
-                chunks.push_back(chunk);
-                chunk_text.clear();
-                chunk_text.reserve(token_result.content_token_limit * 4);
-                link_offsets.clear();
-            }
+        // Split the oversized section at token offsets; every piece is a
+        // slice of the section buffer
+        const SharedText whole_section(take_section_buffer());
+        const std::string_view buffered_text = whole_section.view();
+        auto slice_of_section = [&](std::string_view piece) {
+            return whole_section.slice(static_cast<size_t>(piece.data() - buffered_text.data()), piece.size());
+        };
+        auto split_texts = processor_.split_oversized_chunk_optimized(buffered_text, token_result_.content_token_limit);
+        for (size_t i = 0; i < split_texts.size(); ++i) {
+            std::string_view split_text = split_texts[i];
             
-            // Split the oversized section using optimized approach
-            auto split_texts = split_oversized_chunk_optimized(std::string(section_text), token_result.content_token_limit);
-            for (size_t i = 0; i < split_texts.size(); ++i) {
-                const auto& split_text = split_texts[i];
-                
-                // Check if even the split text is too big (STRICT_CHUNK_TOKEN_LIMIT)
-                if (optimized_cache_->get_token_count(split_text) > token_result.content_token_limit) {
-                    auto smaller_chunks = split_oversized_chunk_optimized(split_text, token_result.content_token_limit);
-                    for (size_t j = 0; j < smaller_chunks.size(); ++j) {
-                        DocumentSection sub_section(smaller_chunks[j], std::string(section_link_text));
-                        auto chunk = create_chunk_from_section(
-                            sub_section, chunk_id++, document_id,
-                            token_result.title_prefix, token_result.metadata_suffix_semantic,
-                            token_result.metadata_suffix_keyword, token_result.content_token_limit,
-                            source_type, semantic_identifier, (j != 0)
-                        );
-                        chunks.push_back(chunk);
-                    }
-                } else {
-                    DocumentSection sub_section(split_text, std::string(section_link_text));
-                    auto chunk = create_chunk_from_section(
-                        sub_section, chunk_id++, document_id,
-                        token_result.title_prefix, token_result.metadata_suffix_semantic,
-                        token_result.metadata_suffix_keyword, token_result.content_token_limit,
-                        source_type, semantic_identifier, (i != 0)
-                    );
-                    chunks.push_back(chunk);
+            // Check if even the split text is too big (STRICT_CHUNK_TOKEN_LIMIT)
+            if (processor_.cached_token_count(split_text) > token_result_.content_token_limit) {
+                auto smaller_chunks = processor_.split_oversized_chunk_optimized(split_text, token_result_.content_token_limit);
+                for (size_t j = 0; j < smaller_chunks.size(); ++j) {
+                    sink_(make_chunk(slice_of_section(smaller_chunks[j]), section_link_text, "", (j != 0)));
                 }
+            } else {
+                sink_(make_chunk(slice_of_section(split_text), section_link_text, "", (i != 0)));
             }
-            continue;
         }
-        
-        // CASE 3: Try to combine sections - use pre-computed token counts
-        int current_token_count = chunk_text.empty() ? 0 : optimized_cache_->get_token_count(chunk_text);
-        int current_offset = static_cast<int>(utils::TextProcessing::shared_precompare_cleanup(chunk_text).length());
-        int next_section_tokens = separator_tokens + section_token_count;
-        
-        if (next_section_tokens + current_token_count <= token_result.content_token_limit) {
-            // Can combine sections - use efficient string operations
-            if (!chunk_text.empty()) {
-                chunk_text += section_separator;
-            }
-            chunk_text += section_text;
-            link_offsets[current_offset] = std::string(section_link_text);
+        return;
+    }
+    
+    // CASE 3: Try to combine sections - use pre-computed token counts
+    const std::string& current_text = chunk_head_ ? *chunk_head_ : chunk_text_;
+    const int section_cleaned_length = static_cast<int>(utils::TextProcessing::precompare_cleanup_length(section_text));
+    const bool has_pending_text = !current_text.empty();
+    int next_section_tokens = separator_tokens_ + section_token_count;
+    
+    if (next_section_tokens + chunk_token_count_ <= token_result_.content_token_limit) {
+        // Can combine sections - only a second section forces the text to be assembled
+        if (chunk_head_) {
+            chunk_text_.reserve(chunk_head_->size() + section_separator.size() + section_text.size());
+            chunk_text_ = *chunk_head_;
+            chunk_head_.reset();
+        }
+        if (!chunk_text_.empty()) {
+            chunk_text_ += section_separator;
+            chunk_text_ += section_text;
         } else {
-            // Finalize existing chunk and start new one
-            if (!chunk_text.empty()) {
-                auto chunk = create_chunk_from_section(
-                    DocumentSection(std::string(chunk_text), ""), chunk_id++, document_id,
-                    token_result.title_prefix, token_result.metadata_suffix_semantic,
-                    token_result.metadata_suffix_keyword, token_result.content_token_limit,
-                    source_type, semantic_identifier, false
-                );
-                chunk.source_links = link_offsets;
-                chunks.push_back(chunk);
-            }
-            
-            // Start new chunk - use move semantics for efficiency
-            link_offsets = {{0, std::string(section_link_text)}};
-            chunk_text = section_text;
+            chunk_head_ = take_section_buffer();
         }
+        // The link offset is the cleaned length of the text before the section;
+        // it and the token count are running sums instead of re-scanning the
+        // growing chunk
+        link_offsets_[chunk_cleaned_length_] = section_link_text;
+        if (has_pending_text) {
+            chunk_cleaned_length_ += separator_cleaned_length_;
+            chunk_token_count_ += separator_tokens_;
+        }
+        chunk_cleaned_length_ += section_cleaned_length;
+        chunk_token_count_ += section_token_count;
+    } else {
+        // Finalize existing chunk and start new one
+        flush_text_chunk(true);
+        
+        link_offsets_ = {{0, section_link_text}};
+        chunk_head_ = take_section_buffer();
+        chunk_cleaned_length_ = section_cleaned_length;
+        chunk_token_count_ = section_token_count;
     }
-    
+}
+
+void SectionProcessor::CombineStream::finish() {
     // Finalize any leftover text chunk
-    if (!chunk_text.empty() || chunks.empty()) {
-        auto chunk = create_chunk_from_section(
-            DocumentSection(std::string(chunk_text), ""), chunk_id++, document_id,
-            token_result.title_prefix, token_result.metadata_suffix_semantic,
-            token_result.metadata_suffix_keyword, token_result.content_token_limit,
-            source_type, semantic_identifier, false
-        );
+    if (chunk_head_ || !chunk_text_.empty() || chunk_id_ == 0) {
+        auto chunk = make_chunk(take_pending_text(), "", "", false);
         // Set link offsets (safe default if empty)
-        if (!link_offsets.empty()) {
-            chunk.source_links = link_offsets;
+        if (!link_offsets_.empty()) {
+            chunk.source_links = link_offsets_;
         } else {
             chunk.source_links = {{0, ""}};
         }
-        chunks.push_back(chunk);
+        sink_(std::move(chunk));
+        
+        link_offsets_.clear();
     }
-    
-    return chunks;
 }
 
 std::vector<DocumentSection> SectionProcessor::split_oversized_sections(
@@ -205,7 +243,7 @@ std::vector<DocumentSection> SectionProcessor::split_oversized_sections(
     std::vector<DocumentSection> split_sections;
     
     for (const auto& section : sections) {
-        int section_tokens = static_cast<int>(tokenizer_->count_tokens(section.content));
+        int section_tokens = cached_token_count(section.content);
         
         if (section_tokens <= content_token_limit) {
             split_sections.push_back(section);
@@ -285,35 +323,29 @@ std::vector<std::string> SectionProcessor::split_oversized_chunk(
     return chunks;
 }
 
-std::vector<std::string> SectionProcessor::split_oversized_chunk_optimized(
-    const std::string& text,
+std::vector<std::string_view> SectionProcessor::split_oversized_chunk_optimized(
+    std::string_view text,
     int content_token_limit) {
     
-    // Use direct tokenization for maximum performance
-    auto tokens = tokenizer_->tokenize(text);
+    // Token offsets instead of token strings: pieces are slices of text
+    auto spans = tokenizer_->token_spans(text);
+    const size_t limit = static_cast<size_t>(std::max(content_token_limit, 1));
     
-    std::vector<std::string> chunks;
-    chunks.reserve((tokens.size() / content_token_limit) + 1);
+    std::vector<std::string_view> chunks;
+    chunks.reserve((spans.size() / limit) + 1);
     
     size_t start = 0;
-    while (start < tokens.size()) {
-        size_t end = std::min(start + static_cast<size_t>(content_token_limit), tokens.size());
-        
-        // Pre-calculate the size needed for this chunk
-        size_t chunk_size = 0;
-        for (size_t i = start; i < end; ++i) {
-            chunk_size += tokens[i].length() + 1; // +1 for space
-        }
+    while (start < spans.size()) {
+        size_t end = std::min(start + limit, spans.size());
         
-        std::string chunk_text;
-        chunk_text.reserve(chunk_size);
-        
-        for (size_t i = start; i < end; ++i) {
-            if (!chunk_text.empty()) chunk_text += ' ';
-            chunk_text += tokens[i];
+        // Each piece runs up to the next piece's first token, so text the
+        // tokenizer skipped (not just whitespace) is kept
+        size_t begin_offset = start == 0 ? 0 : spans[start].begin;
+        size_t end_offset = end == spans.size() ? text.size() : spans[end].begin;
+        std::string_view chunk_text = trim_whitespace(text.substr(begin_offset, end_offset - begin_offset));
+        if (!chunk_text.empty()) {
+            chunks.push_back(chunk_text);
         }
-        
-        chunks.push_back(std::move(chunk_text));
         start = end;
     }
     
@@ -333,7 +365,7 @@ std::vector<DocumentSection> SectionProcessor::handle_image_sections(
             processed_sections.push_back(section);
         } else {
             // For text sections, check if they need splitting
-            int section_tokens = static_cast<int>(tokenizer_->count_tokens(section.content));
+            int section_tokens = cached_token_count(section.content);
             
             if (section_tokens <= content_token_limit) {
                 processed_sections.push_back(section);
@@ -357,9 +389,56 @@ DocumentChunk SectionProcessor::create_chunk_from_section(
     const DocumentSection& section,
     int chunk_id,
     const std::string& document_id,
-    const std::string& title_prefix,
-    const std::string& metadata_suffix_semantic,
-    const std::string& metadata_suffix_keyword,
+    const SharedText& title_prefix,
+    const SharedText& metadata_suffix_semantic,
+    const SharedText& metadata_suffix_keyword,
+    int content_token_limit,
+    const std::string& source_type,
+    const std::string& semantic_identifier,
+    bool is_continuation) {
+    
+    return create_chunk(
+        SharedText(section.content), section.link, section.image_file_id, chunk_id, document_id,
+        title_prefix, metadata_suffix_semantic, metadata_suffix_keyword, content_token_limit,
+        source_type, semantic_identifier, is_continuation
+    );
+}
+
+DocumentChunk SectionProcessor::create_chunk(
+    SharedText content,
+    const std::string& link,
+    const std::string& image_file_id,
+    int chunk_id,
+    const std::string& document_id,
+    const SharedText& title_prefix,
+    const SharedText& metadata_suffix_semantic,
+    const SharedText& metadata_suffix_keyword,
+    int content_token_limit,
+    const std::string& source_type,
+    const std::string& semantic_identifier,
+    bool is_continuation) {
+    
+    auto chunk = build_chunk(
+        std::move(content), link, image_file_id, chunk_id, document_id,
+        title_prefix, metadata_suffix_semantic, metadata_suffix_keyword,
+        cached_token_count(title_prefix.view()), cached_token_count(metadata_suffix_semantic.view()),
+        content_token_limit, source_type, semantic_identifier, is_continuation
+    );
+    score_chunk(chunk);
+    return chunk;
+}
+
+DocumentChunk SectionProcessor::build_chunk(
+    SharedText content,
+    const std::string& link,
+    const std::string& image_file_id,
+    int chunk_id,
+    const std::string& document_id,
+    const SharedText& title_prefix,
+    const SharedText& metadata_suffix_semantic,
+    const SharedText& metadata_suffix_keyword,
+    int title_tokens,
+    int metadata_tokens,
     int content_token_limit,
     const std::string& source_type,
     const std::string& semantic_identifier,
@@ -367,39 +446,44 @@ DocumentChunk SectionProcessor::create_chunk_from_section(
     
     DocumentChunk chunk;
     
-    // Basic chunk properties
+    // Basic chunk properties (text fields share their buffers)
     chunk.chunk_id = chunk_id;
     chunk.document_id = document_id;
     chunk.title_prefix = title_prefix;
     chunk.metadata_suffix_semantic = metadata_suffix_semantic;
     chunk.metadata_suffix_keyword = metadata_suffix_keyword;
-    chunk.content = section.content;
+    chunk.content = std::move(content);
     chunk.source_type = source_type;
     chunk.semantic_identifier = semantic_identifier;
     chunk.section_continuation = is_continuation;
     
-    // Token management
-    chunk.title_tokens = static_cast<int>(tokenizer_->count_tokens(title_prefix));
-    chunk.metadata_tokens = static_cast<int>(tokenizer_->count_tokens(metadata_suffix_semantic));
+    // Token management (counted once per document by the caller)
+    chunk.title_tokens = title_tokens;
+    chunk.metadata_tokens = metadata_tokens;
     chunk.content_token_limit = content_token_limit;
     
     // Section properties
-    if (!section.link.empty()) {
-        chunk.source_links[0] = section.link;
+    if (!link.empty()) {
+        chunk.source_links[0] = link;
     }
-    chunk.image_file_id = section.image_file_id;
+    chunk.image_file_id = image_file_id;
     
     // Extract blurb from content (simplified version)
-    chunk.blurb = section.content.substr(0, std::min(100UL, section.content.length()));
-    
-    // Calculate quality metrics
-    chunk.quality_score = quality_assessment::QualityCalculator::calculate_quality_score(chunk.content);
-    chunk.information_density = quality_assessment::QualityCalculator::calculate_information_density(chunk.content);
-    chunk.is_high_quality = chunk.quality_score >= 0.7;
+    chunk.blurb = chunk.content.slice(0, 100);
     
     return chunk;
 }
 
+void SectionProcessor::score_chunk(DocumentChunk& chunk) {
+    apply_quality(chunk, quality_assessment::QualityCalculator::score(chunk.content));
+}
+
+void SectionProcessor::apply_quality(DocumentChunk& chunk, const quality_assessment::ChunkQuality& quality) {
+    chunk.quality_score = quality.quality_score;
+    chunk.information_density = quality.information_density;
+    chunk.is_high_quality = chunk.quality_score >= 0.7;
+}
+
 } // namespace section_processing
 } // namespace chunking
 } // namespace r3m 
\ No newline at end of file
@@ -1,5 +1,4 @@
 #include "r3m/chunking/sentence_chunker.hpp"
-#include <sstream>
 #include <algorithm>
 #include <cctype>
 
@@ -15,25 +14,38 @@ SentenceChunker::SentenceChunker(
     chunk_overlap_(chunk_overlap), return_type_(return_type) {
 }
 
-std::vector<std::string> SentenceChunker::chunk(const std::string& text) const {
+std::vector<std::string> SentenceChunker::chunk(std::string_view text) const {
     if (text.empty()) {
         return {};
     }
     
-    // Split text into sentences
-    auto sentences = split_into_sentences(text);
+    // Cleaned sentences share one buffer; each is tokenized exactly once
+    std::string buffer;
+    buffer.reserve(text.size());
+    std::vector<Sentence> sentences;
+    split_into_sentences(text, buffer, sentences);
     
     // Merge sentences into chunks
-    return merge_sentences_into_chunks(sentences);
+    return merge_sentences_into_chunks(buffer, sentences);
 }
 
-std::vector<std::string> SentenceChunker::split_into_sentences(const std::string& text) const {
-    std::vector<std::string> sentences;
-    std::string current_sentence;
+void SentenceChunker::split_into_sentences(
+    std::string_view text,
+    std::string& buffer,
+    std::vector<Sentence>& sentences
+) const {
+    // Common abbreviations that end with period
+    static constexpr std::string_view abbreviations[] = {
+        "Mr", "Mrs", "Ms", "Dr", "Prof", "Sr", "Jr", "St", "Ave", "Blvd",
+        "Rd", "Ln", "Ct", "Pl", "etc", "vs", "i.e", "e.g", "a.m", "p.m"
+    };
+    
+    std::string_view view = text;
+    std::string scratch;
+    size_t sentence_start = 0;
     
     for (size_t i = 0; i < text.length(); ++i) {
         char c = text[i];
-        current_sentence += c;
         
         // Check for sentence endings
         if (c == '.' || c == '!' || c == '?') {
@@ -41,22 +53,15 @@ std::vector<std::string> SentenceChunker::split_into_sentences(const std::string
             bool is_sentence_end = true;
             
             // Check for abbreviations (e.g., "Mr.", "Dr.", "etc.")
-            if (i > 0 && std::isupper(text[i-1])) {
+            if (i > 0 && std::isupper(static_cast<unsigned char>(text[i - 1]))) {
                 // Check if next character is space and previous is uppercase
-                if (i + 1 < text.length() && std::isspace(text[i + 1])) {
-                    // This might be an abbreviation, check for common patterns
-                    std::string prev_word;
+                if (i + 1 < text.length() && std::isspace(static_cast<unsigned char>(text[i + 1]))) {
                     size_t j = i - 1;
-                    while (j > 0 && !std::isspace(text[j]) && std::isalpha(text[j])) {
-                        prev_word = text[j] + prev_word;
+                    while (j > 0 && !std::isspace(static_cast<unsigned char>(text[j])) &&
+                           std::isalpha(static_cast<unsigned char>(text[j]))) {
                         j--;
                     }
-                    
-                    // Common abbreviations that end with period
-                    static const std::vector<std::string> abbreviations = {
-                        "Mr", "Mrs", "Ms", "Dr", "Prof", "Sr", "Jr", "St", "Ave", "Blvd",
-                        "Rd", "Ln", "Ct", "Pl", "etc", "vs", "i.e", "e.g", "a.m", "p.m"
-                    };
+                    std::string_view prev_word = view.substr(j + 1, i - 1 - j);
                     
                     for (const auto& abbr : abbreviations) {
                         if (prev_word == abbr) {
@@ -68,111 +73,107 @@ std::vector<std::string> SentenceChunker::split_into_sentences(const std::string
             }
             
             if (is_sentence_end) {
-                std::string cleaned = clean_sentence(current_sentence);
-                if (!cleaned.empty()) {
-                    sentences.push_back(cleaned);
-                }
-                current_sentence.clear();
+                add_sentence(view.substr(sentence_start, i + 1 - sentence_start), buffer, sentences, scratch);
+                sentence_start = i + 1;
             }
         }
     }
     
     // Add any remaining text as a sentence
-    if (!current_sentence.empty()) {
-        std::string cleaned = clean_sentence(current_sentence);
-        if (!cleaned.empty()) {
-            sentences.push_back(cleaned);
-        }
+    if (sentence_start < text.length()) {
+        add_sentence(view.substr(sentence_start), buffer, sentences, scratch);
+    }
+}
+
+void SentenceChunker::add_sentence(
+    std::string_view raw,
+    std::string& buffer,
+    std::vector<Sentence>& sentences,
+    std::string& scratch
+) const {
+    size_t offset = buffer.size();
+    clean_sentence(raw, buffer);
+    size_t length = buffer.size() - offset;
+    if (length == 0) {
+        return;
     }
     
-    return sentences;
+    scratch.assign(buffer, offset, length);
+    sentences.push_back({offset, length, tokenizer_->count_tokens(scratch)});
 }
 
 std::vector<std::string> SentenceChunker::merge_sentences_into_chunks(
-    const std::vector<std::string>& sentences
+    const std::string& buffer,
+    const std::vector<Sentence>& sentences
 ) const {
     std::vector<std::string> chunks;
-    std::string current_chunk;
+    if (sentences.empty()) {
+        return chunks;
+    }
     
-    for (const auto& sentence : sentences) {
-        // Check if adding this sentence would exceed chunk size
-        std::string test_chunk = current_chunk;
-        if (!test_chunk.empty()) {
-            test_chunk += " ";
+    // Sentences are joined with a single space
+    const size_t separator_tokens = tokenizer_->count_tokens(std::string_view(" "));
+    
+    size_t first = 0;
+    size_t chunk_tokens = sentences[0].tokens;
+    size_t chunk_bytes = sentences[0].length;
+    
+    auto emit_chunk = [&](size_t end) {
+        std::string chunk;
+        chunk.reserve(chunk_bytes);
+        for (size_t k = first; k < end; ++k) {
+            if (k > first) {
+                chunk += ' ';
+            }
+            chunk.append(buffer, sentences[k].offset, sentences[k].length);
         }
-        test_chunk += sentence;
+        chunks.push_back(std::move(chunk));
+    };
+    
+    for (size_t i = 1; i < sentences.size(); ++i) {
+        const auto& sentence = sentences[i];
+        size_t combined_tokens = chunk_tokens + separator_tokens + sentence.tokens;
         
-        if (should_start_new_chunk(current_chunk, sentence)) {
-            // Start a new chunk
-            if (!current_chunk.empty()) {
-                chunks.push_back(current_chunk);
-            }
-            current_chunk = sentence;
+        // Start new chunk if adding the sentence would exceed the limit
+        if (combined_tokens > chunk_size_) {
+            emit_chunk(i);
+            first = i;
+            chunk_tokens = sentence.tokens;
+            chunk_bytes = sentence.length;
         } else {
-            // Add to current chunk
-            if (!current_chunk.empty()) {
-                current_chunk += " ";
-            }
-            current_chunk += sentence;
+            chunk_tokens = combined_tokens;
+            chunk_bytes += 1 + sentence.length;
         }
     }
     
     // Add the last chunk
-    if (!current_chunk.empty()) {
-        chunks.push_back(current_chunk);
-    }
+    emit_chunk(sentences.size());
     
     return chunks;
 }
 
-bool SentenceChunker::should_start_new_chunk(
-    const std::string& current_chunk,
-    const std::string& next_sentence
-) const {
-    // Calculate tokens for current chunk + next sentence
-    std::string combined = current_chunk;
-    if (!combined.empty()) {
-        combined += " ";
-    }
-    combined += next_sentence;
-    
-    size_t combined_tokens = tokenizer_->count_tokens(combined);
-    
-    // Start new chunk if adding the sentence would exceed the limit
-    return combined_tokens > chunk_size_;
-}
-
-std::string SentenceChunker::clean_sentence(const std::string& sentence) const {
-    std::string cleaned = sentence;
-    
+void SentenceChunker::clean_sentence(std::string_view sentence, std::string& out) {
     // Trim whitespace safely
-    size_t start = cleaned.find_first_not_of(" \t\n\r");
-    if (start != std::string::npos) {
-        cleaned = cleaned.substr(start);
-        size_t end = cleaned.find_last_not_of(" \t\n\r");
-        if (end != std::string::npos) {
-            cleaned = cleaned.substr(0, end + 1);
-        }
-    } else {
-        cleaned.clear();
+    size_t start = sentence.find_first_not_of(" \t\n\r");
+    if (start == std::string_view::npos) {
+        return;
     }
+    size_t end = sentence.find_last_not_of(" \t\n\r");
+    sentence = sentence.substr(start, end - start + 1);
     
     // Remove excessive whitespace
-    std::string result;
     bool last_was_space = false;
-    for (char c : cleaned) {
-        if (std::isspace(c)) {
+    for (char c : sentence) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
             if (!last_was_space) {
-                result += ' ';
+                out += ' ';
                 last_was_space = true;
             }
         } else {
-            result += c;
+            out += c;
             last_was_space = false;
         }
     }
-    
-    return result;
 }
 
 } // namespace chunking
@@ -0,0 +1,121 @@
+#include "r3m/chunking/token_management/shared_token_cache.hpp"
+#include "r3m/utils/hash.hpp"
+#include <algorithm>
+
+namespace r3m {
+namespace chunking {
+namespace token_management {
+
+SharedTokenCache::SharedTokenCache(size_t capacity)
+    : shard_capacity_(std::max<size_t>(1, capacity / SHARD_COUNT)) {}
+
+SharedTokenCache& SharedTokenCache::instance() {
+    static SharedTokenCache cache;
+    return cache;
+}
+
+int SharedTokenCache::get_token_count(const Tokenizer& tokenizer, std::string_view text) {
+    const uint64_t tokenizer_key = tokenizer.cache_key();
+    const uint64_t key = utils::wyhash(text, tokenizer_key);
+    Shard& shard = shard_for(key);
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.index.find(key);
+        if (it != shard.index.end()) {
+            Slot& slot = shard.slots[it->second];
+            slot.referenced = true;
+            ++shard.hits;
+            return slot.count;
+        }
+        ++shard.misses;
+    }
+
+    int count = static_cast<int>(tokenizer.count_tokens(text));
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    insert(shard, key, tokenizer_key, count);
+    return count;
+}
+
+void SharedTokenCache::insert(Shard& shard, uint64_t key, uint64_t tokenizer_key, int count) {
+    if (shard.index.count(key) != 0) {
+        return;
+    }
+
+    uint32_t victim;
+    if (shard.slots.size() < shard_capacity_) {
+        victim = static_cast<uint32_t>(shard.slots.size());
+        shard.slots.emplace_back();
+    } else {
+        // Clear reference bits until an entry that was not hit since the
+        // hand's last pass comes up
+        while (shard.slots[shard.hand].referenced) {
+            shard.slots[shard.hand].referenced = false;
+            shard.hand = (shard.hand + 1) % shard.slots.size();
+        }
+        victim = static_cast<uint32_t>(shard.hand);
+        shard.hand = (shard.hand + 1) % shard.slots.size();
+        shard.index.erase(shard.slots[victim].key);
+        ++shard.evictions;
+    }
+
+    shard.slots[victim] = Slot{key, tokenizer_key, count, false};
+    shard.index.emplace(key, victim);
+}
+
+SharedTokenCache::Stats SharedTokenCache::stats() const {
+    Stats stats;
+    stats.capacity = shard_capacity_ * SHARD_COUNT;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        stats.hits += shard.hits;
+        stats.misses += shard.misses;
+        stats.evictions += shard.evictions;
+        stats.entries += shard.index.size();
+    }
+    return stats;
+}
+
+void SharedTokenCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.index.clear();
+        shard.slots.clear();
+        shard.hand = 0;
+        shard.hits = 0;
+        shard.misses = 0;
+        shard.evictions = 0;
+    }
+}
+
+void SharedTokenCache::clear(const Tokenizer& tokenizer) {
+    const uint64_t tokenizer_key = tokenizer.cache_key();
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        
+        // Compact the remaining slots in CLOCK order; the hand moves to the
+        // first remaining slot at or after its position
+        size_t kept = 0;
+        size_t hand = 0;
+        for (size_t i = 0; i < shard.slots.size(); ++i) {
+            if (i == shard.hand) {
+                hand = kept;
+            }
+            const Slot slot = shard.slots[i];
+            if (slot.tokenizer_key == tokenizer_key) {
+                shard.index.erase(slot.key);
+                continue;
+            }
+            shard.slots[kept] = slot;
+            shard.index[slot.key] = static_cast<uint32_t>(kept);
+            ++kept;
+        }
+        shard.slots.resize(kept);
+        shard.hand = hand < kept ? hand : 0;
+    }
+}
+
+} // namespace token_management
+} // namespace chunking
+} // namespace r3m
@@ -13,18 +13,15 @@ int OptimizedTokenCache::get_token_count(std::string_view text) {
         return it->second;
     }
     
-    // Store the string to keep the view valid
-    string_storage_.emplace_back(text);
-    std::string_view stored_view = string_storage_.back();
-    
-    int count = static_cast<int>(tokenizer_->count_tokens(std::string(stored_view)));
-    cache_[stored_view] = count;
+    // Count the caller's text; only the key is copied, into the arena
+    int count = static_cast<int>(tokenizer_->count_tokens(text));
+    cache_.emplace(key_storage_.store(text), count);
     return count;
 }
 
 void OptimizedTokenCache::clear() {
     cache_.clear();
-    string_storage_.clear();
+    key_storage_.reset();
 }
 
 // TokenCache implementation (backward compatibility)
@@ -1,17 +1,49 @@
 #include "r3m/chunking/tokenizer.hpp"
+#include "r3m/chunking/advanced_tokenizer.hpp"
+#include "r3m/utils/simd_utils.hpp"
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <stdexcept>
 
 namespace r3m {
 namespace chunking {
 
+uint64_t Tokenizer::next_cache_key() {
+    static std::atomic<uint64_t> next_key{1};
+    return next_key.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<TokenSpan> Tokenizer::token_spans(std::string_view text) const {
+    auto tokens = tokenize(std::string(text));
+    std::vector<TokenSpan> spans;
+    spans.reserve(tokens.size());
+    
+    size_t cursor = 0;
+    for (const auto& token : tokens) {
+        size_t pos = text.find(token, cursor);
+        if (token.empty() || pos == std::string_view::npos) {
+            spans.push_back({cursor, cursor});
+            continue;
+        }
+        spans.push_back({pos, pos + token.size()});
+        cursor = pos + token.size();
+    }
+    return spans;
+}
+
 BasicTokenizer::BasicTokenizer(size_t max_tokens) 
     : max_tokens_(max_tokens) {
 }
 
 size_t BasicTokenizer::count_tokens(const std::string& text) const {
-    return tokenize(text).size();
+    return count_tokens(std::string_view(text));
+}
+
+size_t BasicTokenizer::count_tokens(std::string_view text) const {
+    // Same count as tokenize().size() without materializing the tokens
+    return std::min(utils::SIMDUtils::count_word_tokens_simd(text), max_tokens_);
 }
 
 std::vector<std::string> BasicTokenizer::encode(const std::string& text) const {
@@ -29,37 +61,47 @@ std::vector<std::string> BasicTokenizer::tokenize(const std::string& text) const
     return tokens;
 }
 
-std::vector<std::string> BasicTokenizer::split_text(const std::string& text) const {
-    std::vector<std::string> tokens;
-    std::string current_token;
+template <typename OnToken>
+void BasicTokenizer::for_each_token(std::string_view text, OnToken&& on_token) const {
+    size_t word_start = std::string_view::npos;
     
     for (size_t i = 0; i < text.length(); ++i) {
         char c = text[i];
         
-        if (std::isspace(c)) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
             // End of current token
-            if (!current_token.empty()) {
-                tokens.push_back(current_token);
-                current_token.clear();
+            if (word_start != std::string_view::npos) {
+                on_token(word_start, i);
+                word_start = std::string_view::npos;
             }
         } else if (is_punctuation(c)) {
             // End current token and add punctuation as separate token
-            if (!current_token.empty()) {
-                tokens.push_back(current_token);
-                current_token.clear();
+            if (word_start != std::string_view::npos) {
+                on_token(word_start, i);
+                word_start = std::string_view::npos;
             }
-            tokens.push_back(std::string(1, c));
-        } else {
-            // Add character to current token
-            current_token += c;
+            on_token(i, i + 1);
+        } else if (word_start == std::string_view::npos) {
+            word_start = i;
         }
     }
     
     // Add final token if exists
-    if (!current_token.empty()) {
-        tokens.push_back(current_token);
+    if (word_start != std::string_view::npos) {
+        on_token(word_start, text.length());
     }
-    
+}
+
+std::vector<TokenSpan> BasicTokenizer::token_spans(std::string_view text) const {
+    std::vector<TokenSpan> spans;
+    spans.reserve(text.size() / 5);
+    for_each_token(text, [&spans](size_t begin, size_t end) { spans.push_back({begin, end}); });
+    return spans;
+}
+
+std::vector<std::string> BasicTokenizer::split_text(const std::string& text) const {
+    std::vector<std::string> tokens;
+    for_each_token(text, [&](size_t begin, size_t end) { tokens.emplace_back(text, begin, end - begin); });
     return tokens;
 }
 
@@ -68,13 +110,62 @@ bool BasicTokenizer::is_punctuation(char c) const {
     return punctuation.find(c) != std::string::npos;
 }
 
-std::unique_ptr<Tokenizer> TokenizerFactory::create(Type type, size_t max_tokens) {
+std::shared_ptr<Tokenizer> TokenizerFactory::create(Type type, size_t max_tokens) {
     switch (type) {
+        case Type::SIMPLE:
+            return std::make_shared<SimpleTokenizer>();
+        case Type::SENTENCE:
+            return std::make_shared<SentenceTokenizer>();
+        case Type::BPE:
+            return std::make_shared<BPETokenizer>();
         case Type::BASIC:
-            return std::make_unique<BasicTokenizer>(max_tokens);
         default:
-            return std::make_unique<BasicTokenizer>(max_tokens);
+            return std::make_shared<BasicTokenizer>(max_tokens);
+    }
+}
+
+TokenizerFactory::Type TokenizerFactory::parse_type(const std::string& name) {
+    if (name == "basic") {
+        return Type::BASIC;
+    } else if (name == "simple") {
+        return Type::SIMPLE;
+    } else if (name == "sentence") {
+        return Type::SENTENCE;
+    } else if (name == "bpe") {
+        return Type::BPE;
     }
+    throw std::invalid_argument("Unknown tokenizer type: " + name);
+}
+
+std::shared_ptr<Tokenizer> TokenizerFactory::create_from_config(const std::unordered_map<std::string, std::string>& config) {
+    auto setting = [&config](const std::string& key) {
+        auto it = config.find("chunking.tokenizer." + key);
+        return it != config.end() ? it->second : std::string();
+    };
+    
+    std::string type_name = setting("type");
+    Type type = type_name.empty() ? Type::BASIC : parse_type(type_name);
+    
+    std::string max_tokens = setting("max_tokens");
+    std::string vocab_file = setting("vocab_file");
+    std::string merges_file = setting("merges_file");
+    
+    if (type == Type::BPE) {
+        // An untrained BPE counts one token per byte, which is never what a
+        // configured BPE model means
+        if (vocab_file.empty() || merges_file.empty()) {
+            throw std::invalid_argument("BPE tokenizer needs both chunking.tokenizer.vocab_file and merges_file");
+        }
+        auto bpe = std::make_shared<BPETokenizer>();
+        bpe->load_vocabulary(vocab_file, merges_file);
+        return bpe;
+    }
+    
+    return create(type, max_tokens.empty() ? 8192 : std::stoul(max_tokens));
+}
+
+std::shared_ptr<Tokenizer> TokenizerFactory::create_from_config(const std::string& type) {
+    return create(parse_type(type));
 }
 
 } // namespace chunking
@@ -9,45 +9,33 @@ namespace core {
 
 ConfigManager::ConfigManager() {
     // Initialize with default values
+    snapshot_.store(ConfigSnapshot::build({}, 0));
 }
 
-ConfigManager::~ConfigManager() = default;
+ConfigManager::~ConfigManager() {
+    stop_watching();
+}
 
 bool ConfigManager::load_config(const std::string& config_path) {
-    config_file_path_ = config_path;
-    
-    // For now, use simple key-value parsing
-    // In real implementation, use yaml-cpp
-    std::ifstream file(config_path);
-    if (!file.is_open()) {
+    std::unordered_map<std::string, std::string> file_values;
+    if (!parse_yaml_file(config_path, file_values)) {
         return false;
     }
     
-    std::string line;
-    while (std::getline(file, line)) {
-        // Skip comments and empty lines
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-        
-        // Simple key-value parsing
-        size_t colon_pos = line.find(':');
-        if (colon_pos != std::string::npos) {
-            std::string key = line.substr(0, colon_pos);
-            std::string value = line.substr(colon_pos + 1);
-            
-            // Trim whitespace
-            key.erase(0, key.find_first_not_of(" \t"));
-            key.erase(key.find_last_not_of(" \t") + 1);
-            value.erase(0, value.find_first_not_of(" \t"));
-            value.erase(value.find_last_not_of(" \t") + 1);
-            
-            if (!key.empty()) {
-                config_values_[key] = value;
-            }
-        }
+    std::error_code ec;
+    auto file_time = std::filesystem::last_write_time(config_path, ec);
+    std::unordered_map<std::string, std::string> defaults;
+    {
+        std::shared_lock<std::shared_mutex> lock(values_mutex_);
+        defaults = defaults_;
+    }
+    if (!merge_values(std::move(defaults), std::move(file_values))) {
+        return false;
     }
     
+    std::unique_lock<std::shared_mutex> lock(values_mutex_);
+    config_file_path_ = config_path;
+    config_file_time_ = ec ? std::filesystem::file_time_type{} : file_time;
     return true;
 }
 
@@ -58,17 +46,100 @@ bool ConfigManager::load_from_environment() {
         if (value) {
             std::string key = env;
             std::transform(key.begin(), key.end(), key.begin(), ::tolower);
-            config_values_[key] = value;
+            set_override(key, value);
         }
     }
     
-    return true;
+    return publish_snapshot();
 }
 
 bool ConfigManager::load_from_map(const std::unordered_map<std::string, std::string>& config_map) {
     // Load configuration from the provided map
     for (const auto& [key, value] : config_map) {
-        config_values_[key] = value;
+        set_override(key, value);
+    }
+    return publish_snapshot();
+}
+
+bool ConfigManager::load_defaults(const std::unordered_map<std::string, std::string>& defaults) {
+    std::unordered_map<std::string, std::string> file_values;
+    {
+        std::shared_lock<std::shared_mutex> lock(values_mutex_);
+        file_values = file_values_;
+    }
+    return merge_values(defaults, std::move(file_values));
+}
+
+bool ConfigManager::reload() {
+    std::string path;
+    {
+        std::shared_lock<std::shared_mutex> lock(values_mutex_);
+        path = config_file_path_;
+    }
+    if (path.empty()) {
+        return false;
+    }
+    return load_config(path);
+}
+
+bool ConfigManager::reload_if_changed() {
+    std::string path;
+    std::filesystem::file_time_type loaded_time;
+    {
+        std::shared_lock<std::shared_mutex> lock(values_mutex_);
+        path = config_file_path_;
+        loaded_time = config_file_time_;
+    }
+    if (path.empty()) {
+        return false;
+    }
+    
+    std::error_code ec;
+    auto file_time = std::filesystem::last_write_time(path, ec);
+    if (ec || file_time == loaded_time) {
+        return false;
+    }
+    return load_config(path);
+}
+
+void ConfigManager::watch(std::chrono::milliseconds interval,
+                          std::function<void(std::shared_ptr<const ConfigSnapshot>)> on_reload) {
+    stop_watching();
+    
+    {
+        std::lock_guard<std::mutex> lock(watcher_mutex_);
+        stop_watcher_ = false;
+    }
+    watcher_ = std::thread([this, interval, on_reload = std::move(on_reload)]() {
+        std::unique_lock<std::mutex> lock(watcher_mutex_);
+        while (!watcher_cv_.wait_for(lock, interval, [this]() { return stop_watcher_; })) {
+            lock.unlock();
+            if (reload_if_changed() && on_reload) {
+                on_reload(snapshot());
+            }
+            lock.lock();
+        }
+    });
+}
+
+void ConfigManager::stop_watching() {
+    {
+        std::lock_guard<std::mutex> lock(watcher_mutex_);
+        stop_watcher_ = true;
+    }
+    watcher_cv_.notify_all();
+    if (watcher_.joinable()) {
+        watcher_.join();
+    }
+}
+
+bool ConfigManager::publish_snapshot() {
+    // Writers are serialized by the exclusive lock; readers of snapshot() never wait
+    std::unique_lock<std::shared_mutex> lock(values_mutex_);
+    try {
+        snapshot_.store(ConfigSnapshot::build(config_values_, ++snapshot_version_));
+    } catch (const std::exception&) {
+        return false;
     }
     return true;
 }
@@ -82,11 +153,13 @@ bool ConfigManager::validate_config() const {
 }
 
 std::string ConfigManager::get_string(const std::string& key, const std::string& default_value) const {
+    std::shared_lock<std::shared_mutex> lock(values_mutex_);
     auto it = config_values_.find(key);
     return (it != config_values_.end()) ? it->second : default_value;
 }
 
 int ConfigManager::get_int(const std::string& key, int default_value) const {
+    std::shared_lock<std::shared_mutex> lock(values_mutex_);
     auto it = config_values_.find(key);
     if (it != config_values_.end()) {
         try {
@@ -99,6 +172,7 @@ int ConfigManager::get_int(const std::string& key, int default_value) const {
 }
 
 double ConfigManager::get_double(const std::string& key, double default_value) const {
+    std::shared_lock<std::shared_mutex> lock(values_mutex_);
     auto it = config_values_.find(key);
     if (it != config_values_.end()) {
         try {
@@ -111,6 +185,7 @@ double ConfigManager::get_double(const std::string& key, double default_value) c
 }
 
 bool ConfigManager::get_bool(const std::string& key, bool default_value) const {
+    std::shared_lock<std::shared_mutex> lock(values_mutex_);
     auto it = config_values_.find(key);
     if (it != config_values_.end()) {
         std::string value = it->second;
@@ -121,6 +196,7 @@ bool ConfigManager::get_bool(const std::string& key, bool default_value) const {
 }
 
 std::vector<std::string> ConfigManager::get_string_array(const std::string& key) const {
+    std::shared_lock<std::shared_mutex> lock(values_mutex_);
     auto it = config_values_.find(key);
     if (it != config_values_.end()) {
         std::vector<std::string> result;
@@ -151,14 +227,16 @@ std::vector<std::string> ConfigManager::get_string_array(const std::string& key)
 }
 
 void ConfigManager::set_value(const std::string& key, const std::string& value) {
-    config_values_[key] = value;
+    set_override(key, value);
 }
 
 bool ConfigManager::has_key(const std::string& key) const {
+    std::shared_lock<std::shared_mutex> lock(values_mutex_);
     return config_values_.find(key) != config_values_.end();
 }
 
 std::vector<std::string> ConfigManager::get_keys() const {
+    std::shared_lock<std::shared_mutex> lock(values_mutex_);
     std::vector<std::string> keys;
     keys.reserve(config_values_.size());
     for (const auto& pair : config_values_) {
@@ -168,6 +246,7 @@ std::vector<std::string> ConfigManager::get_keys() const {
 }
 
 std::string ConfigManager::to_string() const {
+    std::shared_lock<std::shared_mutex> lock(values_mutex_);
     std::stringstream ss;
     ss << "Configuration (" << config_values_.size() << " items):" << std::endl;
     for (const auto& pair : config_values_) {
@@ -177,6 +256,7 @@ std::string ConfigManager::to_string() const {
 }
 
 std::unordered_map<std::string, std::string> ConfigManager::get_all_config() const {
+    std::shared_lock<std::shared_mutex> lock(values_mutex_);
     return config_values_;
 }
 
@@ -233,6 +313,104 @@ ConfigManager::PerformanceConfig ConfigManager::get_performance_config() const {
 
 // Private methods
 
+bool ConfigManager::parse_yaml_file(const std::string& file_path, std::unordered_map<std::string, std::string>& values) {
+    // Block mappings and scalars only: nested keys are joined with '.',
+    // sequences are skipped, and quotes and trailing comments are removed
+    std::ifstream file(file_path);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    std::vector<std::pair<size_t, std::string>> parents; // (indent, key) of open mappings
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        
+        size_t indent = line.find_first_not_of(" \t");
+        // Skip comments, empty lines and sequence items
+        if (indent == std::string::npos || line[indent] == '#' || line[indent] == '-') {
+            continue;
+        }
+        
+        size_t colon_pos = line.find(':', indent);
+        if (colon_pos == std::string::npos) {
+            continue;
+        }
+        
+        std::string key = line.substr(indent, colon_pos - indent);
+        key.erase(key.find_last_not_of(" \t") + 1);
+        std::string value = line.substr(colon_pos + 1);
+        value.erase(0, value.find_first_not_of(" \t"));
+        
+        bool quoted = !value.empty() && (value[0] == '"' || value[0] == '\'');
+        if (quoted) {
+            size_t close = value.find(value[0], 1);
+            value = value.substr(1, close == std::string::npos ? std::string::npos : close - 1);
+        } else {
+            size_t comment = value.find(" #");
+            if (comment != std::string::npos || (!value.empty() && value[0] == '#')) {
+                value.erase(value[0] == '#' ? 0 : comment);
+            }
+            value.erase(value.find_last_not_of(" \t") + 1);
+        }
+        
+        while (!parents.empty() && parents.back().first >= indent) {
+            parents.pop_back();
+        }
+        if (key.empty()) {
+            continue;
+        }
+        
+        std::string full_key;
+        for (const auto& parent : parents) {
+            full_key += parent.second + ".";
+        }
+        full_key += key;
+        
+        if (value.empty() && !quoted) {
+            parents.emplace_back(indent, key);  // Opens a nested mapping
+        } else {
+            values[full_key] = value;
+        }
+    }
+    
+    return true;
+}
+
+bool ConfigManager::merge_values(std::unordered_map<std::string, std::string> defaults,
+                                 std::unordered_map<std::string, std::string> file_values) {
+    std::unique_lock<std::shared_mutex> lock(values_mutex_);
+    std::unordered_map<std::string, std::string> merged = defaults;
+    for (const auto& layer : {&file_values, &overrides_}) {
+        for (const auto& [key, value] : *layer) {
+            merged[key] = value;
+        }
+    }
+    
+    // Values are replaced only if the new set parses
+    std::shared_ptr<const ConfigSnapshot> next;
+    try {
+        next = ConfigSnapshot::build(merged, snapshot_version_ + 1);
+    } catch (const std::exception&) {
+        return false;
+    }
+    
+    defaults_ = std::move(defaults);
+    file_values_ = std::move(file_values);
+    config_values_ = std::move(merged);
+    ++snapshot_version_;
+    snapshot_.store(std::move(next));
+    return true;
+}
+
+void ConfigManager::set_override(const std::string& key, const std::string& value) {
+    std::unique_lock<std::shared_mutex> lock(values_mutex_);
+    overrides_[key] = value;
+    config_values_[key] = value;
+}
+
 bool ConfigManager::validate_server_config() const {
     auto config = get_server_config();
     return config.port > 0 && config.port <= 65535 && !config.host.empty();
@@ -0,0 +1,100 @@
+#include "r3m/core/config_snapshot.hpp"
+#include "r3m/parallel/optimized_thread_pool.hpp"
+
+#include <thread>
+
+namespace r3m {
+namespace core {
+
+namespace {
+
+using ConfigMap = std::unordered_map<std::string, std::string>;
+
+void read_bool(const ConfigMap& values, const std::string& key, bool& out) {
+    auto it = values.find(key);
+    if (it != values.end()) {
+        out = (it->second == "true" || it->second == "1");
+    }
+}
+
+void read_int(const ConfigMap& values, const std::string& key, int& out) {
+    auto it = values.find(key);
+    if (it != values.end()) {
+        out = std::stoi(it->second);
+    }
+}
+
+void read_double(const ConfigMap& values, const std::string& key, double& out) {
+    auto it = values.find(key);
+    if (it != values.end()) {
+        out = std::stod(it->second);
+    }
+}
+
+chunking::AdvancedChunker::Config parse_chunker_config(const ConfigMap& values) {
+    chunking::AdvancedChunker::Config config;
+    read_bool(values, "chunking.enable_multipass", config.enable_multipass);
+    read_bool(values, "chunking.enable_large_chunks", config.enable_large_chunks);
+    read_bool(values, "chunking.enable_contextual_rag", config.enable_contextual_rag);
+    read_bool(values, "chunking.include_metadata", config.include_metadata);
+    read_int(values, "chunking.chunk_token_limit", config.chunk_token_limit);
+    read_int(values, "chunking.chunk_overlap", config.chunk_overlap);
+    read_int(values, "chunking.mini_chunk_size", config.mini_chunk_size);
+    read_int(values, "chunking.blurb_size", config.blurb_size);
+    read_int(values, "chunking.large_chunk_ratio", config.large_chunk_ratio);
+    read_double(values, "chunking.max_metadata_percentage", config.max_metadata_percentage);
+    read_int(values, "chunking.contextual_rag_reserved_tokens", config.contextual_rag_reserved_tokens);
+    return config;
+}
+
+bool same_tokenizer_settings(const ConfigMap& a, const ConfigMap& b) {
+    for (const char* key : {"chunking.tokenizer.type", "chunking.tokenizer.max_tokens",
+                            "chunking.tokenizer.vocab_file", "chunking.tokenizer.merges_file"}) {
+        auto it_a = a.find(key);
+        auto it_b = b.find(key);
+        bool has_a = it_a != a.end();
+        bool has_b = it_b != b.end();
+        if (has_a != has_b || (has_a && it_a->second != it_b->second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+std::shared_ptr<const ConfigSnapshot> ConfigSnapshot::build(ConfigMap values, uint64_t version) {
+    auto snapshot = std::make_shared<ConfigSnapshot>();
+    snapshot->version = version;
+
+    // Batch processing settings with optimal defaults
+    auto it = values.find("document_processing.batch_size");
+    snapshot->batch_size = it != values.end() ? std::stoul(it->second)
+                                              : parallel::OptimizedThreadPool::get_optimal_batch_size();
+
+    it = values.find("document_processing.max_workers");
+    if (it != values.end()) {
+        snapshot->max_workers = std::stoul(it->second);
+    } else {
+        snapshot->max_workers = std::thread::hardware_concurrency();
+        if (snapshot->max_workers == 0) {
+            snapshot->max_workers = 4;
+        }
+    }
+
+    read_bool(values, "document_processing.enable_chunking", snapshot->enable_chunking);
+    read_bool(values, "document_processing.enable_memory_pooling", snapshot->enable_memory_pooling);
+
+    snapshot->quality = quality::QualityAssessor::parse_config(values);
+    snapshot->chunker = parse_chunker_config(values);
+    snapshot->values = std::move(values);
+    return snapshot;
+}
+
+bool ConfigSnapshot::chunking_differs(const ConfigSnapshot& other) const {
+    return enable_chunking != other.enable_chunking || !(chunker == other.chunker) ||
+           !same_tokenizer_settings(values, other.values);
+}
+
+} // namespace core
+} // namespace r3m
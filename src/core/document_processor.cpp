@@ -1,8 +1,10 @@
 #include "r3m/core/document_processor.hpp"
+#include "r3m/utils/mapped_file.hpp"
 
 #include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <iostream>
 #include <algorithm>
 #include <chrono>
 
@@ -12,10 +14,10 @@ namespace core {
 DocumentProcessor::DocumentProcessor() {
     // Initialize modular components
     pipeline_ = std::make_unique<processing::PipelineOrchestrator>();
-    quality_assessor_ = std::make_unique<quality::QualityAssessor>();
     format_processor_ = std::make_unique<formats::FormatProcessor>();
     
     // Initialize default configuration (will be overridden by config)
+    state_.store(std::make_shared<const ProcessingState>(ProcessingState{ConfigSnapshot::build({}), nullptr}));
     batch_size_ = parallel::OptimizedThreadPool::get_optimal_batch_size();
     max_workers_ = std::thread::hardware_concurrency();
     if (max_workers_ == 0) {
@@ -36,170 +38,185 @@ DocumentProcessor::DocumentProcessor() {
 }
 
 bool DocumentProcessor::initialize(const std::unordered_map<std::string, std::string>& config) {
-    config_ = config;
+    return initialize(ConfigSnapshot::build(config));
+}
+
+bool DocumentProcessor::initialize(std::shared_ptr<const ConfigSnapshot> snapshot) {
+    const auto& config = snapshot->values;
     
     // Initialize all modular components
     if (!pipeline_->initialize(config)) {
         return false;
     }
     
-    if (!quality_assessor_->initialize(config)) {
-        return false;
-    }
-    
     if (!format_processor_->initialize(config)) {
         return false;
     }
     
-    // Load batch processing settings with optimal defaults
-    auto it = config_.find("document_processing.batch_size");
-    if (it != config_.end()) {
-        batch_size_ = std::stoul(it->second);
-    } else {
-        // Use optimal batch size based on CPU cores
-        batch_size_ = parallel::OptimizedThreadPool::get_optimal_batch_size();
-    }
-    
-    it = config_.find("document_processing.max_workers");
-    if (it != config_.end()) {
-        max_workers_ = std::stoul(it->second);
-    } else {
-        // Use optimal worker count
-        max_workers_ = std::thread::hardware_concurrency();
-        if (max_workers_ == 0) {
-            max_workers_ = 4;
-        }
-    }
+    // Batch processing settings (optimal defaults are filled in by the snapshot)
+    batch_size_ = snapshot->batch_size;
+    max_workers_ = snapshot->max_workers;
     
-    it = config_.find("document_processing.enable_chunking");
-    if (it != config_.end()) {
-        enable_chunking_ = (it->second == "true" || it->second == "1");
+    // Initialize optimized thread pool with fixed memory management
+    if (auto chunker = state_.load()->chunker) {
+        chunker->set_thread_pool(nullptr);
     }
+    pipeline_->set_thread_pool(nullptr);
+    thread_pool_ = std::make_unique<parallel::OptimizedThreadPool>(max_workers_, snapshot->enable_memory_pooling);
     
-    // Initialize optimized thread pool with fixed memory management
-    thread_pool_ = std::make_unique<parallel::OptimizedThreadPool>(max_workers_);
+    // Large PDFs are extracted page-parallel on the same pool as documents
+    pipeline_->set_thread_pool(thread_pool_.get());
     
     // Initialize chunking components if enabled
-    if (enable_chunking_) {
-        initialize_chunking_components();
+    std::shared_ptr<chunking::AdvancedChunker> chunker;
+    if (snapshot->enable_chunking) {
+        chunker = create_chunker(*snapshot);
+        if (!chunker) {
+            return false;
+        }
     }
+    state_.store(std::make_shared<const ProcessingState>(ProcessingState{std::move(snapshot), std::move(chunker)}));
     
     initialized_ = true;
     return true;
 }
 
-void DocumentProcessor::initialize_chunking_components() {
-    // Create tokenizer
-    tokenizer_ = std::make_shared<chunking::BasicTokenizer>(8192);
+bool DocumentProcessor::apply_config(std::shared_ptr<const ConfigSnapshot> snapshot) {
+    std::lock_guard<std::mutex> lock(reload_mutex_);
+    
+    // Rebuilding the tokenizer can be expensive (BPE vocabularies), so the
+    // chunker is only replaced when its settings changed
+    auto current = state_.load();
+    std::shared_ptr<chunking::AdvancedChunker> chunker = current->chunker;
+    if (current->config->chunking_differs(*snapshot)) {
+        chunker.reset();
+        if (snapshot->enable_chunking) {
+            chunker = create_chunker(*snapshot);
+            if (!chunker) {
+                return false;
+            }
+        }
+    }
     
-    // Create chunker with configuration
-    auto config = create_chunker_config();
-    chunker_ = std::make_unique<chunking::AdvancedChunker>(tokenizer_, config);
+    state_.store(std::make_shared<const ProcessingState>(ProcessingState{std::move(snapshot), std::move(chunker)}));
+    return true;
 }
 
-chunking::AdvancedChunker::Config DocumentProcessor::create_chunker_config() {
-    chunking::AdvancedChunker::Config config;
-    
-    // Load chunking configuration from config map
-    auto it = config_.find("chunking.enable_multipass");
-    if (it != config_.end()) {
-        config.enable_multipass = (it->second == "true" || it->second == "1");
-    }
-    
-    it = config_.find("chunking.enable_large_chunks");
-    if (it != config_.end()) {
-        config.enable_large_chunks = (it->second == "true" || it->second == "1");
-    }
-    
-    it = config_.find("chunking.enable_contextual_rag");
-    if (it != config_.end()) {
-        config.enable_contextual_rag = (it->second == "true" || it->second == "1");
-    }
-    
-    it = config_.find("chunking.include_metadata");
-    if (it != config_.end()) {
-        config.include_metadata = (it->second == "true" || it->second == "1");
-    }
-    
-    it = config_.find("chunking.chunk_token_limit");
-    if (it != config_.end()) {
-        config.chunk_token_limit = std::stoi(it->second);
-    }
-    
-    it = config_.find("chunking.chunk_overlap");
-    if (it != config_.end()) {
-        config.chunk_overlap = std::stoi(it->second);
-    }
-    
-    it = config_.find("chunking.mini_chunk_size");
-    if (it != config_.end()) {
-        config.mini_chunk_size = std::stoi(it->second);
-    }
-    
-    it = config_.find("chunking.blurb_size");
-    if (it != config_.end()) {
-        config.blurb_size = std::stoi(it->second);
-    }
-    
-    it = config_.find("chunking.large_chunk_ratio");
-    if (it != config_.end()) {
-        config.large_chunk_ratio = std::stoi(it->second);
-    }
-    
-    it = config_.find("chunking.max_metadata_percentage");
-    if (it != config_.end()) {
-        config.max_metadata_percentage = std::stod(it->second);
+std::shared_ptr<chunking::AdvancedChunker> DocumentProcessor::create_chunker(const ConfigSnapshot& snapshot) const {
+    // Create the tokenizer named by chunking.tokenizer.* (basic by default)
+    std::shared_ptr<chunking::Tokenizer> tokenizer;
+    try {
+        tokenizer = chunking::TokenizerFactory::create_from_config(snapshot.values);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to create tokenizer: " << e.what() << std::endl;
+        return nullptr;
     }
     
-    it = config_.find("chunking.contextual_rag_reserved_tokens");
-    if (it != config_.end()) {
-        config.contextual_rag_reserved_tokens = std::stoi(it->second);
-    }
+    auto chunker = std::make_shared<chunking::AdvancedChunker>(std::move(tokenizer), snapshot.chunker);
     
-    return config;
+    // Per-chunk work of each document forks onto the same pool as documents
+    chunker->set_thread_pool(thread_pool_.get());
+    return chunker;
 }
 
 chunking::AdvancedChunker::DocumentInfo DocumentProcessor::create_document_info(
     const std::string& file_path, 
-    const std::string& text_content,
-    const std::unordered_map<std::string, std::string>& metadata) {
+    std::string&& text_content,
+    std::unordered_map<std::string, std::string>&& metadata,
+    const std::vector<formats::TextSection>& sections,
+    const chunking::Tokenizer& tokenizer) {
     
     chunking::AdvancedChunker::DocumentInfo doc_info;
     
     // Set basic document information
     doc_info.document_id = utils::TextUtils::get_file_name(file_path);
-    doc_info.title = utils::TextUtils::get_file_name(file_path);
-    doc_info.semantic_identifier = utils::TextUtils::get_file_name(file_path);
+    doc_info.title = doc_info.document_id;
+    doc_info.semantic_identifier = doc_info.document_id;
     doc_info.source_type = "file";
-    doc_info.full_content = text_content;
-    doc_info.metadata = metadata;
+    doc_info.metadata = std::move(metadata);
     
     // Calculate total tokens
-    doc_info.total_tokens = static_cast<int>(tokenizer_->count_tokens(text_content));
+    doc_info.total_tokens = static_cast<int>(tokenizer.count_tokens(text_content));
+    
+    if (!sections.empty()) {
+        // One section per page, block, heading or paragraph linked as
+        // <file>#<anchor>, so each chunk's source_links cite the parts it
+        // spans. Sections are offsets into the text parked in full_content.
+        doc_info.sections.reserve(sections.size());
+        for (size_t i = 0; i < sections.size(); ++i) {
+            size_t begin = std::min(sections[i].offset, text_content.size());
+            size_t end = i + 1 < sections.size() ? std::min(sections[i + 1].offset, text_content.size()) : text_content.size();
+            if (begin >= end) {
+                continue;
+            }
+            chunking::section_processing::DocumentSection section;
+            section.offset = begin;
+            section.length = end - begin;
+            section.link = file_path + "#" + sections[i].anchor;
+            section.token_count = static_cast<int>(
+                tokenizer.count_tokens(std::string_view(text_content).substr(begin, end - begin)));
+            doc_info.sections.push_back(std::move(section));
+        }
+        doc_info.full_content = std::move(text_content);
+        return doc_info;
+    }
     
-    // Create sections from text content
-    // For now, treat the entire content as one section
-    // In a more sophisticated implementation, this would parse the document structure
+    // Formats without structure are a single section. The cleaned text is
+    // moved into the section; full_content stays empty because
+    // total_tokens already carries the document-level token count the chunker needs.
     chunking::section_processing::DocumentSection section;
-    section.content = text_content;
+    section.content = std::move(text_content);
     section.link = file_path;
     section.token_count = doc_info.total_tokens;
     
-    doc_info.sections.push_back(section);
+    doc_info.sections.push_back(std::move(section));
     
     return doc_info;
 }
 
+chunking::ChunkingResult DocumentProcessor::chunk_processed_document(const std::string& file_path, DocumentResult& result,
+                                                                     chunking::AdvancedChunker& chunker) {
+    // Lend the extracted text and metadata to the chunker instead of copying them
+    auto doc_info = create_document_info(file_path, std::move(result.text_content), std::move(result.metadata),
+                                         result.sections, *chunker.get_tokenizer());
+    
+    auto chunking_result = chunker.process_document(doc_info);
+    
+    // Hand the buffers back to the document result
+    result.text_content = result.sections.empty() ? std::move(doc_info.sections.front().content)
+                                                  : std::move(doc_info.full_content);
+    result.metadata = std::move(doc_info.metadata);
+    
+    return chunking_result;
+}
+
+void DocumentProcessor::attach_chunks(const std::string& file_path, DocumentResult& result,
+                                      chunking::AdvancedChunker* chunker) {
+    if (!chunker || !result.processing_success) {
+        return;
+    }
+    
+    auto chunking_result = chunk_processed_document(file_path, result, *chunker);
+    
+    result.chunks = std::move(chunking_result.chunks);
+    result.total_chunks = chunking_result.total_chunks;
+    result.successful_chunks = chunking_result.successful_chunks;
+    result.avg_chunk_quality = chunking_result.avg_quality_score;
+    result.avg_chunk_density = chunking_result.avg_information_density;
+}
+
 chunking::ChunkingResult DocumentProcessor::process_document_with_chunking(const std::string& file_path) {
-    if (!enable_chunking_ || !chunker_) {
+    auto state = state_.load();
+    auto& chunker = state->chunker;
+    if (!chunker) {
         chunking::ChunkingResult result;
         result.failed_chunks = 1;
         result.successful_chunks = 0;
         return result;
     }
     
-    // First, process the document normally to get text content
-    auto doc_result = process_single_document(file_path);
+    // Process the document once to get the cleaned text content
+    auto doc_result = process_single_document(file_path, *state->config);
     
     if (!doc_result.processing_success) {
         chunking::ChunkingResult result;
@@ -208,11 +225,140 @@ chunking::ChunkingResult DocumentProcessor::process_document_with_chunking(const
         return result;
     }
     
-    // Create document info for chunking
-    auto doc_info = create_document_info(file_path, doc_result.text_content, doc_result.metadata);
+    return chunk_processed_document(file_path, doc_result, *chunker);
+}
+
+// Length of the next streaming block starting at pos: about target bytes, cut
+// at a paragraph break, line break or space when one falls in the second half.
+static size_t next_block_length(std::string_view data, size_t pos, size_t target) {
+    size_t remaining = data.size() - pos;
+    if (remaining <= target) {
+        return remaining;
+    }
+    
+    std::string_view window = data.substr(pos, target);
+    size_t cut = window.rfind("\n\n");
+    if (cut != std::string_view::npos && cut >= target / 2) {
+        return cut + 2;
+    }
+    cut = window.rfind('\n');
+    if (cut != std::string_view::npos && cut >= target / 2) {
+        return cut + 1;
+    }
+    cut = window.rfind(' ');
+    if (cut != std::string_view::npos && cut >= target / 2) {
+        return cut + 1;
+    }
+    
+    // No separator: avoid splitting a UTF-8 sequence
+    size_t length = target;
+    while (length > 1 && (static_cast<unsigned char>(data[pos + length]) & 0xC0) == 0x80) {
+        --length;
+    }
+    return length;
+}
+
+DocumentResult DocumentProcessor::process_document_streaming(
+    const std::string& file_path,
+    const chunking::AdvancedChunker::ChunkCallback& on_chunk) {
+    
+    auto state = state_.load();
+    auto& chunker = state->chunker;
+    if (!chunker) {
+        DocumentResult result = begin_result(file_path);
+        result.error_message = "Chunking is not enabled";
+        finish_result(result);
+        return result;
+    }
+    
+    if (format_processor_->detect_file_type(file_path) != formats::FileType::PLAIN_TEXT) {
+        // PDF and HTML are parsed as a whole; replay their chunks through the callback
+        auto result = process_document(file_path, *state);
+        for (auto& chunk : result.chunks) {
+            on_chunk(std::move(chunk));
+        }
+        result.chunks.clear();
+        result.text_content.clear();
+        result.sections.clear();
+        return result;
+    }
+    
+    DocumentResult result = begin_result(file_path);
+    
+    try {
+        // Existence and extension only: the file is mapped, never held whole,
+        // so max_file_size does not apply
+        processing::PipelineStage validation_stage;
+        if (!pipeline_->validate_file(file_path, validation_stage, false)) {
+            result.error_message = validation_stage.error_message;
+            finish_result(result);
+            return result;
+        }
+        
+        processing::PipelineStage metadata_stage;
+        pipeline_->extract_metadata(file_path, metadata_stage, result.metadata);
+        
+        utils::MappedFile file(file_path);
+        std::string_view data = file.view();
+        result.file_size = data.size();
+        
+        chunking::AdvancedChunker::DocumentInfo doc_info;
+        doc_info.document_id = utils::TextUtils::get_file_name(file_path);
+        doc_info.title = doc_info.document_id;
+        doc_info.semantic_identifier = doc_info.document_id;
+        doc_info.source_type = "file";
+        doc_info.metadata = result.metadata;
+        
+        // Blocks of roughly one chunk of text; the chunker combines them with
+        // its usual section logic and never sees more than a few at a time.
+        const size_t block_bytes = std::max<size_t>(4096, static_cast<size_t>(chunker->get_config().chunk_token_limit) * 4);
+        size_t pos = 0;
+        
+        auto next_block = [&](chunking::section_processing::DocumentSection& block) -> bool {
+            while (pos < data.size()) {
+                size_t length = next_block_length(data, pos, block_bytes);
+                std::string text(data.substr(pos, length));
+                pos += length;
+                
+                processing::PipelineStage cleaning_stage;
+                if (!pipeline_->clean_text(text, cleaning_stage)) {
+                    throw std::runtime_error(cleaning_stage.error_message);
+                }
+                if (text.empty()) {
+                    continue;
+                }
+                
+                block.content = std::move(text);
+                block.link = file_path;
+                return true;
+            }
+            return false;
+        };
+        
+        auto chunking_result = chunker->process_document_stream(doc_info, next_block, on_chunk);
+        
+        result.total_chunks = chunking_result.total_chunks;
+        result.successful_chunks = chunking_result.successful_chunks;
+        result.avg_chunk_quality = chunking_result.avg_quality_score;
+        result.avg_chunk_density = chunking_result.avg_information_density;
+        
+        if (chunking_result.failed_chunks > 0) {
+            result.error_message = "Streaming chunking failed";
+        } else {
+            // No whole-document text to assess: report the chunk averages instead
+            result.content_quality_score = chunking_result.avg_quality_score;
+            result.information_density = chunking_result.avg_information_density;
+            result.is_high_quality = chunking_result.high_quality_chunks > 0;
+            result.quality_reason = "Streamed: averaged over chunks";
+            result.processing_success = true;
+        }
+        
+    } catch (const std::exception& e) {
+        result.error_message = "Processing failed: " + std::string(e.what());
+    }
     
-    // Process with chunker
-    return chunker_->process_document(doc_info);
+    finish_result(result);
+    return result;
 }
 
 std::vector<chunking::ChunkingResult> DocumentProcessor::process_documents_with_chunking(const std::vector<std::string>& file_paths) {
@@ -227,29 +373,24 @@ std::vector<chunking::ChunkingResult> DocumentProcessor::process_documents_with_
 }
 
 DocumentResult DocumentProcessor::process_document(const std::string& file_path) {
-    auto result = process_single_document(file_path);
-    
-    // If chunking is enabled, add chunking results
-    if (enable_chunking_ && chunker_ && result.processing_success) {
-        auto chunking_result = process_document_with_chunking(file_path);
-        
-        result.chunks = chunking_result.chunks;
-        result.total_chunks = chunking_result.total_chunks;
-        result.successful_chunks = chunking_result.successful_chunks;
-        result.avg_chunk_quality = chunking_result.avg_quality_score;
-        result.avg_chunk_density = chunking_result.avg_information_density;
-    }
+    return process_document(file_path, *state_.load());
+}
+
+DocumentResult DocumentProcessor::process_document(const std::string& file_path, const ProcessingState& state) {
+    auto result = process_single_document(file_path, *state.config);
     
+    // If chunking is enabled, chunk the text produced by the single extraction pass
+    attach_chunks(file_path, result, state.chunker.get());
     return result;
 }
 
-DocumentResult DocumentProcessor::process_document_from_memory(const std::string& file_name, const std::vector<uint8_t>& file_data) {
-    (void)file_name; // Suppress unused parameter warning
-    (void)file_data; // Suppress unused parameter warning
+DocumentResult DocumentProcessor::process_document_from_memory(const std::string& file_name, std::span<const uint8_t> file_data) {
+    auto state = state_.load();
+    std::string_view data(reinterpret_cast<const char*>(file_data.data()), file_data.size());
+    auto result = process_single_buffer(file_name, data, *state->config);
     
-    DocumentResult result;
-    result.processing_success = false;
-    result.error_message = "Memory processing not implemented yet";
+    // Chunk the extracted text exactly like the file-based path
+    attach_chunks(file_name, result, state->chunker.get());
     return result;
 }
 
@@ -326,12 +467,13 @@ std::vector<DocumentResult> DocumentProcessor::process_documents_with_filtering(
     // Process all documents first
     auto all_results = process_documents_batch(file_paths);
     
-    // Apply filtering
+    // Apply filtering (one configuration for the whole batch)
+    auto state = state_.load();
     std::vector<DocumentResult> filtered_results;
     filtered_results.reserve(all_results.size());
     
     for (const auto& result : all_results) {
-        if (should_filter_document(result)) {
+        if (should_filter_document(result, *state->config)) {
             filtered_results.push_back(result);
         } else {
             // Update filtered statistics
@@ -353,7 +495,20 @@ std::vector<std::string> DocumentProcessor::get_supported_extensions() const {
 
 ProcessingStats DocumentProcessor::get_processing_stats() const {
     std::lock_guard<std::mutex> lock(stats_mutex_);
-    return stats_;
+    ProcessingStats stats = stats_;
+    if (thread_pool_) {
+        stats.total_tasks_processed = thread_pool_->get_tasks_processed();
+        stats.work_steals = thread_pool_->get_work_steals();
+        stats.avg_task_time_ms = thread_pool_->get_average_task_time_ms();
+    }
+    stats.optimal_batch_size = parallel::OptimizedThreadPool::get_optimal_batch_size();
+    
+    auto cache_stats = chunking::token_management::SharedTokenCache::instance().stats();
+    stats.token_cache_hits = cache_stats.hits;
+    stats.token_cache_misses = cache_stats.misses;
+    stats.token_cache_entries = cache_stats.entries;
+    stats.token_cache_hit_rate = cache_stats.hit_rate();
+    return stats;
 }
 
 void DocumentProcessor::reset_stats() {
@@ -367,51 +522,24 @@ size_t DocumentProcessor::get_optimal_batch_size() const {
 
 // Private methods
 
-DocumentResult DocumentProcessor::process_single_document(const std::string& file_path) {
-    DocumentResult result;
-    result.processing_start = std::chrono::steady_clock::now();
-    result.file_name = utils::TextUtils::get_file_name(file_path);
-    result.file_extension = utils::TextUtils::get_file_extension(file_path);
-    result.processing_success = false;
-    
-    // Initialize quality scores
-    result.content_quality_score = 0.0;
-    result.information_density = 0.0;
-    result.is_high_quality = false;
-    result.quality_reason = "";
+DocumentResult DocumentProcessor::process_single_document(const std::string& file_path, const ConfigSnapshot& config) {
+    DocumentResult result = begin_result(file_path);
     
     try {
         // Pipeline orchestration using modular components
         processing::PipelineStage validation_stage;
         if (!pipeline_->validate_file(file_path, validation_stage)) {
             result.error_message = validation_stage.error_message;
-            result.processing_end = std::chrono::steady_clock::now();
-            result.processing_time_ms = std::chrono::duration<double, std::milli>(
-                result.processing_end - result.processing_start).count();
-            update_stats(result);
+            finish_result(result);
             return result;
         }
         
         // Extract text based on file type
         std::string text_content;
         processing::PipelineStage extraction_stage;
-        if (!pipeline_->extract_text(file_path, extraction_stage, text_content)) {
+        if (!pipeline_->extract_text(file_path, extraction_stage, text_content, &result.sections)) {
             result.error_message = extraction_stage.error_message;
-            result.processing_end = std::chrono::steady_clock::now();
-            result.processing_time_ms = std::chrono::duration<double, std::milli>(
-                result.processing_end - result.processing_start).count();
-            update_stats(result);
-            return result;
-        }
-        
-        // Clean text
-        processing::PipelineStage cleaning_stage;
-        if (!pipeline_->clean_text(text_content, cleaning_stage)) {
-            result.error_message = cleaning_stage.error_message;
-            result.processing_end = std::chrono::steady_clock::now();
-            result.processing_time_ms = std::chrono::duration<double, std::milli>(
-                result.processing_end - result.processing_start).count();
-            update_stats(result);
+            finish_result(result);
             return result;
         }
         
@@ -419,27 +547,93 @@ DocumentResult DocumentProcessor::process_single_document(const std::string& fil
         processing::PipelineStage metadata_stage;
         pipeline_->extract_metadata(file_path, metadata_stage, result.metadata);
         
-        // Quality assessment
-        auto quality_metrics = quality_assessor_->assess_quality(text_content);
-        result.content_quality_score = quality_metrics.content_quality_score;
-        result.information_density = quality_metrics.information_density;
-        result.is_high_quality = quality_metrics.is_high_quality;
-        result.quality_reason = quality_metrics.quality_reason;
+        complete_document(result, std::move(text_content), config);
+        
+    } catch (const std::exception& e) {
+        result.error_message = "Processing failed: " + std::string(e.what());
+    }
+    
+    finish_result(result);
+    return result;
+}
+
+DocumentResult DocumentProcessor::process_single_buffer(const std::string& file_name, std::string_view data,
+                                                        const ConfigSnapshot& config) {
+    DocumentResult result = begin_result(file_name);
+    result.file_size = data.size();
+    
+    try {
+        processing::PipelineStage validation_stage;
+        if (!pipeline_->validate_buffer(file_name, data.size(), validation_stage)) {
+            result.error_message = validation_stage.error_message;
+            finish_result(result);
+            return result;
+        }
+        
+        // Extract text straight from the caller's buffer
+        std::string text_content;
+        processing::PipelineStage extraction_stage;
+        if (!pipeline_->extract_text_from_memory(file_name, data, extraction_stage, text_content, &result.sections)) {
+            result.error_message = extraction_stage.error_message;
+            finish_result(result);
+            return result;
+        }
         
-        // Set final text content
-        result.text_content = text_content;
-        result.processing_success = true;
+        processing::PipelineStage metadata_stage;
+        pipeline_->extract_metadata_from_memory(file_name, data.size(), metadata_stage, result.metadata);
+        
+        complete_document(result, std::move(text_content), config);
         
     } catch (const std::exception& e) {
         result.error_message = "Processing failed: " + std::string(e.what());
     }
     
+    finish_result(result);
+    return result;
+}
+
+DocumentResult DocumentProcessor::begin_result(const std::string& file_path) const {
+    DocumentResult result;
+    result.processing_start = std::chrono::steady_clock::now();
+    result.file_name = utils::TextUtils::get_file_name(file_path);
+    result.file_extension = utils::TextUtils::get_file_extension(file_path);
+    result.processing_success = false;
+    
+    // Initialize quality scores
+    result.content_quality_score = 0.0;
+    result.information_density = 0.0;
+    result.is_high_quality = false;
+    result.quality_reason = "";
+    return result;
+}
+
+void DocumentProcessor::complete_document(DocumentResult& result, std::string&& text_content,
+                                          const ConfigSnapshot& config) {
+    // Clean text
+    processing::PipelineStage cleaning_stage;
+    if (!pipeline_->clean_text(text_content, cleaning_stage, &result.sections)) {
+        result.error_message = cleaning_stage.error_message;
+        return;
+    }
+    
+    // Quality assessment
+    auto quality_metrics = quality::QualityAssessor::assess_quality(text_content, config.quality);
+    result.content_quality_score = quality_metrics.content_quality_score;
+    result.information_density = quality_metrics.information_density;
+    result.is_high_quality = quality_metrics.is_high_quality;
+    result.quality_reason = quality_metrics.quality_reason;
+    
+    // Set final text content
+    result.text_content = std::move(text_content);
+    result.processing_success = true;
+}
+
+void DocumentProcessor::finish_result(DocumentResult& result) {
     result.processing_end = std::chrono::steady_clock::now();
     result.processing_time_ms = std::chrono::duration<double, std::milli>(
         result.processing_end - result.processing_start).count();
     
     update_stats(result);
-    return result;
 }
 
 void DocumentProcessor::update_stats(const DocumentResult& result) {
@@ -481,6 +675,10 @@ void DocumentProcessor::update_stats(const DocumentResult& result) {
 }
 
 bool DocumentProcessor::should_filter_document(const DocumentResult& result) const {
+    return should_filter_document(result, *state_.load()->config);
+}
+
+bool DocumentProcessor::should_filter_document(const DocumentResult& result, const ConfigSnapshot& config) const {
     if (!result.processing_success) {
         return false;
     }
@@ -492,7 +690,7 @@ bool DocumentProcessor::should_filter_document(const DocumentResult& result) con
     metrics.information_density = result.information_density;
     metrics.is_high_quality = result.is_high_quality;
     
-    return quality_assessor_->filter_document(metrics);
+    return quality::QualityAssessor::filter_document(metrics, config.quality);
 }
 
 } // namespace core
@@ -16,12 +16,9 @@ bool Library::initialize(const std::string& config_path) {
             return false;
         }
         
-        // Get configuration
-        auto config = config_manager_->get_all_config();
-        
-        // Initialize document processor
+        // Initialize document processor from the parsed snapshot
         processor_ = std::make_unique<DocumentProcessor>();
-        if (!processor_->initialize(config)) {
+        if (!processor_->initialize(config_manager_->snapshot())) {
             std::cerr << "Failed to initialize document processor" << std::endl;
             return false;
         }
@@ -126,8 +123,13 @@ void Library::update_config(const std::unordered_map<std::string, std::string>&
         throw std::runtime_error("R3M Library not initialized");
     }
     
-    // Reinitialize processor with new config
-    processor_->initialize(config);
+    // Swap in the new settings; documents already being processed keep the old ones
+    if (config_manager_) {
+        config_manager_->load_from_map(config);
+        processor_->apply_config(config_manager_->snapshot());
+    } else {
+        processor_->apply_config(ConfigSnapshot::build(config));
+    }
 }
 
 std::unordered_map<std::string, std::string> Library::get_config() const {
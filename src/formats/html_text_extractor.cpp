@@ -0,0 +1,500 @@
+#include "r3m/formats/html_text_extractor.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+namespace r3m {
+namespace formats {
+
+namespace {
+
+enum class ElementKind {
+    Inline,        // Text flows through
+    Block,         // Ends the current block at its start and end tags
+    Cell,          // Table cell: separated from the previous one by a space
+    LineBreak,     // <br>
+    Hidden,        // Raw text that is never rendered (script, style, ...)
+    EscapableRaw,  // Block of raw text with character references (title, textarea)
+    Literal,       // Block of raw text taken as is (xmp)
+    Plaintext      // Everything after it is literal text
+};
+
+ElementKind classify(std::string_view name) {
+    static const std::unordered_map<std::string_view, ElementKind> kinds = [] {
+        std::unordered_map<std::string_view, ElementKind> map;
+        for (const char* block : {"address", "article", "aside", "blockquote", "caption", "center", "dd",
+                                  "details", "dialog", "dir", "div", "dl", "dt", "fieldset", "figcaption",
+                                  "figure", "footer", "form", "h1", "h2", "h3", "h4", "h5", "h6", "header",
+                                  "hgroup", "hr", "legend", "li", "listing", "main", "menu", "nav", "ol", "p",
+                                  "pre", "section", "summary", "table", "tbody", "tfoot", "thead", "tr", "ul"}) {
+            map.emplace(block, ElementKind::Block);
+        }
+        for (const char* hidden : {"script", "style", "noscript", "template", "iframe", "noembed", "noframes"}) {
+            map.emplace(hidden, ElementKind::Hidden);
+        }
+        map.emplace("td", ElementKind::Cell);
+        map.emplace("th", ElementKind::Cell);
+        map.emplace("br", ElementKind::LineBreak);
+        map.emplace("title", ElementKind::EscapableRaw);
+        map.emplace("textarea", ElementKind::EscapableRaw);
+        map.emplace("xmp", ElementKind::Literal);
+        map.emplace("plaintext", ElementKind::Plaintext);
+        return map;
+    }();
+
+    auto it = kinds.find(name);
+    return it != kinds.end() ? it->second : ElementKind::Inline;
+}
+
+// HTML 4 Latin-1 entities for U+00A0 to U+00FF, in code point order
+constexpr const char* LATIN1_ENTITIES[96] = {
+    "nbsp", "iexcl", "cent", "pound", "curren", "yen", "brvbar", "sect",
+    "uml", "copy", "ordf", "laquo", "not", "shy", "reg", "macr",
+    "deg", "plusmn", "sup2", "sup3", "acute", "micro", "para", "middot",
+    "cedil", "sup1", "ordm", "raquo", "frac14", "frac12", "frac34", "iquest",
+    "Agrave", "Aacute", "Acirc", "Atilde", "Auml", "Aring", "AElig", "Ccedil",
+    "Egrave", "Eacute", "Ecirc", "Euml", "Igrave", "Iacute", "Icirc", "Iuml",
+    "ETH", "Ntilde", "Ograve", "Oacute", "Ocirc", "Otilde", "Ouml", "times",
+    "Oslash", "Ugrave", "Uacute", "Ucirc", "Uuml", "Yacute", "THORN", "szlig",
+    "agrave", "aacute", "acirc", "atilde", "auml", "aring", "aelig", "ccedil",
+    "egrave", "eacute", "ecirc", "euml", "igrave", "iacute", "icirc", "iuml",
+    "eth", "ntilde", "ograve", "oacute", "ocirc", "otilde", "ouml", "divide",
+    "oslash", "ugrave", "uacute", "ucirc", "uuml", "yacute", "thorn", "yuml"
+};
+
+struct NamedEntity {
+    const char* name;
+    uint32_t code_point;
+};
+
+// Markup, typography and symbol entities that are common in web pages
+constexpr NamedEntity OTHER_ENTITIES[] = {
+    {"amp", '&'}, {"lt", '<'}, {"gt", '>'}, {"quot", '"'}, {"apos", '\''},
+    {"OElig", 0x152}, {"oelig", 0x153}, {"Scaron", 0x160}, {"scaron", 0x161}, {"Yuml", 0x178},
+    {"fnof", 0x192}, {"circ", 0x2C6}, {"tilde", 0x2DC},
+    {"ensp", 0x2002}, {"emsp", 0x2003}, {"thinsp", 0x2009}, {"zwnj", 0x200C}, {"zwj", 0x200D},
+    {"lrm", 0x200E}, {"rlm", 0x200F}, {"ndash", 0x2013}, {"mdash", 0x2014}, {"lsquo", 0x2018},
+    {"rsquo", 0x2019}, {"sbquo", 0x201A}, {"ldquo", 0x201C}, {"rdquo", 0x201D}, {"bdquo", 0x201E},
+    {"dagger", 0x2020}, {"Dagger", 0x2021}, {"bull", 0x2022}, {"hellip", 0x2026}, {"permil", 0x2030},
+    {"prime", 0x2032}, {"Prime", 0x2033}, {"lsaquo", 0x2039}, {"rsaquo", 0x203A}, {"oline", 0x203E},
+    {"frasl", 0x2044}, {"euro", 0x20AC}, {"trade", 0x2122}, {"larr", 0x2190}, {"uarr", 0x2191},
+    {"rarr", 0x2192}, {"darr", 0x2193}, {"harr", 0x2194}, {"minus", 0x2212}, {"infin", 0x221E},
+    {"ne", 0x2260}, {"le", 0x2264}, {"ge", 0x2265}, {"spades", 0x2660}, {"clubs", 0x2663},
+    {"hearts", 0x2665}, {"diams", 0x2666}
+};
+
+uint32_t lookup_entity(std::string_view name) {
+    static const std::unordered_map<std::string_view, uint32_t> entities = [] {
+        std::unordered_map<std::string_view, uint32_t> map;
+        for (uint32_t i = 0; i < 96; ++i) {
+            map.emplace(LATIN1_ENTITIES[i], 0xA0 + i);
+        }
+        for (const auto& entity : OTHER_ENTITIES) {
+            map.emplace(entity.name, entity.code_point);
+        }
+        return map;
+    }();
+
+    auto it = entities.find(name);
+    return it != entities.end() ? it->second : 0;
+}
+
+void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+bool is_alpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool is_alnum(char c) {
+    return is_alpha(c) || (c >= '0' && c <= '9');
+}
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+char to_lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Whitespace inside tags and between blocks
+bool is_html_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f';
+}
+
+/**
+ * Decode the character reference at text[0] ('&') into its UTF-8 bytes.
+ * Returns the bytes consumed, or 0 when it is not a known reference and the
+ * '&' is literal. Numeric references may omit the ';', named ones may not.
+ */
+size_t decode_reference(std::string_view text, std::string& decoded) {
+    if (text.size() < 3) {
+        return 0;
+    }
+
+    if (text[1] == '#') {
+        const bool hex = text[2] == 'x' || text[2] == 'X';
+        size_t i = hex ? 3 : 2;
+        const size_t digits_start = i;
+        uint32_t cp = 0;
+        for (; i < text.size(); ++i) {
+            int digit = hex ? hex_value(text[i]) : (text[i] >= '0' && text[i] <= '9' ? text[i] - '0' : -1);
+            if (digit < 0) {
+                break;
+            }
+            cp = std::min<uint32_t>(cp * (hex ? 16 : 10) + static_cast<uint32_t>(digit), 0x110000);
+        }
+        if (i == digits_start) {
+            return 0;
+        }
+        if (i < text.size() && text[i] == ';') {
+            ++i;
+        }
+        if (cp == 0 || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF)) {
+            cp = 0xFFFD;
+        }
+        append_utf8(decoded, cp);
+        return i;
+    }
+
+    size_t i = 1;
+    while (i < text.size() && i <= 32 && is_alnum(text[i])) {
+        ++i;
+    }
+    if (i == 1 || i >= text.size() || text[i] != ';') {
+        return 0;
+    }
+    uint32_t cp = lookup_entity(text.substr(1, i - 1));
+    if (cp == 0) {
+        return 0;
+    }
+    append_utf8(decoded, cp);
+    return i + 1;
+}
+
+class Scanner {
+public:
+    Scanner(std::string_view html, std::vector<TextSection>* blocks)
+        : html_(html), blocks_(blocks) {
+        out_.reserve(html.size() / 2);
+        if (blocks_) {
+            blocks_->clear();
+        }
+    }
+
+    std::string run() {
+        const size_t n = html_.size();
+        while (pos_ < n) {
+            const void* lt = std::memchr(html_.data() + pos_, '<', n - pos_);
+            size_t next = lt ? static_cast<size_t>(static_cast<const char*>(lt) - html_.data()) : n;
+            emit_text(html_.substr(pos_, next - pos_));
+            pos_ = next;
+            if (pos_ < n) {
+                markup();
+            }
+        }
+        return std::move(out_);
+    }
+
+private:
+    static constexpr size_t npos = std::string_view::npos;
+
+    std::string_view html_;
+    size_t pos_ = 0;
+    std::string out_;
+    std::vector<TextSection>* blocks_;
+    std::string decoded_;
+
+    bool block_pending_ = true;  // Next visible text starts a new block
+    char separator_ = 0;         // ' ' or '\n' owed before the next text of this block
+    std::string anchor_;         // id of the element that opened the pending block
+
+    void start_block(std::string_view id) {
+        block_pending_ = true;
+        if (!id.empty()) {
+            anchor_ = id;
+        }
+    }
+
+    void end_block() {
+        block_pending_ = true;
+        anchor_.clear();
+    }
+
+    // Append literal text
+    void emit(std::string_view text) {
+        if (block_pending_) {
+            size_t start = 0;
+            while (start < text.size() && is_html_space(text[start])) {
+                ++start;
+            }
+            if (start == text.size()) {
+                return;
+            }
+            text.remove_prefix(start);
+
+            if (!out_.empty()) {
+                out_ += "\n\n";
+            }
+            if (blocks_) {
+                blocks_->push_back({out_.size(), anchor_.empty() ? "block=" + std::to_string(blocks_->size() + 1) : anchor_});
+            }
+            anchor_.clear();
+            block_pending_ = false;
+            separator_ = 0;
+        } else if (separator_ != 0) {
+            out_ += separator_;
+            separator_ = 0;
+        }
+        out_.append(text);
+    }
+
+    // Append text, decoding character references
+    void emit_text(std::string_view text) {
+        while (!text.empty()) {
+            size_t amp = text.find('&');
+            if (amp == npos) {
+                emit(text);
+                return;
+            }
+            emit(text.substr(0, amp));
+            text.remove_prefix(amp);
+
+            decoded_.clear();
+            size_t consumed = decode_reference(text, decoded_);
+            if (consumed == 0) {
+                emit("&");
+                consumed = 1;
+            } else {
+                emit(decoded_);
+            }
+            text.remove_prefix(consumed);
+        }
+    }
+
+    size_t skip_past(char c, size_t from) const {
+        size_t at = html_.find(c, from);
+        return at == npos ? html_.size() : at + 1;
+    }
+
+    // Position of the end tag </name> at or after from (name is lowercase)
+    size_t find_end_tag(std::string_view name, size_t from) const {
+        const size_t n = html_.size();
+        while (from < n) {
+            const void* lt = std::memchr(html_.data() + from, '<', n - from);
+            if (!lt) {
+                return npos;
+            }
+            size_t at = static_cast<size_t>(static_cast<const char*>(lt) - html_.data());
+            size_t end = at + 2 + name.size();
+            if (end <= n && html_[at + 1] == '/') {
+                bool match = true;
+                for (size_t i = 0; i < name.size() && match; ++i) {
+                    match = to_lower(html_[at + 2 + i]) == name[i];
+                }
+                if (match && (end == n || is_html_space(html_[end]) || html_[end] == '/' || html_[end] == '>')) {
+                    return at;
+                }
+            }
+            from = at + 1;
+        }
+        return npos;
+    }
+
+    /**
+     * Skip the attributes of a tag starting at p; returns the position after
+     * its '>' or npos if the document ends inside the tag. Quoted values may
+     * contain '>'. The value of an id attribute is stored in id.
+     */
+    size_t scan_attributes(size_t p, std::string_view* id) const {
+        const size_t n = html_.size();
+        while (p < n) {
+            char c = html_[p];
+            if (c == '>') {
+                return p + 1;
+            }
+            if (is_html_space(c) || c == '/') {
+                ++p;
+                continue;
+            }
+
+            // Attribute name (a leading '=' belongs to it)
+            size_t name_start = p++;
+            while (p < n && !is_html_space(html_[p]) && html_[p] != '/' && html_[p] != '>' && html_[p] != '=') {
+                ++p;
+            }
+            std::string_view attribute = html_.substr(name_start, p - name_start);
+            while (p < n && is_html_space(html_[p])) {
+                ++p;
+            }
+            if (p >= n || html_[p] != '=') {
+                continue;
+            }
+            ++p;
+            while (p < n && is_html_space(html_[p])) {
+                ++p;
+            }
+            if (p >= n) {
+                break;
+            }
+
+            // Value: quoted or up to whitespace / '>'
+            size_t value_start = p;
+            size_t value_end;
+            if (html_[p] == '"' || html_[p] == '\'') {
+                size_t close = html_.find(html_[p], p + 1);
+                if (close == npos) {
+                    return npos;
+                }
+                value_start = p + 1;
+                value_end = close;
+                p = close + 1;
+            } else {
+                while (p < n && !is_html_space(html_[p]) && html_[p] != '>') {
+                    ++p;
+                }
+                value_end = p;
+            }
+
+            if (id && attribute.size() == 2 && to_lower(attribute[0]) == 'i' && to_lower(attribute[1]) == 'd') {
+                *id = html_.substr(value_start, value_end - value_start);
+            }
+        }
+        return npos;
+    }
+
+    // Raw text of an element whose start tag ended at pos_; moves past its end tag
+    std::string_view take_raw_text(std::string_view name) {
+        size_t end = find_end_tag(name, pos_);
+        std::string_view content = html_.substr(pos_, (end == npos ? html_.size() : end) - pos_);
+        pos_ = end == npos ? html_.size() : skip_past('>', end);
+        return content;
+    }
+
+    // Handle the markup at pos_ ('<')
+    void markup() {
+        const size_t n = html_.size();
+        size_t p = pos_ + 1;
+
+        // Comments, doctypes and processing instructions
+        if (p < n && (html_[p] == '!' || html_[p] == '?')) {
+            if (html_.compare(p, 3, "!--") == 0) {
+                size_t end = html_.find("-->", p + 1);
+                pos_ = end == npos ? n : end + 3;
+            } else {
+                pos_ = skip_past('>', p);
+            }
+            return;
+        }
+
+        const bool end_tag = p < n && html_[p] == '/';
+        if (end_tag) {
+            ++p;
+        }
+        if (p >= n || !is_alpha(html_[p])) {
+            if (end_tag) {
+                // "</>" is dropped, any other "</..." is a bogus comment
+                pos_ = skip_past('>', p);
+            } else {
+                // Not a tag: a literal '<'
+                emit("<");
+                ++pos_;
+            }
+            return;
+        }
+
+        // Tag name, lowercased (names longer than any we classify are left empty)
+        char name_buffer[16];
+        size_t name_length = 0;
+        while (p < n && !is_html_space(html_[p]) && html_[p] != '/' && html_[p] != '>') {
+            if (name_length < sizeof(name_buffer)) {
+                name_buffer[name_length] = to_lower(html_[p]);
+            }
+            ++name_length;
+            ++p;
+        }
+        std::string_view name = name_length <= sizeof(name_buffer) ? std::string_view(name_buffer, name_length)
+                                                                     : std::string_view();
+
+        std::string_view id;
+        size_t after = scan_attributes(p, end_tag ? nullptr : &id);
+        if (after == npos) {
+            // The document ends inside the tag: it is dropped
+            pos_ = n;
+            return;
+        }
+        pos_ = after;
+
+        const ElementKind kind = classify(name);
+        if (end_tag) {
+            if (kind == ElementKind::Block) {
+                end_block();
+            }
+            return;
+        }
+
+        switch (kind) {
+            case ElementKind::Block:
+                start_block(id);
+                break;
+            case ElementKind::Cell:
+                separator_ = ' ';
+                break;
+            case ElementKind::LineBreak:
+                separator_ = '\n';
+                break;
+            case ElementKind::Hidden:
+                take_raw_text(name);
+                break;
+            case ElementKind::EscapableRaw: {
+                start_block(id);
+                emit_text(take_raw_text(name));
+                end_block();
+                break;
+            }
+            case ElementKind::Literal: {
+                start_block(id);
+                emit(take_raw_text(name));
+                end_block();
+                break;
+            }
+            case ElementKind::Plaintext:
+                start_block(id);
+                emit(html_.substr(pos_));
+                pos_ = n;
+                break;
+            case ElementKind::Inline:
+                break;
+        }
+    }
+};
+
+} // namespace
+
+std::string HtmlTextExtractor::extract(std::string_view html, std::vector<TextSection>* blocks) {
+    return Scanner(html, blocks).run();
+}
+
+} // namespace formats
+} // namespace r3m
@@ -1,18 +1,19 @@
 #include "r3m/formats/processor.hpp"
+#include "r3m/formats/html_text_extractor.hpp"
+#include "r3m/formats/section_splitter.hpp"
 #include "r3m/utils/text_utils.hpp"
+#include "r3m/utils/mapped_file.hpp"
+#include "r3m/parallel/optimized_thread_pool.hpp"
 
 #include <filesystem>
-#include <fstream>
-#include <sstream>
 #include <algorithm>
+#include <climits>
+#include <functional>
 
 // PDF processing with poppler-cpp
 #include <poppler-document.h>
 #include <poppler-page.h>
 
-// HTML processing with gumbo-parser
-#include <gumbo.h>
-
 namespace r3m {
 namespace formats {
 
@@ -27,6 +28,10 @@ FormatProcessor::FormatProcessor() {
     plain_text_extensions_ = {".txt", ".md", ".mdx", ".conf", ".log", ".json", ".csv", ".tsv", ".xml", ".yml", ".yaml"};
     pdf_extensions_ = {".pdf"};
     html_extensions_ = {".html", ".htm"};
+    
+    // Plain text formats whose structure becomes sections
+    markdown_extensions_ = {".md", ".mdx"};
+    paragraph_extensions_ = {".txt"};
 }
 
 bool FormatProcessor::initialize(const std::unordered_map<std::string, std::string>& config) {
@@ -54,6 +59,10 @@ bool FormatProcessor::initialize(const std::unordered_map<std::string, std::stri
     return true;
 }
 
+void FormatProcessor::set_thread_pool(parallel::OptimizedThreadPool* pool) {
+    thread_pool_ = pool;
+}
+
 FileType FormatProcessor::detect_file_type(const std::string& file_path) const {
     std::string extension = get_file_extension(file_path);
     
@@ -88,116 +97,147 @@ std::vector<std::string> FormatProcessor::get_supported_extensions() const {
     return all_extensions;
 }
 
-std::string FormatProcessor::process_plain_text(const std::string& file_path) {
-    std::ifstream file(file_path);
-    if (!file.is_open()) {
-        throw std::runtime_error("Cannot open file: " + file_path);
-    }
+std::string FormatProcessor::process_plain_text(const std::string& file_path, size_t max_length) {
+    // Copy straight out of the mapped pages, only as much as the caller will keep
+    utils::MappedFile file(file_path);
+    return process_plain_text_from_memory(file.view().substr(0, max_length));
+}
+
+std::string FormatProcessor::process_plain_text_from_memory(std::string_view data) {
+    return std::string(data);
+}
+
+void FormatProcessor::split_sections(const std::string& file_path, std::string_view text,
+                                     std::vector<TextSection>& sections) const {
+    std::string extension = get_file_extension(file_path);
     
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    if (std::find(markdown_extensions_.begin(), markdown_extensions_.end(), extension) != markdown_extensions_.end()) {
+        SectionSplitter::split_markdown(text, sections);
+    } else if (std::find(paragraph_extensions_.begin(), paragraph_extensions_.end(), extension) != paragraph_extensions_.end()) {
+        SectionSplitter::split_paragraphs(text, sections);
+    } else {
+        sections.clear();
+    }
 }
 
-std::string FormatProcessor::process_pdf(const std::string& file_path) {
-    try {
-        // Load PDF document
-        std::unique_ptr<poppler::document> doc(poppler::document::load_from_file(file_path));
-        if (!doc) {
-            throw std::runtime_error("Failed to load PDF document");
-        }
-        
-        std::string text_content;
-        int num_pages = doc->pages();
-        
-        // Extract text from each page
-        for (int i = 0; i < num_pages; ++i) {
-            std::unique_ptr<poppler::page> page(doc->create_page(i));
-            if (page) {
-                std::string page_text = page->text().to_latin1();
-                if (!page_text.empty()) {
-                    text_content += page_text + "\n\n";
-                }
-            }
-        }
-        
-        return text_content;
-        
-    } catch (const std::exception& e) {
-        throw std::runtime_error("PDF processing failed: " + std::string(e.what()));
+namespace {
+
+// Fewest pages handed to one pool task; every task loads its own document
+constexpr size_t MIN_PDF_PAGES_PER_TASK = 8;
+
+const std::string PDF_PAGE_SEPARATOR = "\n\n";
+
+using PdfLoader = std::function<poppler::document*()>;
+
+std::unique_ptr<poppler::document> load_pdf(const PdfLoader& load) {
+    std::unique_ptr<poppler::document> doc(load());
+    if (!doc) {
+        throw std::runtime_error("Failed to load PDF document");
     }
+    return doc;
 }
 
-// Helper function to extract text from HTML nodes
-void extract_text_from_node(GumboNode* node, std::string& text) {
-    if (node->type == GUMBO_NODE_TEXT) {
-        text += node->v.text.text;
-    } else if (node->type == GUMBO_NODE_ELEMENT) {
-        // Skip script and style tags
-        if (node->v.element.tag != GUMBO_TAG_SCRIPT && 
-            node->v.element.tag != GUMBO_TAG_STYLE) {
-            GumboVector* children = &node->v.element.children;
-            for (unsigned int i = 0; i < children->length; ++i) {
-                extract_text_from_node(static_cast<GumboNode*>(children->data[i]), text);
+std::string page_text_utf8(const poppler::document& doc, int index) {
+    std::unique_ptr<poppler::page> page(doc.create_page(index));
+    if (!page) {
+        return std::string();
+    }
+    poppler::byte_array utf8 = page->text().to_utf8();
+    return std::string(utf8.begin(), utf8.end());
+}
+
+/**
+ * Text of every page, each followed by a blank line (empty pages are
+ * skipped). With a pool, page ranges are extracted in parallel: a poppler
+ * document must not be shared between threads, so each range loads its own.
+ * The pages are then copied once into a buffer of the exact size.
+ */
+std::string extract_pdf_text(const PdfLoader& load, parallel::OptimizedThreadPool* pool,
+                             std::vector<TextSection>* sections) {
+    auto doc = load_pdf(load);
+    const size_t num_pages = static_cast<size_t>(std::max(doc->pages(), 0));
+    std::vector<std::string> pages(num_pages);
+    
+    const size_t workers = pool ? pool->get_thread_count() + 1 : 1;
+    const size_t grain = std::max(MIN_PDF_PAGES_PER_TASK, (num_pages + 4 * workers - 1) / (4 * workers));
+    if (pool && num_pages > grain) {
+        doc.reset();
+        pool->parallel_for(num_pages, grain, [&](size_t begin, size_t end) {
+            auto range_doc = load_pdf(load);
+            for (size_t i = begin; i < end; ++i) {
+                pages[i] = page_text_utf8(*range_doc, static_cast<int>(i));
             }
+        });
+    } else {
+        for (size_t i = 0; i < num_pages; ++i) {
+            pages[i] = page_text_utf8(*doc, static_cast<int>(i));
         }
     }
+    
+    size_t total_size = 0;
+    for (const auto& page : pages) {
+        total_size += page.empty() ? 0 : page.size() + PDF_PAGE_SEPARATOR.size();
+    }
+    
+    std::string text_content;
+    text_content.reserve(total_size);
+    if (sections) {
+        sections->clear();
+    }
+    for (size_t i = 0; i < num_pages; ++i) {
+        auto& page = pages[i];
+        if (!page.empty()) {
+            if (sections) {
+                sections->push_back({text_content.size(), "page=" + std::to_string(i + 1)});
+            }
+            text_content += page;
+            text_content += PDF_PAGE_SEPARATOR;
+            std::string().swap(page);
+        }
+    }
+    
+    return text_content;
 }
 
-std::string FormatProcessor::process_html(const std::string& file_path) {
+} // namespace
+
+std::string FormatProcessor::process_pdf(const std::string& file_path, std::vector<TextSection>* sections) {
     try {
-        // Read HTML file
-        std::ifstream file(file_path);
-        if (!file.is_open()) {
-            throw std::runtime_error("Cannot open HTML file: " + file_path);
-        }
-        
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string html_content = buffer.str();
-        
-        // Parse HTML with gumbo
-        GumboOutput* output = gumbo_parse(html_content.c_str());
-        if (!output) {
-            throw std::runtime_error("Failed to parse HTML");
-        }
+        return extract_pdf_text([&file_path]() { return poppler::document::load_from_file(file_path); },
+                                thread_pool_, sections);
         
-        // Extract text from the parsed HTML
-        std::string text_content;
-        extract_text_from_node(output->root, text_content);
-        
-        // Clean up gumbo output
-        gumbo_destroy_output(&kGumboDefaultOptions, output);
-        
-        // If no text was extracted, try a fallback approach
-        if (text_content.empty()) {
-            // Simple fallback: remove HTML tags manually
-            text_content = utils::TextUtils::remove_html_tags(html_content);
+    } catch (const std::exception& e) {
+        throw std::runtime_error("PDF processing failed: " + std::string(e.what()));
+    }
+}
+
+std::string FormatProcessor::process_pdf_from_memory(std::string_view data, std::vector<TextSection>* sections) {
+    try {
+        if (data.size() > static_cast<size_t>(INT_MAX)) {
+            throw std::runtime_error("PDF buffer too large");
         }
         
-        return text_content;
+        // poppler reads the caller's buffer directly; it must outlive the documents
+        return extract_pdf_text([data]() {
+                                    return poppler::document::load_from_raw_data(data.data(), static_cast<int>(data.size()));
+                                },
+                                thread_pool_, sections);
         
     } catch (const std::exception& e) {
-        // Fallback to simple text processing if gumbo fails
-        try {
-            std::ifstream file(file_path);
-            if (!file.is_open()) {
-                throw std::runtime_error("Cannot open HTML file: " + file_path);
-            }
-            
-            std::stringstream buffer;
-            buffer << file.rdbuf();
-            std::string html_content = buffer.str();
-            
-            // Simple HTML tag removal as fallback
-            return utils::TextUtils::remove_html_tags(html_content);
-            
-        } catch (const std::exception& fallback_e) {
-            throw std::runtime_error("HTML processing failed: " + std::string(e.what()) + " (fallback also failed: " + std::string(fallback_e.what()) + ")");
-        }
+        throw std::runtime_error("PDF processing failed: " + std::string(e.what()));
     }
 }
 
+std::string FormatProcessor::process_html(const std::string& file_path, std::vector<TextSection>* sections) {
+    // Scanned straight from the mapped pages
+    utils::MappedFile file(file_path);
+    return process_html_from_memory(file.view(), sections);
+}
+
+std::string FormatProcessor::process_html_from_memory(std::string_view data, std::vector<TextSection>* sections) {
+    return HtmlTextExtractor::extract(data, sections);
+}
+
 std::string FormatProcessor::normalize_whitespace(const std::string& text) {
     return utils::TextUtils::normalize_whitespace(text);
 }
@@ -219,11 +259,5 @@ bool FormatProcessor::is_text_file(const std::string& file_path) const {
     return true; // Simplified for now
 }
 
-void FormatProcessor::extract_text_from_node(void* node, std::string& text) {
-    // This is a placeholder - the actual implementation is in the process_html method
-    (void)node; // Suppress unused parameter warning
-    (void)text; // Suppress unused parameter warning
-}
-
 } // namespace formats
 } // namespace r3m 
\ No newline at end of file
@@ -0,0 +1,230 @@
+#include "r3m/formats/section_splitter.hpp"
+
+#include <cstring>
+#include <string>
+#include <unordered_map>
+
+namespace r3m {
+namespace formats {
+
+namespace {
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool is_blank(std::string_view line) {
+    for (char c : line) {
+        if (!is_space(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && is_space(s.front())) {
+        s.remove_prefix(1);
+    }
+    while (!s.empty() && is_space(s.back())) {
+        s.remove_suffix(1);
+    }
+    return s;
+}
+
+// Calls visit(line, offset) for every line of text, without its '\n'
+template <typename Visit>
+void for_each_line(std::string_view text, Visit&& visit) {
+    size_t pos = 0;
+    while (pos < text.size()) {
+        const void* newline = std::memchr(text.data() + pos, '\n', text.size() - pos);
+        size_t end = newline ? static_cast<size_t>(static_cast<const char*>(newline) - text.data()) : text.size();
+        visit(text.substr(pos, end - pos), pos);
+        pos = end + 1;
+    }
+}
+
+// Markdown block markers may be indented by up to three spaces; returns 4
+// for deeper (indented code) lines
+size_t marker_indent(std::string_view line) {
+    size_t indent = 0;
+    while (indent < line.size() && indent < 4 && line[indent] == ' ') {
+        ++indent;
+    }
+    return indent;
+}
+
+size_t run_length(std::string_view line, size_t from, char c) {
+    size_t end = from;
+    while (end < line.size() && line[end] == c) {
+        ++end;
+    }
+    return end - from;
+}
+
+// "## Title ##" -> "Title"; false if the line is not an ATX heading
+bool atx_heading(std::string_view line, std::string_view& title) {
+    size_t indent = marker_indent(line);
+    size_t level = run_length(line, indent, '#');
+    if (indent > 3 || level == 0 || level > 6) {
+        return false;
+    }
+    size_t after = indent + level;
+    if (after < line.size() && !is_space(line[after])) {
+        return false;
+    }
+
+    std::string_view rest = trim(line.substr(after));
+    size_t last = rest.find_last_not_of('#');
+    if (last == std::string_view::npos) {
+        rest = std::string_view();
+    } else if (last + 1 < rest.size() && is_space(rest[last])) {
+        // Closing sequence of #s
+        rest = trim(rest.substr(0, last));
+    }
+    title = rest;
+    return true;
+}
+
+bool fence_open(std::string_view line, char& fence_char, size_t& fence_length) {
+    size_t indent = marker_indent(line);
+    if (indent > 3 || indent >= line.size() || (line[indent] != '`' && line[indent] != '~')) {
+        return false;
+    }
+    size_t length = run_length(line, indent, line[indent]);
+    if (length < 3) {
+        return false;
+    }
+    // The info string of a backtick fence cannot contain backticks
+    if (line[indent] == '`' && line.find('`', indent + length) != std::string_view::npos) {
+        return false;
+    }
+    fence_char = line[indent];
+    fence_length = length;
+    return true;
+}
+
+bool fence_close(std::string_view line, char fence_char, size_t fence_length) {
+    size_t indent = marker_indent(line);
+    size_t length = run_length(line, indent, fence_char);
+    return indent <= 3 && length >= fence_length && is_blank(line.substr(indent + length));
+}
+
+// "===" or "---" under a paragraph line turns it into a heading
+bool setext_underline(std::string_view line) {
+    size_t indent = marker_indent(line);
+    if (indent > 3 || indent >= line.size() || (line[indent] != '=' && line[indent] != '-')) {
+        return false;
+    }
+    size_t length = run_length(line, indent, line[indent]);
+    return is_blank(line.substr(indent + length));
+}
+
+// GitHub-style heading slug: lowercase, spaces to '-', punctuation dropped
+std::string slugify(std::string_view title) {
+    std::string slug;
+    slug.reserve(title.size());
+    for (char c : title) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (byte >= 0x80 || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || c == '_' || c == '-') {
+            slug += c;
+        } else if (c >= 'A' && c <= 'Z') {
+            slug += static_cast<char>(c - 'A' + 'a');
+        } else if (c == ' ') {
+            slug += '-';
+        }
+    }
+    return slug;
+}
+
+} // namespace
+
+void SectionSplitter::split_markdown(std::string_view text, std::vector<TextSection>& sections) {
+    sections.clear();
+
+    std::unordered_map<std::string, size_t> slug_uses;
+    auto numbered_anchor = [&sections]() {
+        return "section=" + std::to_string(sections.size() + 1);
+    };
+    auto heading_anchor = [&](std::string_view title) {
+        std::string slug = slugify(title);
+        if (slug.empty()) {
+            return numbered_anchor();
+        }
+        size_t uses = slug_uses[slug]++;
+        return uses == 0 ? slug : slug + "-" + std::to_string(uses);
+    };
+
+    bool in_fence = false;
+    char fence_char = 0;
+    size_t fence_length = 0;
+    bool need_section = true;       // Next text line starts a section
+    bool previous_is_text = false;  // Previous line can be a setext heading
+    size_t previous_offset = 0;
+    std::string_view previous_line;
+
+    for_each_line(text, [&](std::string_view line, size_t offset) {
+        if (in_fence) {
+            if (fence_close(line, fence_char, fence_length)) {
+                in_fence = false;
+                need_section = true;
+            }
+            return;
+        }
+
+        if (is_blank(line)) {
+            previous_is_text = false;
+            return;
+        }
+
+        std::string_view title;
+        if (atx_heading(line, title)) {
+            sections.push_back({offset, heading_anchor(title)});
+            need_section = false;
+            previous_is_text = false;
+            return;
+        }
+
+        if (fence_open(line, fence_char, fence_length)) {
+            sections.push_back({offset, numbered_anchor()});
+            in_fence = true;
+            previous_is_text = false;
+            return;
+        }
+
+        if (previous_is_text && setext_underline(line)) {
+            // The heading starts at its text line, which may have opened a section
+            if (!sections.empty() && sections.back().offset == previous_offset) {
+                sections.pop_back();
+            }
+            sections.push_back({previous_offset, heading_anchor(trim(previous_line))});
+            previous_is_text = false;
+            return;
+        }
+
+        if (need_section) {
+            sections.push_back({offset, numbered_anchor()});
+            need_section = false;
+        }
+        previous_is_text = true;
+        previous_offset = offset;
+        previous_line = line;
+    });
+}
+
+void SectionSplitter::split_paragraphs(std::string_view text, std::vector<TextSection>& sections) {
+    sections.clear();
+
+    bool in_paragraph = false;
+    for_each_line(text, [&](std::string_view line, size_t offset) {
+        if (is_blank(line)) {
+            in_paragraph = false;
+        } else if (!in_paragraph) {
+            sections.push_back({offset, "para=" + std::to_string(sections.size() + 1)});
+            in_paragraph = true;
+        }
+    });
+}
+
+} // namespace formats
+} // namespace r3m
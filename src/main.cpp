@@ -73,6 +73,8 @@ int main(int argc, char* argv[]) {
         config["document_processing.enable_neon"] = "true";
         
         // CHUNKING CONFIGURATION - OPTIMIZED!
+        config["chunking.tokenizer.type"] = "basic";
+        config["chunking.tokenizer.max_tokens"] = "8192";
         config["chunking.enable_multipass"] = "true";
         config["chunking.enable_large_chunks"] = "true";
         config["chunking.enable_contextual_rag"] = "true";
@@ -1,7 +1,10 @@
 #include "r3m/parallel/optimized_thread_pool.hpp"
 #include "r3m/core/document_processor.hpp"
+#include "r3m/utils/task_memory.hpp"
 #include <algorithm>
+#include <bit>
 #include <chrono>
+#include <exception>
 #include <iostream>
 
 namespace r3m {
@@ -9,46 +12,90 @@ namespace parallel {
 
 // MemoryPool implementation
 OptimizedThreadPool::MemoryPool::MemoryPool(size_t pool_size) {
-    // Pre-allocate memory blocks
-    size_t block_size = 4096; // 4KB blocks
-    size_t num_blocks = pool_size / block_size;
+    reset_block(pool_size);
+}
+
+void OptimizedThreadPool::MemoryPool::release() {
+    const size_t used = bytes_since_release_;
+    bytes_since_release_ = 0;
+    if (used > block_size_ && block_size_ < MAX_MEMORY_POOL_SIZE) {
+        // The task overflowed into heap blocks: size the block for its
+        // high-water mark
+        reset_block(std::min(block_size_for(used), MAX_MEMORY_POOL_SIZE));
+        return;
+    }
+    if (used != 0) {
+        // Returns overflow blocks to the heap and rewinds to the initial block
+        arena_->release();
+    }
+    if (block_size_ <= MEMORY_POOL_SIZE) {
+        return;
+    }
     
-    blocks_.reserve(num_blocks);
-    for (size_t i = 0; i < num_blocks; ++i) {
-        Block block;
-        block.data = malloc(block_size);
-        if (block.data) {  // Only add block if malloc succeeded
-            block.size = block_size;
-            block.used = false;
-            blocks_.push_back(block);
+    // A grown block only stays as large as the last few tasks needed, so one
+    // big document doesn't pin its memory on the worker
+    recent_peak_ = std::max(recent_peak_, used);
+    if (++releases_since_resize_ == MEMORY_POOL_SHRINK_WINDOW) {
+        size_t wanted = std::max(block_size_for(recent_peak_), MEMORY_POOL_SIZE);
+        if (wanted < block_size_) {
+            reset_block(wanted);
+        } else {
+            releases_since_resize_ = 0;
+            recent_peak_ = 0;
         }
     }
 }
 
-OptimizedThreadPool::MemoryPool::~MemoryPool() {
-    for (auto& block : blocks_) {
-        if (block.data) {
-            free(block.data);
-        }
-    }
+size_t OptimizedThreadPool::MemoryPool::block_size_for(size_t used) {
+    return std::bit_ceil(used + used / 4);
 }
 
-void* OptimizedThreadPool::MemoryPool::allocate(size_t size) {
-    // Use a simple, safe memory allocation strategy
-    // For now, use standard malloc to avoid double-free issues
-    // TODO: Implement proper memory pooling once the core issues are resolved
-    return malloc(size);
+void OptimizedThreadPool::MemoryPool::reset_block(size_t size) {
+    arena_.reset();
+    initial_block_ = std::make_unique_for_overwrite<std::byte[]>(size);
+    block_size_ = size;
+    arena_.emplace(initial_block_.get(), size, std::pmr::new_delete_resource());
+    releases_since_resize_ = 0;
+    recent_peak_ = 0;
 }
 
-void OptimizedThreadPool::MemoryPool::deallocate(void* ptr) {
-    // Use a simple, safe memory deallocation strategy
-    if (ptr) {
-        free(ptr);
-    }
+void* OptimizedThreadPool::MemoryPool::do_allocate(size_t bytes, size_t alignment) {
+    bytes_since_release_ += bytes;
+    return arena_->allocate(bytes, alignment);
 }
 
+void OptimizedThreadPool::MemoryPool::do_deallocate(void*, size_t, size_t) {
+    // Monotonic: memory comes back all at once in release()
+}
+
+bool OptimizedThreadPool::MemoryPool::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+
+namespace {
+
+// Worker identity of the current thread, so submit() from inside a task can
+// push onto the worker's own deque
+struct WorkerContext {
+    const void* pool = nullptr;
+    size_t index = 0;
+};
+
+thread_local WorkerContext current_worker;
+
+uint64_t next_random(uint64_t& state) {
+    // xorshift64*
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+} // namespace
+
 // OptimizedThreadPool implementation
-OptimizedThreadPool::OptimizedThreadPool(size_t num_threads) {
+OptimizedThreadPool::OptimizedThreadPool(size_t num_threads, bool memory_pooling)
+    : memory_pooling_(memory_pooling) {
     if (num_threads == 0) {
         num_threads = std::thread::hardware_concurrency();
         if (num_threads == 0) {
@@ -59,11 +106,12 @@ OptimizedThreadPool::OptimizedThreadPool(size_t num_threads) {
     // Disable library parallelism to avoid conflicts
     disable_library_parallelism();
     
-    // Initialize thread-local data
+    // Initialize per-worker data (deques must exist before any worker starts stealing)
     thread_data_.reserve(num_threads);
     for (size_t i = 0; i < num_threads; ++i) {
-        thread_data_.push_back(std::make_unique<ThreadLocalData>());
+        thread_data_.push_back(std::make_unique<ThreadLocalData>(0x9E3779B97F4A7C15ULL * (i + 1), memory_pooling));
     }
+    sleepers_.reserve(num_threads);
     
     // Start worker threads
     threads_.reserve(num_threads);
@@ -77,12 +125,24 @@ OptimizedThreadPool::~OptimizedThreadPool() {
 }
 
 void OptimizedThreadPool::shutdown() {
+    std::vector<size_t> parked;
     {
-        std::lock_guard<std::mutex> lock(queue_mutex_);
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
         shutdown_ = true;
+        parked.swap(sleepers_);
+        num_sleeping_.store(0);
     }
     
-    condition_.notify_all();
+    // Wake every parked worker; they exit once all queues are drained
+    for (size_t id : parked) {
+        auto& data = *thread_data_[id];
+        num_searching_.fetch_add(1);
+        {
+            std::lock_guard<std::mutex> lock(data.park_mutex);
+            data.notified = true;
+        }
+        data.park_cv.notify_one();
+    }
     
     // Wait for all threads to finish
     for (auto& thread : threads_) {
@@ -117,20 +177,130 @@ std::vector<std::future<core::DocumentResult>> OptimizedThreadPool::submit_batch
     return futures;
 }
 
+void OptimizedThreadPool::parallel_for(size_t count, size_t grain,
+                                       const std::function<void(size_t begin, size_t end)>& body) {
+    if (count == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    const size_t blocks = (count + grain - 1) / grain;
+    if (blocks == 1 || shutdown_.load()) {
+        body(0, count);
+        return;
+    }
+    
+    // Shared with the helper tasks, which may only start after the caller
+    // has returned; they touch body only after claiming a block
+    struct ForkJoin {
+        const std::function<void(size_t, size_t)>* body;
+        size_t count;
+        size_t grain;
+        size_t blocks;
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> finished{0};
+        std::mutex mutex;
+        std::condition_variable done;
+        std::exception_ptr error;
+        
+        void run_blocks() {
+            size_t block;
+            while ((block = next.fetch_add(1)) < blocks) {
+                size_t begin = block * grain;
+                size_t end = std::min(count, begin + grain);
+                try {
+                    (*body)(begin, end);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error) {
+                        error = std::current_exception();
+                    }
+                }
+                if (finished.fetch_add(1) + 1 == blocks) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    done.notify_all();
+                }
+            }
+        }
+    };
+    
+    auto state = std::make_shared<ForkJoin>();
+    state->body = &body;
+    state->count = count;
+    state->grain = grain;
+    state->blocks = blocks;
+    
+    size_t helpers = std::min(blocks - 1, threads_.size());
+    for (size_t i = 0; i < helpers; ++i) {
+        auto helper = [state]() { state->run_blocks(); };
+        try {
+            enqueue(std::make_unique<TaskImpl<decltype(helper)>>(std::move(helper)));
+        } catch (const std::runtime_error&) {
+            break;  // Shut down meanwhile: the caller runs the remaining blocks
+        }
+    }
+    
+    state->run_blocks();
+    
+    // Blocks still running were claimed by active workers, so this wait
+    // never depends on queued work
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&state]() { return state->finished.load() == state->blocks; });
+    }
+    
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
 bool OptimizedThreadPool::is_shutdown() const {
     return shutdown_.load();
 }
 
 size_t OptimizedThreadPool::get_queue_size() const {
-    std::lock_guard<std::mutex> lock(queue_mutex_);
-    return global_queue_.size();
+    size_t size = global_queue_size_.load();
+    for (const auto& data : thread_data_) {
+        size += data->deque.size();
+    }
+    return size;
+}
+
+size_t OptimizedThreadPool::get_tasks_processed() const {
+    size_t total = 0;
+    for (const auto& data : thread_data_) {
+        total += data->tasks_processed.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t OptimizedThreadPool::get_work_steals() const {
+    size_t total = 0;
+    for (const auto& data : thread_data_) {
+        total += data->work_steals.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+double OptimizedThreadPool::get_average_task_time_ms() const {
+    size_t tasks = 0;
+    uint64_t time_ns = 0;
+    for (const auto& data : thread_data_) {
+        tasks += data->tasks_processed.load(std::memory_order_relaxed);
+        time_ns += data->task_time_ns.load(std::memory_order_relaxed);
+    }
+    return tasks > 0 ? static_cast<double>(time_ns) / tasks / 1e6 : 0.0;
 }
 
 void OptimizedThreadPool::set_thread_affinity(size_t thread_id) {
 #ifdef __linux__
+    size_t cpu_count = std::thread::hardware_concurrency();
+    if (cpu_count == 0) {
+        return;
+    }
+    
     cpu_set_t cpuset;
     CPU_ZERO(&cpuset);
-    CPU_SET(thread_id, &cpuset);
+    CPU_SET(thread_id % cpu_count, &cpuset);
     
     pthread_t current_thread = pthread_self();
     int ret = pthread_setaffinity_np(current_thread, sizeof(cpu_set_t), &cpuset);
@@ -143,100 +313,236 @@ void OptimizedThreadPool::set_thread_affinity(size_t thread_id) {
 #endif
 }
 
-std::function<void()> OptimizedThreadPool::steal_task(size_t thread_id) {
-    // Try to steal from other threads' local queues
-    for (size_t i = 0; i < thread_data_.size(); ++i) {
-        if (i != thread_id) {
-            std::lock_guard<std::mutex> lock(thread_data_[i]->local_mutex);
-            if (!thread_data_[i]->local_queue.empty()) {
-                auto task = std::move(thread_data_[i]->local_queue.front());
-                thread_data_[i]->local_queue.pop();
-                work_steals_.fetch_add(1);
-                return task;
-            }
+void OptimizedThreadPool::enqueue(std::unique_ptr<Task> task) {
+    if (current_worker.pool == this) {
+        // Spawned from one of our workers: keep it local, others steal if idle
+        thread_data_[current_worker.index]->deque.push(task.release());
+    } else {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (shutdown_) {
+            throw std::runtime_error("ThreadPool is shutdown");
         }
+        global_queue_.push_back(task.release());
+        global_queue_size_.fetch_add(1);
+    }
+    
+    wake_idle_worker();
+}
+
+void OptimizedThreadPool::wake_idle_worker() {
+    // Pairs with the fence in park(): either we see the parked worker, or it
+    // sees the task we just queued
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    
+    // A searching worker will find the task, and wakes the next worker itself
+    // when it does; waking more now would only add contention
+    if (num_searching_.load() != 0 || num_sleeping_.load() == 0) {
+        return;
+    }
+    size_t expected = 0;
+    if (!num_searching_.compare_exchange_strong(expected, 1)) {
+        return;
+    }
+    
+    size_t id;
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        if (sleepers_.empty()) {
+            num_searching_.fetch_sub(1);
+            return;
+        }
+        id = sleepers_.back();
+        sleepers_.pop_back();
+        num_sleeping_.fetch_sub(1);
+    }
+    
+    auto& data = *thread_data_[id];
+    {
+        std::lock_guard<std::mutex> lock(data.park_mutex);
+        data.notified = true;
+    }
+    data.park_cv.notify_one();
+}
+
+bool OptimizedThreadPool::park(size_t thread_id, bool searching) {
+    auto& data = *thread_data_[thread_id];
+    
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        sleepers_.push_back(thread_id);
+        num_sleeping_.fetch_add(1);
+    }
+    
+    // Stop searching only after registering as parked, so a concurrent
+    // submit sees this worker either searching or parked
+    if (searching) {
+        num_searching_.fetch_sub(1);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    
+    if (has_pending_work() || shutdown_.load()) {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        auto it = std::find(sleepers_.begin(), sleepers_.end(), thread_id);
+        if (it != sleepers_.end()) {
+            sleepers_.erase(it);
+            num_sleeping_.fetch_sub(1);
+            return false;
+        }
+        // Already claimed by a waker: consume its notification below
+    }
+    
+    std::unique_lock<std::mutex> lock(data.park_mutex);
+    data.park_cv.wait(lock, [&data]() { return data.notified; });
+    data.notified = false;
+    return true;
+}
+
+bool OptimizedThreadPool::has_pending_work() const {
+    if (global_queue_size_.load() != 0) {
+        return true;
+    }
+    for (const auto& data : thread_data_) {
+        if (!data->deque.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+OptimizedThreadPool::Task* OptimizedThreadPool::take_injected(size_t thread_id) {
+    if (global_queue_size_.load() == 0) {
+        return nullptr;
     }
     
-    // Try to steal from global queue
     std::lock_guard<std::mutex> lock(queue_mutex_);
-    if (!global_queue_.empty()) {
-        auto task = std::move(global_queue_.front());
-        global_queue_.pop();
-        work_steals_.fetch_add(1);
-        return task;
+    if (global_queue_.empty()) {
+        return nullptr;
+    }
+    
+    // Run the first task; move a fair share of the rest onto our deque so
+    // other workers steal them instead of contending on this mutex
+    Task* task = global_queue_.front();
+    global_queue_.pop_front();
+    size_t share = std::min(MAX_INJECT_BATCH, global_queue_.size() / threads_.size());
+    auto& deque = thread_data_[thread_id]->deque;
+    for (size_t i = 0; i < share; ++i) {
+        deque.push(global_queue_.front());
+        global_queue_.pop_front();
+    }
+    global_queue_size_.fetch_sub(share + 1);
+    return task;
+}
+
+OptimizedThreadPool::Task* OptimizedThreadPool::steal_task(size_t thread_id) {
+    auto& self = *thread_data_[thread_id];
+    size_t count = thread_data_.size();
+    if (count < 2) {
+        return nullptr;
     }
     
+    // Visit the other workers starting from a random victim
+    size_t start = static_cast<size_t>(next_random(self.rng_state) % count);
+    for (size_t i = 0; i < count; ++i) {
+        size_t victim = (start + i) % count;
+        if (victim == thread_id) {
+            continue;
+        }
+        if (Task* task = thread_data_[victim]->deque.steal()) {
+            self.work_steals.fetch_add(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
     return nullptr;
 }
 
+OptimizedThreadPool::Task* OptimizedThreadPool::find_task(size_t thread_id) {
+    if (Task* task = take_injected(thread_id)) {
+        return task;
+    }
+    // A steal can fail on a lost race while work remains, so retry a few rounds
+    for (int round = 0; round < 4; ++round) {
+        if (Task* task = steal_task(thread_id)) {
+            return task;
+        }
+        if (!has_pending_work()) {
+            break;
+        }
+    }
+    return nullptr;
+}
+
+void OptimizedThreadPool::run_task(size_t thread_id, Task* raw_task) {
+    std::unique_ptr<Task> task(raw_task);
+    auto& data = *thread_data_[thread_id];
+    auto start_time = std::chrono::steady_clock::now();
+    
+    try {
+        task->run();
+    } catch (const std::exception& e) {
+        // Log error but don't crash the thread
+        std::cerr << "Task execution error: " << e.what() << std::endl;
+    }
+    
+    // Tasks never nest on a worker, so every temporary of this one is dead
+    task.reset();
+    if (data.memory_pool) {
+        data.memory_pool->release();
+    }
+    
+    auto duration = std::chrono::steady_clock::now() - start_time;
+    data.task_time_ns.fetch_add(
+        static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()),
+        std::memory_order_relaxed);
+    data.tasks_processed.fetch_add(1, std::memory_order_relaxed);
+}
+
 void OptimizedThreadPool::worker_thread(size_t thread_id) {
     // Set thread affinity for better cache locality
     set_thread_affinity(thread_id);
+    current_worker.pool = this;
+    current_worker.index = thread_id;
     
-    auto& local_data = thread_data_[thread_id];
+    auto& local_data = *thread_data_[thread_id];
+    utils::TaskMemoryScope memory_scope(local_data.memory_pool.get());
+    bool searching = false;
     
     while (true) {
-        std::function<void()> task;
-        
-        // First, try to get a task from local queue
-        {
-            std::lock_guard<std::mutex> lock(local_data->local_mutex);
-            if (!local_data->local_queue.empty()) {
-                task = std::move(local_data->local_queue.front());
-                local_data->local_queue.pop();
-            }
-        }
+        // Own deque first (LIFO: most recently spawned, cache-warm work)
+        Task* task = local_data.deque.pop();
         
-        // If local queue is empty, try global queue
         if (!task) {
-            std::unique_lock<std::mutex> lock(queue_mutex_);
-            condition_.wait(lock, [this]() { 
-                return !global_queue_.empty() || shutdown_; 
-            });
-            
-            if (shutdown_ && global_queue_.empty()) {
-                break;
-            }
-            
-            if (!global_queue_.empty()) {
-                task = std::move(global_queue_.front());
-                global_queue_.pop();
+            if (!searching) {
+                searching = true;
+                num_searching_.fetch_add(1);
             }
+            task = find_task(thread_id);
         }
         
-        // If still no task, try work stealing
-        if (!task) {
-            task = steal_task(thread_id);
-        }
-        
-        // Execute the task
         if (task) {
-            auto start_time = std::chrono::high_resolution_clock::now();
-            
-            try {
-                task();
-            } catch (const std::exception& e) {
-                // Log error but don't crash the thread
-                std::cerr << "Task execution error: " << e.what() << std::endl;
+            if (searching) {
+                searching = false;
+                // The last searcher to find work hands the search on, so
+                // wakeups ramp up one worker at a time as work appears
+                if (num_searching_.fetch_sub(1) == 1) {
+                    wake_idle_worker();
+                }
             }
-            
-            auto end_time = std::chrono::high_resolution_clock::now();
-            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-            
-            // Update statistics
-            {
-                std::lock_guard<std::mutex> lock(stats_mutex_);
-                total_tasks_processed_++;
-                
-                // Update average task time (exponential moving average)
-                double new_time_ms = duration.count() / 1000.0;
-                avg_task_time_ms_ = 0.9 * avg_task_time_ms_ + 0.1 * new_time_ms;
+            run_task(thread_id, task);
+            continue;
+        }
+        
+        if (shutdown_.load() && !has_pending_work()) {
+            if (searching) {
+                num_searching_.fetch_sub(1);
             }
-            
-            active_tasks_.fetch_sub(1);
+            break;
         }
+        
+        searching = park(thread_id, searching);
     }
+    
+    current_worker = WorkerContext{};
 }
 
 } // namespace parallel
-} // namespace r3m 
\ No newline at end of file
+} // namespace r3m 
@@ -75,7 +75,11 @@ bool PipelineOrchestrator::initialize(const std::unordered_map<std::string, std:
     return true;
 }
 
-bool PipelineOrchestrator::validate_file(const std::string& file_path, PipelineStage& stage) {
+void PipelineOrchestrator::set_thread_pool(parallel::OptimizedThreadPool* pool) {
+    format_processor_->set_thread_pool(pool);
+}
+
+bool PipelineOrchestrator::validate_file(const std::string& file_path, PipelineStage& stage, bool enforce_size_limit) {
     stage.name = "file_validation";
     stage.start_time = std::chrono::steady_clock::now();
     stage.success = false;
@@ -86,11 +90,13 @@ bool PipelineOrchestrator::validate_file(const std::string& file_path, PipelineS
         return false;
     }
     
-    size_t file_size = std::filesystem::file_size(file_path);
-    if (file_size > max_file_size_) {
-        stage.error_message = "File too large: " + std::to_string(file_size) + " bytes";
-        stage.end_time = std::chrono::steady_clock::now();
-        return false;
+    if (enforce_size_limit) {
+        size_t file_size = std::filesystem::file_size(file_path);
+        if (file_size > max_file_size_) {
+            stage.error_message = "File too large: " + std::to_string(file_size) + " bytes";
+            stage.end_time = std::chrono::steady_clock::now();
+            return false;
+        }
     }
     
     // Check if file type is supported (basic check)
@@ -106,10 +112,14 @@ bool PipelineOrchestrator::validate_file(const std::string& file_path, PipelineS
     return true;
 }
 
-bool PipelineOrchestrator::extract_text(const std::string& file_path, PipelineStage& stage, std::string& text_content) {
+bool PipelineOrchestrator::extract_text(const std::string& file_path, PipelineStage& stage, std::string& text_content,
+                                        std::vector<formats::TextSection>* sections) {
     stage.name = "text_extraction";
     stage.start_time = std::chrono::steady_clock::now();
     stage.success = false;
+    if (sections) {
+        sections->clear();
+    }
     
     try {
         // Use FormatProcessor for proper text extraction based on file type
@@ -117,33 +127,92 @@ bool PipelineOrchestrator::extract_text(const std::string& file_path, PipelineSt
         
         switch (file_type) {
             case formats::FileType::PLAIN_TEXT:
-                text_content = format_processor_->process_plain_text(file_path);
+                text_content = format_processor_->process_plain_text(file_path, max_text_length_);
+                if (sections) {
+                    format_processor_->split_sections(file_path, text_content, *sections);
+                }
                 break;
             case formats::FileType::PDF:
-                text_content = format_processor_->process_pdf(file_path);
+                text_content = format_processor_->process_pdf(file_path, sections);
                 break;
             case formats::FileType::HTML:
-                text_content = format_processor_->process_html(file_path);
+                text_content = format_processor_->process_html(file_path, sections);
                 break;
             default:
                 // Fallback to plain text processing
-                text_content = format_processor_->process_plain_text(file_path);
+                text_content = format_processor_->process_plain_text(file_path, max_text_length_);
                 break;
         }
         
-        if (text_content.empty()) {
-            stage.error_message = "Text extraction returned empty content for: " + file_path;
-            stage.end_time = std::chrono::steady_clock::now();
-            return false;
-        }
+        return finish_extraction(file_path, stage, text_content);
         
-        if (text_content.length() > max_text_length_) {
-            text_content = text_content.substr(0, max_text_length_);
+    } catch (const std::exception& e) {
+        stage.error_message = "Text extraction failed: " + std::string(e.what());
+        stage.end_time = std::chrono::steady_clock::now();
+        return false;
+    }
+}
+
+bool PipelineOrchestrator::validate_buffer(const std::string& file_name, size_t data_size, PipelineStage& stage) {
+    stage.name = "buffer_validation";
+    stage.start_time = std::chrono::steady_clock::now();
+    stage.success = false;
+    
+    if (data_size == 0) {
+        stage.error_message = "Empty buffer: " + file_name;
+        stage.end_time = std::chrono::steady_clock::now();
+        return false;
+    }
+    
+    if (data_size > max_file_size_) {
+        stage.error_message = "File too large: " + std::to_string(data_size) + " bytes";
+        stage.end_time = std::chrono::steady_clock::now();
+        return false;
+    }
+    
+    // Check if file type is supported (basic check)
+    std::string extension = utils::TextUtils::get_file_extension(file_name);
+    if (extension.empty()) {
+        stage.error_message = "No file extension found";
+        stage.end_time = std::chrono::steady_clock::now();
+        return false;
+    }
+    
+    stage.success = true;
+    stage.end_time = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool PipelineOrchestrator::extract_text_from_memory(const std::string& file_name, std::string_view data, PipelineStage& stage, std::string& text_content,
+                                                    std::vector<formats::TextSection>* sections) {
+    stage.name = "text_extraction";
+    stage.start_time = std::chrono::steady_clock::now();
+    stage.success = false;
+    if (sections) {
+        sections->clear();
+    }
+    
+    try {
+        // Same dispatch as extract_text, reading from the caller's buffer
+        auto file_type = format_processor_->detect_file_type(file_name);
+        
+        switch (file_type) {
+            case formats::FileType::PDF:
+                text_content = format_processor_->process_pdf_from_memory(data, sections);
+                break;
+            case formats::FileType::HTML:
+                text_content = format_processor_->process_html_from_memory(data, sections);
+                break;
+            case formats::FileType::PLAIN_TEXT:
+            default:
+                text_content = format_processor_->process_plain_text_from_memory(data.substr(0, max_text_length_));
+                if (sections) {
+                    format_processor_->split_sections(file_name, text_content, *sections);
+                }
+                break;
         }
         
-        stage.success = true;
-        stage.end_time = std::chrono::steady_clock::now();
-        return true;
+        return finish_extraction(file_name, stage, text_content);
         
     } catch (const std::exception& e) {
         stage.error_message = "Text extraction failed: " + std::string(e.what());
@@ -152,25 +221,43 @@ bool PipelineOrchestrator::extract_text(const std::string& file_path, PipelineSt
     }
 }
 
-bool PipelineOrchestrator::clean_text(std::string& text_content, PipelineStage& stage) {
+bool PipelineOrchestrator::finish_extraction(const std::string& source, PipelineStage& stage, std::string& text_content) {
+    if (text_content.empty()) {
+        stage.error_message = "Text extraction returned empty content for: " + source;
+        stage.end_time = std::chrono::steady_clock::now();
+        return false;
+    }
+    
+    if (text_content.length() > max_text_length_) {
+        text_content.resize(max_text_length_);
+    }
+    
+    stage.success = true;
+    stage.end_time = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool PipelineOrchestrator::clean_text(std::string& text_content, PipelineStage& stage, std::vector<formats::TextSection>* sections) {
     stage.name = "text_cleaning";
     stage.start_time = std::chrono::steady_clock::now();
     stage.success = false;
     
     try {
-        // Remove HTML tags if enabled
-        if (remove_html_tags_) {
-            text_content = utils::TextUtils::remove_html_tags(text_content);
+        // Strip HTML tags and collapse whitespace (if enabled) and remove control
+        // characters in a single pass
+        std::vector<size_t> offsets;
+        if (sections) {
+            offsets.reserve(sections->size());
+            for (const auto& section : *sections) {
+                offsets.push_back(section.offset);
+            }
         }
-        
-        // Normalize whitespace if enabled
-        if (normalize_whitespace_) {
-            text_content = utils::TextUtils::normalize_whitespace(text_content);
+        text_content = utils::TextUtils::clean_document_text(text_content, remove_html_tags_, normalize_whitespace_,
+                                                             sections ? &offsets : nullptr);
+        for (size_t i = 0; i < offsets.size(); ++i) {
+            (*sections)[i].offset = offsets[i];
         }
         
-        // Clean text content
-        text_content = utils::TextUtils::clean_text_content(text_content);
-        
         stage.success = true;
         stage.end_time = std::chrono::steady_clock::now();
         return true;
@@ -205,6 +292,28 @@ bool PipelineOrchestrator::extract_metadata(const std::string& file_path, Pipeli
     }
 }
 
+bool PipelineOrchestrator::extract_metadata_from_memory(const std::string& file_name, size_t data_size, PipelineStage& stage, std::unordered_map<std::string, std::string>& metadata) {
+    stage.name = "metadata_extraction";
+    stage.start_time = std::chrono::steady_clock::now();
+    stage.success = false;
+    
+    try {
+        // Buffers have no directory; size comes from the buffer itself
+        metadata["file_name"] = utils::TextUtils::get_file_name(file_name);
+        metadata["file_extension"] = utils::TextUtils::get_file_extension(file_name);
+        metadata["file_size"] = std::to_string(data_size);
+        
+        stage.success = true;
+        stage.end_time = std::chrono::steady_clock::now();
+        return true;
+        
+    } catch (const std::exception& e) {
+        stage.error_message = "Metadata extraction failed: " + std::string(e.what());
+        stage.end_time = std::chrono::steady_clock::now();
+        return false;
+    }
+}
+
 PipelineMetrics PipelineOrchestrator::get_metrics() const {
     std::lock_guard<std::mutex> lock(metrics_mutex_);
     return metrics_;
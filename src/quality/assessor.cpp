@@ -1,96 +1,208 @@
 #include "r3m/quality/assessor.hpp"
-#include "r3m/utils/text_utils.hpp"
+#include "r3m/utils/hash.hpp"
+#include "r3m/utils/hyperloglog.hpp"
+#include "r3m/utils/task_memory.hpp"
 
-#include <sstream>
 #include <algorithm>
-#include <set>
+#include <cctype>
 #include <cmath>
+#include <memory_resource>
+#include <stdexcept>
+#include <unordered_set>
 
 namespace r3m {
 namespace quality {
 
-QualityAssessor::QualityAssessor() {
-    // Default configuration is set in the header
-}
+namespace {
 
-bool QualityAssessor::initialize(const std::unordered_map<std::string, std::string>& config) {
-    config_map_ = config;
-    
-    // Load quality filtering configuration
-    auto it = config_map_.find("document_processing.quality_filtering.enabled");
-    if (it != config_map_.end()) {
-        config_.enabled = (it->second == "true");
-    }
-    
-    it = config_map_.find("document_processing.quality_filtering.min_content_quality_score");
-    if (it != config_map_.end()) {
-        config_.min_content_quality_score = std::stod(it->second);
+using ConfigMap = std::unordered_map<std::string, std::string>;
+
+const std::string PREFIX = "document_processing.quality_filtering.";
+
+void read_bool(const ConfigMap& config, const std::string& key, bool& out) {
+    auto it = config.find(PREFIX + key);
+    if (it != config.end()) {
+        out = (it->second == "true");
     }
-    
-    it = config_map_.find("document_processing.quality_filtering.min_information_density");
-    if (it != config_map_.end()) {
-        config_.min_information_density = std::stod(it->second);
+}
+
+void read_double(const ConfigMap& config, const std::string& key, double& out) {
+    auto it = config.find(PREFIX + key);
+    if (it != config.end()) {
+        out = std::stod(it->second);
     }
-    
-    it = config_map_.find("document_processing.quality_filtering.min_content_length");
-    if (it != config_map_.end()) {
-        config_.min_content_length = std::stoul(it->second);
+}
+
+void read_size(const ConfigMap& config, const std::string& key, size_t& out) {
+    auto it = config.find(PREFIX + key);
+    if (it != config.end()) {
+        out = std::stoul(it->second);
     }
-    
-    it = config_map_.find("document_processing.quality_filtering.max_content_length");
-    if (it != config_map_.end()) {
-        config_.max_content_length = std::stoul(it->second);
+}
+
+void read_unique_word_counting(const ConfigMap& config, UniqueWordCounting& out) {
+    auto it = config.find(PREFIX + "unique_words.mode");
+    if (it != config.end()) {
+        if (it->second == "auto") {
+            out.mode = UniqueWordCounting::Mode::AUTO;
+        } else if (it->second == "exact") {
+            out.mode = UniqueWordCounting::Mode::EXACT;
+        } else if (it->second == "approximate") {
+            out.mode = UniqueWordCounting::Mode::APPROXIMATE;
+        } else {
+            throw std::invalid_argument("Unknown unique word counting mode: " + it->second);
+        }
     }
-    
-    it = config_map_.find("document_processing.quality_filtering.filter_empty_documents");
-    if (it != config_map_.end()) {
-        config_.filter_empty_documents = (it->second == "true");
+    read_size(config, "unique_words.approximate_threshold", out.approximate_threshold);
+    read_double(config, "unique_words.approximate_error", out.approximate_error);
+    if (!(out.approximate_error > 0.0 && out.approximate_error < 1.0)) {
+        throw std::invalid_argument("unique_words.approximate_error must be in (0, 1)");
     }
-    
-    it = config_map_.find("document_processing.quality_filtering.filter_low_quality_documents");
-    if (it != config_map_.end()) {
-        config_.filter_low_quality_documents = (it->second == "true");
+}
+
+// Splits text on whitespace like std::istringstream, counts sentence marks
+// and technical terms, and hands each word with its non-alphanumeric ends
+// trimmed (TextUtils::clean_word) to on_word
+template <typename OnWord>
+void scan_words(std::string_view text, TextCounts& counts, OnWord&& on_word) {
+    auto is_space = [](char c) { return std::isspace(static_cast<unsigned char>(c)) != 0; };
+    auto is_alnum = [](char c) { return std::isalnum(static_cast<unsigned char>(c)) != 0; };
+    
+    size_t pos = 0;
+    const size_t n = text.size();
+    while (pos < n) {
+        while (pos < n && is_space(text[pos])) {
+            ++pos;
+        }
+        if (pos == n) {
+            break;
+        }
+        
+        size_t first_alnum = std::string_view::npos;
+        size_t last_alnum = 0;
+        bool technical = false;
+        for (; pos < n && !is_space(text[pos]); ++pos) {
+            char c = text[pos];
+            if (is_alnum(c)) {
+                if (first_alnum == std::string_view::npos) {
+                    first_alnum = pos;
+                }
+                last_alnum = pos;
+                technical = technical || std::isdigit(static_cast<unsigned char>(c));
+            } else {
+                if (c == '.' || c == '!' || c == '?') {
+                    ++counts.sentence_count;
+                }
+                technical = technical || c == '_' || c == '-' || c == '.' || c == '#' || c == '@';
+            }
+        }
+        
+        if (technical) {
+            ++counts.technical_terms;
+        }
+        if (first_alnum != std::string_view::npos) {
+            on_word(text.substr(first_alnum, last_alnum - first_alnum + 1));
+        }
     }
-    
+}
+
+} // namespace
+
+QualityAssessor::QualityAssessor() {
+    // Default configuration is set in the header
+}
+
+bool QualityAssessor::initialize(const std::unordered_map<std::string, std::string>& config) {
+    config_ = parse_config(config);
     return true;
 }
 
+QualityConfig QualityAssessor::parse_config(const std::unordered_map<std::string, std::string>& config) {
+    QualityConfig parsed;
+    
+    // Load quality filtering configuration
+    read_bool(config, "enabled", parsed.enabled);
+    read_double(config, "min_content_quality_score", parsed.min_content_quality_score);
+    read_double(config, "min_information_density", parsed.min_information_density);
+    read_size(config, "min_content_length", parsed.min_content_length);
+    read_size(config, "max_content_length", parsed.max_content_length);
+    read_bool(config, "filter_empty_documents", parsed.filter_empty_documents);
+    read_bool(config, "filter_low_quality_documents", parsed.filter_low_quality_documents);
+    
+    // Scoring weights
+    QualityWeights& weights = parsed.quality_weights;
+    read_double(config, "quality_weights.length_factor", weights.length_factor);
+    read_double(config, "quality_weights.word_diversity_factor", weights.word_diversity_factor);
+    read_double(config, "quality_weights.sentence_structure_factor", weights.sentence_structure_factor);
+    read_double(config, "quality_weights.information_density_factor", weights.information_density_factor);
+    
+    DensityWeights& density = parsed.density_weights;
+    read_double(config, "density_weights.unique_word_ratio", density.unique_word_ratio);
+    read_double(config, "density_weights.technical_term_density", density.technical_term_density);
+    read_double(config, "density_weights.sentence_complexity", density.sentence_complexity);
+    
+    // Normalization thresholds
+    QualityThresholds& thresholds = parsed.thresholds;
+    read_double(config, "quality_thresholds.length_normalization", thresholds.length_normalization);
+    read_double(config, "quality_thresholds.word_diversity_normalization", thresholds.word_diversity_normalization);
+    read_double(config, "quality_thresholds.sentence_normalization", thresholds.sentence_normalization);
+    read_double(config, "quality_thresholds.technical_term_normalization", thresholds.technical_term_normalization);
+    read_double(config, "quality_thresholds.sentence_complexity_normalization",
+                thresholds.sentence_complexity_normalization);
+    
+    // Distinct word counting
+    read_unique_word_counting(config, parsed.unique_words);
+    
+    return parsed;
+}
+
 QualityMetrics QualityAssessor::assess_quality(const std::string& text_content) {
+    return assess_quality(text_content, config_);
+}
+
+QualityMetrics QualityAssessor::assess_quality(std::string_view text_content, const QualityConfig& config) {
     QualityMetrics metrics;
     
-    metrics.text_length = text_content.length();
-    metrics.unique_words = count_unique_words(text_content);
-    metrics.sentence_count = count_sentences(text_content);
-    metrics.technical_terms = count_technical_terms(text_content);
+    // One pass over the document feeds every score below
+    TextCounts counts = count_text(text_content, config.unique_words);
+    metrics.text_length = counts.text_length;
+    metrics.unique_words = counts.unique_words;
+    metrics.sentence_count = counts.sentence_count;
+    metrics.technical_terms = counts.technical_terms;
+    metrics.unique_words_estimated = counts.unique_words_estimated;
     
     // Calculate quality scores
-    metrics.content_quality_score = calculate_content_quality_score(text_content);
-    metrics.information_density = calculate_information_density(text_content);
-    metrics.is_high_quality = is_high_quality_content(metrics);
-    metrics.quality_reason = determine_quality_reason(metrics);
+    metrics.content_quality_score = content_quality_score(counts, config);
+    metrics.information_density = information_density(counts, config);
+    metrics.is_high_quality = is_high_quality_content(metrics, config);
+    metrics.quality_reason = determine_quality_reason(metrics, config);
     
     return metrics;
 }
 
 bool QualityAssessor::filter_document(const QualityMetrics& metrics) const {
-    if (!config_.enabled) {
+    return filter_document(metrics, config_);
+}
+
+bool QualityAssessor::filter_document(const QualityMetrics& metrics, const QualityConfig& config) {
+    if (!config.enabled) {
         return true; // No filtering
     }
     
     // Check if document should be filtered out
-    if (config_.filter_empty_documents && metrics.text_length == 0) {
+    if (config.filter_empty_documents && metrics.text_length == 0) {
         return false;
     }
     
-    if (metrics.text_length < config_.min_content_length) {
+    if (metrics.text_length < config.min_content_length) {
         return false;
     }
     
-    if (metrics.text_length > config_.max_content_length) {
+    if (metrics.text_length > config.max_content_length) {
         return false;
     }
     
-    if (config_.filter_low_quality_documents && !metrics.is_high_quality) {
+    if (config.filter_low_quality_documents && !metrics.is_high_quality) {
         return false;
     }
     
@@ -98,176 +210,120 @@ bool QualityAssessor::filter_document(const QualityMetrics& metrics) const {
 }
 
 bool QualityAssessor::is_high_quality_content(const QualityMetrics& metrics) const {
-    return metrics.content_quality_score >= config_.min_content_quality_score &&
-           metrics.information_density >= config_.min_information_density &&
-           metrics.text_length >= config_.min_content_length &&
-           metrics.text_length <= config_.max_content_length;
+    return is_high_quality_content(metrics, config_);
+}
+
+bool QualityAssessor::is_high_quality_content(const QualityMetrics& metrics, const QualityConfig& config) {
+    return metrics.content_quality_score >= config.min_content_quality_score &&
+           metrics.information_density >= config.min_information_density &&
+           metrics.text_length >= config.min_content_length &&
+           metrics.text_length <= config.max_content_length;
 }
 
 double QualityAssessor::calculate_content_quality_score(const std::string& text) {
-    if (text.empty()) {
+    return content_quality_score(count_text(text, config_.unique_words), config_);
+}
+
+double QualityAssessor::calculate_information_density(const std::string& text) {
+    return information_density(count_text(text, config_.unique_words), config_);
+}
+
+TextCounts QualityAssessor::count_text(std::string_view text, const UniqueWordCounting& counting) {
+    TextCounts counts;
+    counts.text_length = text.size();
+    
+    const bool approximate = counting.mode == UniqueWordCounting::Mode::APPROXIMATE ||
+                             (counting.mode == UniqueWordCounting::Mode::AUTO &&
+                              text.size() >= counting.approximate_threshold);
+    if (approximate) {
+        // Fixed-size sketch of word hashes: memory does not grow with the vocabulary
+        utils::HyperLogLog sketch(counting.approximate_error);
+        scan_words(text, counts, [&sketch](std::string_view word) { sketch.add_hash(utils::wyhash(word)); });
+        counts.unique_words = sketch.estimate();
+        counts.unique_words_estimated = true;
+        return counts;
+    }
+    
+    // Words are views into text, so no word is copied; the set's nodes are
+    // task temporaries
+    std::pmr::unordered_set<std::string_view, utils::WyHash> unique_words(utils::task_memory_resource());
+    unique_words.reserve(text.size() / 32);
+    scan_words(text, counts, [&unique_words](std::string_view word) { unique_words.insert(word); });
+    counts.unique_words = unique_words.size();
+    return counts;
+}
+
+double QualityAssessor::content_quality_score(const TextCounts& counts, const QualityConfig& config) {
+    if (counts.text_length == 0) {
         return 0.0;
     }
     
     // Simple quality scoring based on content characteristics
+    const QualityWeights& weights = config.quality_weights;
+    const QualityThresholds& thresholds = config.thresholds;
+    const double length = static_cast<double>(counts.text_length);
     double score = 0.0;
     
-    // Get weights from config (with defaults)
-    double length_weight = 0.3;
-    double word_diversity_weight = 0.3;
-    double sentence_structure_weight = 0.2;
-    double info_density_weight = 0.2;
-    
-    auto it = config_map_.find("document_processing.quality_filtering.quality_weights.length_factor");
-    if (it != config_map_.end()) {
-        length_weight = std::stod(it->second);
-    }
-    
-    it = config_map_.find("document_processing.quality_filtering.quality_weights.word_diversity_factor");
-    if (it != config_map_.end()) {
-        word_diversity_weight = std::stod(it->second);
-    }
-    
-    it = config_map_.find("document_processing.quality_filtering.quality_weights.sentence_structure_factor");
-    if (it != config_map_.end()) {
-        sentence_structure_weight = std::stod(it->second);
-    }
-    
-    it = config_map_.find("document_processing.quality_filtering.quality_weights.information_density_factor");
-    if (it != config_map_.end()) {
-        info_density_weight = std::stod(it->second);
-    }
-    
-    // Get thresholds from config (with defaults)
-    double length_normalization = 1000.0;
-    double word_diversity_normalization = 5.0;
-    double sentence_normalization = 10.0;
-    
-    it = config_map_.find("document_processing.quality_filtering.quality_thresholds.length_normalization");
-    if (it != config_map_.end()) {
-        length_normalization = std::stod(it->second);
-    }
-    
-    it = config_map_.find("document_processing.quality_filtering.quality_thresholds.word_diversity_normalization");
-    if (it != config_map_.end()) {
-        word_diversity_normalization = std::stod(it->second);
-    }
-    
-    it = config_map_.find("document_processing.quality_filtering.quality_thresholds.sentence_normalization");
-    if (it != config_map_.end()) {
-        sentence_normalization = std::stod(it->second);
-    }
-    
     // Length factor
-    double length_factor = std::min(1.0, static_cast<double>(text.length()) / length_normalization);
-    score += length_factor * length_weight;
+    double length_factor = std::min(1.0, length / thresholds.length_normalization);
+    score += length_factor * weights.length_factor;
     
     // Word diversity factor
-    std::set<std::string> unique_words = utils::TextUtils::get_unique_words(text);
-    double word_diversity = static_cast<double>(unique_words.size()) / std::max(1.0, static_cast<double>(text.length() / word_diversity_normalization));
-    score += std::min(1.0, word_diversity) * word_diversity_weight;
+    double word_diversity = static_cast<double>(counts.unique_words) /
+                            std::max(1.0, length / thresholds.word_diversity_normalization);
+    score += std::min(1.0, word_diversity) * weights.word_diversity_factor;
     
     // Sentence structure factor
-    size_t sentence_count = utils::TextUtils::count_sentences(text);
-    double sentence_factor = std::min(1.0, static_cast<double>(sentence_count) / sentence_normalization);
-    score += sentence_factor * sentence_structure_weight;
+    double sentence_factor = std::min(1.0, static_cast<double>(counts.sentence_count) / thresholds.sentence_normalization);
+    score += sentence_factor * weights.sentence_structure_factor;
     
     // Information density factor
-    double info_density = calculate_information_density(text);
-    score += info_density * info_density_weight;
+    double info_density = information_density(counts, config);
+    score += info_density * weights.information_density_factor;
     
     return std::min(1.0, std::max(0.0, score));
 }
 
-double QualityAssessor::calculate_information_density(const std::string& text) {
-    if (text.empty()) {
+double QualityAssessor::information_density(const TextCounts& counts, const QualityConfig& config) {
+    if (counts.text_length == 0) {
         return 0.0;
     }
     
-    // Get weights from config (with defaults)
-    double unique_word_ratio_weight = 0.4;
-    double technical_term_density_weight = 0.3;
-    double sentence_complexity_weight = 0.3;
-    
-    auto it = config_map_.find("document_processing.quality_filtering.density_weights.unique_word_ratio");
-    if (it != config_map_.end()) {
-        unique_word_ratio_weight = std::stod(it->second);
-    }
-    
-    it = config_map_.find("document_processing.quality_filtering.density_weights.technical_term_density");
-    if (it != config_map_.end()) {
-        technical_term_density_weight = std::stod(it->second);
-    }
-    
-    it = config_map_.find("document_processing.quality_filtering.density_weights.sentence_complexity");
-    if (it != config_map_.end()) {
-        sentence_complexity_weight = std::stod(it->second);
-    }
-    
-    // Get thresholds from config (with defaults)
-    double word_diversity_normalization = 5.0;
-    double technical_term_normalization = 10.0;
-    double sentence_complexity_normalization = 100.0;
-    
-    it = config_map_.find("document_processing.quality_filtering.quality_thresholds.word_diversity_normalization");
-    if (it != config_map_.end()) {
-        word_diversity_normalization = std::stod(it->second);
-    }
-    
-    it = config_map_.find("document_processing.quality_filtering.quality_thresholds.technical_term_normalization");
-    if (it != config_map_.end()) {
-        technical_term_normalization = std::stod(it->second);
-    }
-    
-    it = config_map_.find("document_processing.quality_filtering.quality_thresholds.sentence_complexity_normalization");
-    if (it != config_map_.end()) {
-        sentence_complexity_normalization = std::stod(it->second);
-    }
-    
     // Calculate information density based on content characteristics
+    const DensityWeights& weights = config.density_weights;
+    const QualityThresholds& thresholds = config.thresholds;
+    const double length = static_cast<double>(counts.text_length);
     double density = 0.0;
     
     // Unique word ratio
-    std::set<std::string> unique_words = utils::TextUtils::get_unique_words(text);
-    double unique_word_ratio = static_cast<double>(unique_words.size()) / std::max(1.0, static_cast<double>(text.length() / word_diversity_normalization));
-    density += unique_word_ratio * unique_word_ratio_weight;
+    double unique_word_ratio = static_cast<double>(counts.unique_words) /
+                               std::max(1.0, length / thresholds.word_diversity_normalization);
+    density += unique_word_ratio * weights.unique_word_ratio;
     
     // Technical term density (words with numbers, special characters)
-    size_t technical_terms = utils::TextUtils::count_technical_terms(text);
-    double technical_density = static_cast<double>(technical_terms) / std::max(1.0, static_cast<double>(text.length() / technical_term_normalization));
-    density += technical_density * technical_term_density_weight;
+    double technical_density = static_cast<double>(counts.technical_terms) /
+                               std::max(1.0, length / thresholds.technical_term_normalization);
+    density += technical_density * weights.technical_term_density;
     
     // Sentence complexity (average sentence length)
-    size_t sentences = utils::TextUtils::count_sentences(text);
+    size_t sentences = counts.sentence_count;
     if (sentences > 0) {
-        double avg_sentence_length = static_cast<double>(text.length()) / sentences;
-        double complexity_factor = std::min(1.0, avg_sentence_length / sentence_complexity_normalization);
-        density += complexity_factor * sentence_complexity_weight;
+        double avg_sentence_length = length / sentences;
+        double complexity_factor = std::min(1.0, avg_sentence_length / thresholds.sentence_complexity_normalization);
+        density += complexity_factor * weights.sentence_complexity;
     }
     
     return std::min(1.0, std::max(0.0, density));
 }
 
-size_t QualityAssessor::count_unique_words(const std::string& text) {
-    return utils::TextUtils::get_unique_words(text).size();
-}
-
-size_t QualityAssessor::count_sentences(const std::string& text) {
-    return utils::TextUtils::count_sentences(text);
-}
-
-size_t QualityAssessor::count_technical_terms(const std::string& text) {
-    return utils::TextUtils::count_technical_terms(text);
-}
-
-std::string QualityAssessor::determine_quality_reason(const QualityMetrics& metrics) {
+std::string QualityAssessor::determine_quality_reason(const QualityMetrics& metrics, const QualityConfig& config) {
     if (metrics.is_high_quality) {
         return "High quality content";
-    } else if (metrics.text_length < config_.min_content_length) {
+    } else if (metrics.text_length < config.min_content_length) {
         return "Content too short";
-    } else if (metrics.content_quality_score < config_.min_content_quality_score) {
+    } else if (metrics.content_quality_score < config.min_content_quality_score) {
         return "Low content quality score";
-    } else if (metrics.information_density < config_.min_information_density) {
+    } else if (metrics.information_density < config.min_information_density) {
         return "Low information density";
     } else {
         return "Quality assessment failed";
@@ -275,4 +331,4 @@ std::string QualityAssessor::determine_quality_reason(const QualityMetrics& metr
 }
 
 } // namespace quality
-} // namespace r3m 
\ No newline at end of file
+} // namespace r3m
@@ -20,20 +20,33 @@ bool HttpServer::initialize(const std::unordered_map<std::string, std::string>&
         return false;
     }
     
+    // The passed values are defaults under the configuration file (the
+    // file is optional; without it the passed configuration is used as is)
+    config_manager_ = std::make_unique<core::ConfigManager>();
+    config_manager_->load_defaults(config);
+    bool config_loaded = config_manager_->load_config(CONFIG_PATH);
+    if (!config_loaded) {
+        std::cout << "Info: Using passed configuration (config file not found)" << std::endl;
+    }
+    
     // Initialize document processor
     processor_ = std::make_shared<core::DocumentProcessor>();
-    if (!processor_->initialize(config)) {
+    if (!processor_->initialize(config_manager_->snapshot())) {
         std::cerr << "Failed to initialize document processor" << std::endl;
         return false;
     }
     
-    // Initialize config manager (optional - use passed config if file not found)
-    config_manager_ = std::make_unique<core::ConfigManager>();
-    bool config_loaded = config_manager_->load_config("configs/dev/config.yaml");
-    if (!config_loaded) {
-        std::cout << "Info: Using passed configuration (config file not found)" << std::endl;
-        // Use the passed config instead
-        config_manager_->load_from_map(config);
+    // Hot reload: edits to the file reach documents started afterwards;
+    // requests in flight finish with the snapshot they started with
+    if (config_loaded) {
+        std::weak_ptr<core::DocumentProcessor> processor = processor_;
+        config_manager_->watch(CONFIG_RELOAD_INTERVAL, [processor](std::shared_ptr<const core::ConfigSnapshot> snapshot) {
+            if (auto target = processor.lock()) {
+                if (target->apply_config(std::move(snapshot))) {
+                    std::cout << "Info: Reloaded " << CONFIG_PATH << std::endl;
+                }
+            }
+        });
     }
     
     // Initialize modules
@@ -0,0 +1,61 @@
+#include "r3m/utils/bump_arena.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+namespace r3m::utils {
+
+void* BumpArena::allocate(size_t size, size_t alignment) {
+    auto aligned = [alignment](std::byte* p) {
+        uintptr_t address = reinterpret_cast<uintptr_t>(p);
+        return reinterpret_cast<std::byte*>((address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+    };
+
+    std::byte* start = cursor_ ? aligned(cursor_) : nullptr;
+    if (!start || start > end_ || static_cast<size_t>(end_ - start) < size) {
+        add_block(size + alignment - 1);
+        start = aligned(cursor_);
+    }
+
+    cursor_ = start + size;
+    bytes_allocated_ += size;
+    return start;
+}
+
+std::string_view BumpArena::store(std::string_view text) {
+    if (text.empty()) {
+        return std::string_view();
+    }
+    char* copy = static_cast<char*>(allocate(text.size(), 1));
+    std::memcpy(copy, text.data(), text.size());
+    return std::string_view(copy, text.size());
+}
+
+void BumpArena::reset() {
+    blocks_.clear();
+    cursor_ = nullptr;
+    end_ = nullptr;
+    next_block_size_ = INITIAL_BLOCK_SIZE;
+    bytes_allocated_ = 0;
+    bytes_reserved_ = 0;
+}
+
+void BumpArena::add_block(size_t min_size) {
+    // Oversized requests get a block of their own size; the doubling
+    // sequence of regular blocks is not disturbed by them
+    size_t size = std::max(next_block_size_, min_size);
+    if (min_size <= next_block_size_) {
+        next_block_size_ = std::min(next_block_size_ * 2, MAX_BLOCK_SIZE);
+    }
+
+    Block block;
+    block.data = std::make_unique_for_overwrite<std::byte[]>(size);
+    block.size = size;
+    cursor_ = block.data.get();
+    end_ = cursor_ + size;
+    bytes_reserved_ += size;
+    blocks_.push_back(std::move(block));
+}
+
+} // namespace r3m::utils
@@ -0,0 +1,55 @@
+#include "r3m/utils/hyperloglog.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace r3m::utils {
+
+HyperLogLog::HyperLogLog(double relative_error)
+    : precision_(precision_for_error(relative_error)),
+      registers_(size_t{1} << precision_, 0) {}
+
+int HyperLogLog::precision_for_error(double relative_error) {
+    if (!(relative_error > 0.0)) {
+        return MAX_PRECISION;
+    }
+    // Standard error 1.04 / sqrt(m) with m = 2^p registers
+    const double registers = std::pow(1.04 / relative_error, 2.0);
+    const int precision = static_cast<int>(std::ceil(std::log2(registers)));
+    return std::clamp(precision, MIN_PRECISION, MAX_PRECISION);
+}
+
+size_t HyperLogLog::estimate() const {
+    const double m = static_cast<double>(registers_.size());
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (uint8_t rank : registers_) {
+        sum += std::ldexp(1.0, -static_cast<int>(rank));
+        zeros += rank == 0;
+    }
+
+    double alpha;
+    switch (registers_.size()) {
+        case 16: alpha = 0.673; break;
+        case 32: alpha = 0.697; break;
+        case 64: alpha = 0.709; break;
+        default: alpha = 0.7213 / (1.0 + 1.079 / m); break;
+    }
+    double estimate = alpha * m * m / sum;
+
+    // Small range: linear counting over the empty registers is more accurate
+    if (estimate <= 2.5 * m && zeros != 0) {
+        estimate = m * std::log(m / static_cast<double>(zeros));
+    }
+    return static_cast<size_t>(std::llround(estimate));
+}
+
+double HyperLogLog::standard_error() const {
+    return 1.04 / std::sqrt(static_cast<double>(registers_.size()));
+}
+
+void HyperLogLog::clear() {
+    std::fill(registers_.begin(), registers_.end(), 0);
+}
+
+} // namespace r3m::utils
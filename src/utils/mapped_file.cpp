@@ -0,0 +1,107 @@
+#include "r3m/utils/mapped_file.hpp"
+
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace r3m::utils {
+
+MappedFile::MappedFile(const std::string& file_path) {
+    int fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open file: " + file_path + " (" + std::strerror(errno) + ")");
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        int err = errno;
+        ::close(fd);
+        throw std::runtime_error("Cannot stat file: " + file_path + " (" + std::strerror(err) + ")");
+    }
+
+    size_t file_size = static_cast<size_t>(st.st_size);
+
+    if (file_size >= MMAP_THRESHOLD) {
+        void* addr = ::mmap(nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            // Extraction walks the file front to back: ask for aggressive readahead
+            ::madvise(addr, file_size, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(addr);
+            size_ = file_size;
+            mapped_ = true;
+            ::close(fd);
+            return;
+        }
+        // Fall through to read() if the file cannot be mapped (e.g. pipes, procfs)
+    }
+
+    // Small files (and unmappable ones) are read in one go; st_size may be 0
+    // for special files, so keep reading until EOF.
+    buffer_.resize(file_size > 0 ? file_size : 4096);
+    size_t total = 0;
+    while (true) {
+        if (total == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);
+        }
+        ssize_t n = ::read(fd, buffer_.data() + total, buffer_.size() - total);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            int err = errno;
+            ::close(fd);
+            throw std::runtime_error("Cannot read file: " + file_path + " (" + std::strerror(err) + ")");
+        }
+        if (n == 0) break;
+        total += static_cast<size_t>(n);
+    }
+    ::close(fd);
+
+    buffer_.resize(total);
+    data_ = buffer_.data();
+    size_ = total;
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(other.data_), size_(other.size_), mapped_(other.mapped_), buffer_(std::move(other.buffer_)) {
+    if (!mapped_) {
+        data_ = buffer_.data();
+    }
+    other.data_ = nullptr;
+    other.size_ = 0;
+    other.mapped_ = false;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        mapped_ = other.mapped_;
+        size_ = other.size_;
+        buffer_ = std::move(other.buffer_);
+        data_ = mapped_ ? other.data_ : buffer_.data();
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.mapped_ = false;
+    }
+    return *this;
+}
+
+void MappedFile::release() {
+    if (mapped_ && data_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    buffer_.clear();
+}
+
+} // namespace r3m::utils
@@ -136,6 +136,14 @@ size_t PerformanceUtils::get_current_memory_usage() {
     return 0;
 }
 
+size_t PerformanceUtils::get_page_faults() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        return static_cast<size_t>(usage.ru_minflt + usage.ru_majflt);
+    }
+    return 0;
+}
+
 // Explicit template instantiations for common use cases
 template PerformanceUtils::BenchmarkResults PerformanceUtils::BenchmarkRunner::run_benchmark<std::function<void()>>(std::function<void()>&& func);
 
@@ -0,0 +1,54 @@
+// Built with -mavx2; only reached when cpuid reports AVX2
+#include "simd_kernels_impl.hpp"
+
+#include <immintrin.h>
+
+namespace r3m::utils {
+
+namespace {
+
+struct AVX2 {
+    using Vec = __m256i;
+    static constexpr size_t WIDTH = 32;
+
+    struct Tables {
+        __m256i low_rows;
+        __m256i high_rows;
+        __m256i row_bits;
+        __m256i nibble;
+    };
+
+    static Vec load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static Vec splat(char c) { return _mm256_set1_epi8(c); }
+
+    static uint64_t eq_mask(Vec a, Vec b) {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+    }
+
+    static Tables prepare(const ByteSet& set) {
+        // vpshufb looks up within each 128-bit lane, so tables are broadcast to both
+        return Tables{
+            _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.low_rows))),
+            _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.high_rows))),
+            _mm256_broadcastsi128_si256(_mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128,
+                                                      1, 2, 4, 8, 16, 32, 64, -128)),
+            _mm256_set1_epi8(0x0F)
+        };
+    }
+
+    static uint64_t set_mask(Vec v, const Tables& t) {
+        __m256i lo = _mm256_and_si256(v, t.nibble);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), t.nibble);
+        __m256i rows = _mm256_blendv_epi8(_mm256_shuffle_epi8(t.low_rows, lo),
+                                          _mm256_shuffle_epi8(t.high_rows, lo), v);
+        __m256i bit = _mm256_shuffle_epi8(t.row_bits, hi);
+        return static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(rows, bit), bit)));
+    }
+};
+
+} // namespace
+
+constinit const SIMDKernels avx2_kernels = VectorKernels<AVX2>::table("avx2", SIMDIsa::AVX2);
+
+} // namespace r3m::utils
@@ -0,0 +1,53 @@
+// Built with -mavx512f -mavx512bw; only reached when cpuid reports both
+#include "simd_kernels_impl.hpp"
+
+#include <immintrin.h>
+
+namespace r3m::utils {
+
+namespace {
+
+struct AVX512BW {
+    using Vec = __m512i;
+    static constexpr size_t WIDTH = 64;
+
+    struct Tables {
+        __m512i low_rows;
+        __m512i high_rows;
+        __m512i row_bits;
+        __m512i nibble;
+    };
+
+    static Vec load(const char* p) { return _mm512_loadu_si512(p); }
+    static Vec splat(char c) { return _mm512_set1_epi8(c); }
+
+    static uint64_t eq_mask(Vec a, Vec b) { return _mm512_cmpeq_epi8_mask(a, b); }
+
+    // vpshufb looks up within each 128-bit lane, so tables are broadcast to all
+    // four (the zero-masked form avoids GCC's bogus -Wuninitialized on the plain one)
+    static __m512i broadcast(__m128i row) { return _mm512_maskz_broadcast_i32x4(0xFFFF, row); }
+
+    static Tables prepare(const ByteSet& set) {
+        return Tables{
+            broadcast(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.low_rows))),
+            broadcast(_mm_loadu_si128(reinterpret_cast<const __m128i*>(set.high_rows))),
+            broadcast(_mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128)),
+            _mm512_set1_epi8(0x0F)
+        };
+    }
+
+    static uint64_t set_mask(Vec v, const Tables& t) {
+        __m512i lo = _mm512_and_si512(v, t.nibble);
+        __m512i hi = _mm512_and_si512(_mm512_srli_epi16(v, 4), t.nibble);
+        __m512i rows = _mm512_mask_blend_epi8(_mm512_movepi8_mask(v),
+                                              _mm512_shuffle_epi8(t.low_rows, lo),
+                                              _mm512_shuffle_epi8(t.high_rows, lo));
+        return _mm512_test_epi8_mask(rows, _mm512_shuffle_epi8(t.row_bits, hi));
+    }
+};
+
+} // namespace
+
+constinit const SIMDKernels avx512bw_kernels = VectorKernels<AVX512BW>::table("avx512bw", SIMDIsa::AVX512BW);
+
+} // namespace r3m::utils
@@ -0,0 +1,205 @@
+#pragma once
+
+// Shared implementation of the SIMDKernels tables, private to the
+// simd_kernels_*.cpp translation units.
+//
+// Each of those files is compiled with its own instruction-set flags, so
+// everything here must have internal linkage: an inline function or template
+// instantiation shared between them could be emitted once with, say, AVX-512
+// instructions and then picked by the linker for every caller. For the same
+// reason only C headers are included (no std templates get instantiated).
+
+#include "r3m/utils/simd_kernels.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace r3m::utils {
+namespace {
+
+bool in_set(const ByteSet& set, unsigned char c) {
+    const uint8_t* rows = c < 0x80 ? set.low_rows : set.high_rows;
+    return (rows[c & 0x0F] >> ((c >> 4) & 7)) & 1;
+}
+
+void clear_bits(uint64_t* bits, size_t len) {
+    memset(bits, 0, ((len + 63) / 64) * sizeof(uint64_t));
+}
+
+// Scalar kernels; the vector kernels use them for their tails
+
+size_t scalar_count_byte(const char* data, size_t len, char target) {
+    size_t count = 0;
+    for (size_t i = 0; i < len; ++i) {
+        count += data[i] == target;
+    }
+    return count;
+}
+
+size_t scalar_count_set(const char* data, size_t len, const ByteSet& set) {
+    size_t count = 0;
+    for (size_t i = 0; i < len; ++i) {
+        count += in_set(set, static_cast<unsigned char>(data[i]));
+    }
+    return count;
+}
+
+// Set bits for positions [begin, len); the bitmap must already be cleared
+void scalar_set_mask_from(const char* data, size_t begin, size_t len, const ByteSet& set, uint64_t* bits) {
+    for (size_t i = begin; i < len; ++i) {
+        if (in_set(set, static_cast<unsigned char>(data[i]))) {
+            bits[i / 64] |= uint64_t(1) << (i % 64);
+        }
+    }
+}
+
+void scalar_pair_mask_from(const char* data, size_t begin, size_t len, char first, char second, uint64_t* bits) {
+    for (size_t i = begin; i < len; ++i) {
+        if (data[i] == first && data[i + 1] == second) {
+            bits[i / 64] |= uint64_t(1) << (i % 64);
+        }
+    }
+}
+
+size_t scalar_find_substring_from(const char* data, size_t len, size_t begin,
+                                  const char* pattern, size_t pattern_len) {
+    if (pattern_len == 0) {
+        return begin <= len ? begin : SIZE_MAX;
+    }
+    if (pattern_len > len) {
+        return SIZE_MAX;
+    }
+    for (size_t i = begin; i + pattern_len <= len; ++i) {
+        if (data[i] == pattern[0] && memcmp(data + i, pattern, pattern_len) == 0) {
+            return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+size_t scalar_find_substring(const char* data, size_t len, const char* pattern, size_t pattern_len) {
+    return scalar_find_substring_from(data, len, 0, pattern, pattern_len);
+}
+
+size_t scalar_count_word_tokens(const char* data, size_t len, const ByteSet& spaces,
+                                const ByteSet& punctuation, bool* in_word) {
+    size_t count = 0;
+    bool word = *in_word;
+    for (size_t i = 0; i < len; ++i) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        bool is_punct = in_set(punctuation, c);
+        bool is_word = !is_punct && !in_set(spaces, c);
+        count += is_punct + (is_word && !word);
+        word = is_word;
+    }
+    *in_word = word;
+    return count;
+}
+
+/**
+ * Kernels over an ISA description providing:
+ *   Vec, WIDTH (bytes per vector, dividing 64), Tables,
+ *   load(p), splat(c), eq_mask(a, b), prepare(set), set_mask(v, tables)
+ * where the *_mask functions return one bit per byte (bit 0 = lowest address).
+ */
+template <typename Isa>
+struct VectorKernels {
+    static constexpr size_t W = Isa::WIDTH;
+    static constexpr uint64_t LANES = W == 64 ? ~uint64_t(0) : (uint64_t(1) << W) - 1;
+
+    static size_t count_byte(const char* data, size_t len, char target) {
+        auto needle = Isa::splat(target);
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + W <= len; i += W) {
+            count += __builtin_popcountll(Isa::eq_mask(Isa::load(data + i), needle));
+        }
+        return count + scalar_count_byte(data + i, len - i, target);
+    }
+
+    static size_t count_set(const char* data, size_t len, const ByteSet& set) {
+        auto tables = Isa::prepare(set);
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + W <= len; i += W) {
+            count += __builtin_popcountll(Isa::set_mask(Isa::load(data + i), tables));
+        }
+        return count + scalar_count_set(data + i, len - i, set);
+    }
+
+    static void set_mask(const char* data, size_t len, const ByteSet& set, uint64_t* bits) {
+        clear_bits(bits, len);
+        auto tables = Isa::prepare(set);
+        size_t i = 0;
+        for (; i + W <= len; i += W) {
+            bits[i / 64] |= Isa::set_mask(Isa::load(data + i), tables) << (i % 64);
+        }
+        scalar_set_mask_from(data, i, len, set, bits);
+    }
+
+    static void pair_mask(const char* data, size_t len, char first, char second, uint64_t* bits) {
+        clear_bits(bits, len);
+        auto first_vec = Isa::splat(first);
+        auto second_vec = Isa::splat(second);
+        size_t i = 0;
+        for (; i + W <= len; i += W) {
+            uint64_t mask = Isa::eq_mask(Isa::load(data + i), first_vec) &
+                            Isa::eq_mask(Isa::load(data + i + 1), second_vec);
+            bits[i / 64] |= mask << (i % 64);
+        }
+        scalar_pair_mask_from(data, i, len, first, second, bits);
+    }
+
+    static size_t find_substring(const char* data, size_t len, const char* pattern, size_t pattern_len) {
+        if (pattern_len == 0 || pattern_len > len) {
+            return scalar_find_substring(data, len, pattern, pattern_len);
+        }
+        // Candidates must match the first and last pattern byte
+        auto first_vec = Isa::splat(pattern[0]);
+        auto last_vec = Isa::splat(pattern[pattern_len - 1]);
+        size_t starts = len - pattern_len + 1;
+        size_t i = 0;
+        for (; i + W <= starts; i += W) {
+            uint64_t mask = Isa::eq_mask(Isa::load(data + i), first_vec) &
+                            Isa::eq_mask(Isa::load(data + i + pattern_len - 1), last_vec);
+            while (mask != 0) {
+                size_t pos = i + static_cast<size_t>(__builtin_ctzll(mask));
+                if (memcmp(data + pos, pattern, pattern_len) == 0) {
+                    return pos;
+                }
+                mask &= mask - 1;
+            }
+        }
+        return scalar_find_substring_from(data, len, i, pattern, pattern_len);
+    }
+
+    static size_t count_word_tokens(const char* data, size_t len, const ByteSet& spaces,
+                                    const ByteSet& punctuation, bool* in_word) {
+        auto space_tables = Isa::prepare(spaces);
+        auto punct_tables = Isa::prepare(punctuation);
+        uint64_t prev_word = *in_word ? 1 : 0;
+        size_t count = 0;
+        size_t i = 0;
+        for (; i + W <= len; i += W) {
+            auto chunk = Isa::load(data + i);
+            uint64_t space_mask = Isa::set_mask(chunk, space_tables);
+            uint64_t punct_mask = Isa::set_mask(chunk, punct_tables);
+            uint64_t word_mask = ~(space_mask | punct_mask) & LANES;
+
+            // A word token starts at every word byte not preceded by one
+            uint64_t word_starts = word_mask & ~((word_mask << 1) | prev_word);
+            count += __builtin_popcountll(word_starts) + __builtin_popcountll(punct_mask);
+            prev_word = (word_mask >> (W - 1)) & 1;
+        }
+        *in_word = prev_word != 0;
+        return count + scalar_count_word_tokens(data + i, len - i, spaces, punctuation, in_word);
+    }
+
+    static constexpr SIMDKernels table(const char* name, SIMDIsa isa) {
+        return SIMDKernels{name, isa, &count_byte, &count_set, &set_mask,
+                           &pair_mask, &find_substring, &count_word_tokens};
+    }
+};
+
+} // namespace
+} // namespace r3m::utils
@@ -0,0 +1,51 @@
+// AArch64 only (NEON is part of the base ISA)
+#include "simd_kernels_impl.hpp"
+
+#include <arm_neon.h>
+
+namespace r3m::utils {
+
+namespace {
+
+const uint8_t ROW_BITS[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+
+struct NEON {
+    using Vec = uint8x16_t;
+    static constexpr size_t WIDTH = 16;
+
+    struct Tables {
+        uint8x16_t low_rows;
+        uint8x16_t high_rows;
+        uint8x16_t row_bits;
+    };
+
+    static Vec load(const char* p) { return vld1q_u8(reinterpret_cast<const uint8_t*>(p)); }
+    static Vec splat(char c) { return vdupq_n_u8(static_cast<uint8_t>(c)); }
+
+    // One bit per 0x00/0xFF lane, like x86 movemask
+    static uint64_t movemask(uint8x16_t lanes) {
+        uint8x16_t bits = vandq_u8(lanes, vld1q_u8(ROW_BITS));
+        return static_cast<uint64_t>(vaddv_u8(vget_low_u8(bits))) |
+               (static_cast<uint64_t>(vaddv_u8(vget_high_u8(bits))) << 8);
+    }
+
+    static uint64_t eq_mask(Vec a, Vec b) { return movemask(vceqq_u8(a, b)); }
+
+    static Tables prepare(const ByteSet& set) {
+        return Tables{vld1q_u8(set.low_rows), vld1q_u8(set.high_rows), vld1q_u8(ROW_BITS)};
+    }
+
+    static uint64_t set_mask(Vec v, const Tables& t) {
+        uint8x16_t lo = vandq_u8(v, vdupq_n_u8(0x0F));
+        uint8x16_t hi = vshrq_n_u8(v, 4);
+        uint8x16_t rows = vbslq_u8(vcgeq_u8(v, vdupq_n_u8(0x80)),
+                                   vqtbl1q_u8(t.high_rows, lo), vqtbl1q_u8(t.low_rows, lo));
+        return movemask(vtstq_u8(rows, vqtbl1q_u8(t.row_bits, hi)));
+    }
+};
+
+} // namespace
+
+constinit const SIMDKernels neon_kernels = VectorKernels<NEON>::table("neon", SIMDIsa::NEON);
+
+} // namespace r3m::utils
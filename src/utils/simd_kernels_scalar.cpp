@@ -0,0 +1,25 @@
+#include "simd_kernels_impl.hpp"
+
+namespace r3m::utils {
+
+namespace {
+
+void scalar_set_mask(const char* data, size_t len, const ByteSet& set, uint64_t* bits) {
+    clear_bits(bits, len);
+    scalar_set_mask_from(data, 0, len, set, bits);
+}
+
+void scalar_pair_mask(const char* data, size_t len, char first, char second, uint64_t* bits) {
+    clear_bits(bits, len);
+    scalar_pair_mask_from(data, 0, len, first, second, bits);
+}
+
+} // namespace
+
+constinit const SIMDKernels scalar_kernels = {
+    "scalar", SIMDIsa::Scalar,
+    &scalar_count_byte, &scalar_count_set, &scalar_set_mask,
+    &scalar_pair_mask, &scalar_find_substring, &scalar_count_word_tokens
+};
+
+} // namespace r3m::utils
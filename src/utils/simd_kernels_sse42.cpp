@@ -0,0 +1,52 @@
+// Built with -msse4.2; only reached when cpuid reports SSE4.2
+#include "simd_kernels_impl.hpp"
+
+#include <immintrin.h>
+
+namespace r3m::utils {
+
+namespace {
+
+struct SSE42 {
+    using Vec = __m128i;
+    static constexpr size_t WIDTH = 16;
+
+    struct Tables {
+        __m128i low_rows;
+        __m128i high_rows;
+        __m128i row_bits;
+        __m128i nibble;
+    };
+
+    static Vec load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    static Vec splat(char c) { return _mm_set1_epi8(c); }
+
+    static uint64_t eq_mask(Vec a, Vec b) {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)));
+    }
+
+    static Tables prepare(const ByteSet& set) {
+        return Tables{
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.low_rows)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.high_rows)),
+            _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128),
+            _mm_set1_epi8(0x0F)
+        };
+    }
+
+    static uint64_t set_mask(Vec v, const Tables& t) {
+        __m128i lo = _mm_and_si128(v, t.nibble);
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), t.nibble);
+        // Row for the low nibble, from the high table when the byte's top bit is set
+        __m128i rows = _mm_blendv_epi8(_mm_shuffle_epi8(t.low_rows, lo),
+                                       _mm_shuffle_epi8(t.high_rows, lo), v);
+        __m128i bit = _mm_shuffle_epi8(t.row_bits, hi);
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(rows, bit), bit)));
+    }
+};
+
+} // namespace
+
+constinit const SIMDKernels sse42_kernels = VectorKernels<SSE42>::table("sse4.2", SIMDIsa::SSE42);
+
+} // namespace r3m::utils
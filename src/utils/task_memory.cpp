@@ -0,0 +1,24 @@
+#include "r3m/utils/task_memory.hpp"
+
+namespace r3m::utils {
+
+namespace {
+
+thread_local std::pmr::memory_resource* current_task_resource = nullptr;
+
+} // namespace
+
+std::pmr::memory_resource* task_memory_resource() {
+    return current_task_resource ? current_task_resource : std::pmr::get_default_resource();
+}
+
+TaskMemoryScope::TaskMemoryScope(std::pmr::memory_resource* resource)
+    : previous_(current_task_resource) {
+    current_task_resource = resource;
+}
+
+TaskMemoryScope::~TaskMemoryScope() {
+    current_task_resource = previous_;
+}
+
+} // namespace r3m::utils
@@ -2,6 +2,9 @@
 #include "r3m/utils/simd_utils.hpp"
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
+#include <array>
+#include <cctype>
 #include <cstring>
 
 namespace r3m::utils {
@@ -46,19 +49,73 @@ std::string TextProcessing::clean_text(const std::string& text) {
     return result;
 }
 
+bool TextProcessing::is_clean_text(std::string_view text) {
+    // The bytes clean_text drops: filtered ASCII code points, and (char being
+    // signed) control characters other than newline and tab and every byte
+    // of a multibyte character
+    static const std::array<bool, 256> dropped = []() {
+        std::array<bool, 256> table{};
+        for (unsigned c = 0; c < table.size(); ++c) {
+            const char ch = static_cast<char>(c);
+            table[c] = (c < 127 && is_unicode_filtered(c)) || !(ch >= ' ' || ch == '\n' || ch == '\t');
+        }
+        return table;
+    }();
+    return std::none_of(text.begin(), text.end(),
+                        [](char ch) { return dropped[static_cast<unsigned char>(ch)]; });
+}
+
+namespace {
+
+// Bytes shared_precompare_cleanup drops: whitespace (as std::isspace in the
+// "C" locale), '*' and .,:`"#-
+constexpr std::array<bool, 256> make_precompare_removed() {
+    std::array<bool, 256> removed{};
+    for (unsigned char c : {' ', '\t', '\n', '\v', '\f', '\r', '*', '.', ',', ':', '`', '"', '#', '-'}) {
+        removed[c] = true;
+    }
+    return removed;
+}
+
+constexpr std::array<bool, 256> PRECOMPARE_REMOVED = make_precompare_removed();
+
+// An escaped quote (\") is dropped as a pair; a lone backslash is kept
+bool is_escaped_quote(std::string_view text, size_t i) {
+    return text[i] == '\\' && i + 1 < text.size() && text[i + 1] == '"';
+}
+
+} // namespace
+
 std::string TextProcessing::shared_precompare_cleanup(const std::string& text) {
-    std::string result = text;
-    
-    // Convert to lowercase
-    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
-    
-    // Remove whitespace, asterisks, escaped quotes, and punctuation
-    std::regex pattern(R"(\s|\*|\\"|[.,:`"#-])");
-    result = std::regex_replace(result, pattern, "");
+    // Lowercase and remove whitespace, asterisks, escaped quotes and punctuation
+    std::string result;
+    result.reserve(text.size());
+    
+    std::string_view view(text);
+    for (size_t i = 0; i < view.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(view[i]);
+        if (is_escaped_quote(view, i)) {
+            ++i;
+        } else if (!PRECOMPARE_REMOVED[c]) {
+            result += static_cast<char>(std::tolower(c));
+        }
+    }
     
     return result;
 }
 
+size_t TextProcessing::precompare_cleanup_length(std::string_view text) {
+    size_t length = 0;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (is_escaped_quote(text, i)) {
+            ++i;
+        } else {
+            length += !PRECOMPARE_REMOVED[static_cast<unsigned char>(text[i])];
+        }
+    }
+    return length;
+}
+
 std::string TextProcessing::remove_punctuation(const std::string& text) {
     // Use SIMD-optimized punctuation removal
     std::vector<char> punctuation_chars = {'.', ',', '!', '?', ';', ':', '"', '\'', '(', ')', '[', ']', '{', '}', '-', '_'};
@@ -1,4 +1,5 @@
 #include "r3m/utils/text_utils.hpp"
+#include "r3m/utils/simd_utils.hpp"
 
 #include <filesystem>
 #include <fstream>
@@ -6,41 +7,185 @@
 #include <algorithm>
 #include <cctype>
 #include <set>
+#include <cstring>
 
 namespace r3m {
 namespace utils {
 
-// Text cleaning and normalization
-std::string TextUtils::normalize_whitespace(const std::string& text) {
-    std::string result = text;
+namespace {
+
+void add_to_set(ByteSet& set, unsigned char b) {
+    uint8_t* rows = b < 0x80 ? set.low_rows : set.high_rows;
+    rows[b & 0x0F] |= static_cast<uint8_t>(1u << ((b >> 4) & 7));
+}
+
+// Bytes clean_text_content drops: control characters other than \t, \n and
+// \r. Compared as unsigned char, so UTF-8 lead and continuation bytes
+// (>= 0x80) are kept
+ByteSet make_control_set() {
+    ByteSet set{};
+    for (int b = 0; b < 32; ++b) {
+        if (b != '\n' && b != '\t' && b != '\r') {
+            add_to_set(set, static_cast<unsigned char>(b));
+        }
+    }
+    return set;
+}
+
+// std::isspace in the "C" locale (what \s matches)
+bool is_space_byte(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Bytes scanned per bitmap window
+constexpr size_t CLEAN_WINDOW = 4096;
+
+/**
+ * One forward pass equivalent to, in order: stripping <[^>]*> (strip_tags),
+ * replacing \s+ with ' ' and trimming (collapse_whitespace), and dropping
+ * control characters (drop_controls). Ordinary bytes are copied in runs;
+ * the SIMD kernels locate the bytes that need attention.
+ *
+ * offsets (sorted positions in text, may be null) are rewritten to the
+ * position in the result where the text from that point on starts.
+ */
+std::string clean_in_one_pass(std::string_view text, bool strip_tags, bool collapse_whitespace, bool drop_controls,
+                              std::vector<size_t>* offsets = nullptr) {
+    static const ByteSet control_set = make_control_set();
+    
+    ByteSet specials{};
+    if (strip_tags) {
+        add_to_set(specials, '<');
+    }
+    if (collapse_whitespace) {
+        for (char c : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+            add_to_set(specials, static_cast<unsigned char>(c));
+        }
+    }
+    if (drop_controls) {
+        for (size_t i = 0; i < 16; ++i) {
+            specials.low_rows[i] |= control_set.low_rows[i];
+            specials.high_rows[i] |= control_set.high_rows[i];
+        }
+    }
     
-    // Replace multiple whitespace with single space
-    std::regex whitespace_regex("\\s+");
-    result = std::regex_replace(result, whitespace_regex, " ");
+    const SIMDKernels& kernels = SIMDUtils::kernels();
+    const char* data = text.data();
+    const size_t len = text.size();
+    std::string out;
+    out.reserve(len);
     
-    // Trim leading and trailing whitespace
-    result.erase(0, result.find_first_not_of(" \t\n\r"));
-    result.erase(result.find_last_not_of(" \t\n\r") + 1);
+    // Whitespace collapsing state: a run of whitespace is pending, and whether
+    // anything has been emitted yet (leading whitespace is trimmed; a pending
+    // run at the very end is trailing whitespace and is dropped)
+    bool pending_space = false;
+    bool emitted = false;
+    auto begin_output = [&]() {
+        if (pending_space && emitted) {
+            out.push_back(' ');
+        }
+        pending_space = false;
+        emitted = true;
+    };
+    auto emit_run = [&](size_t from, size_t to) {
+        if (from < to) {
+            begin_output();
+            out.append(data + from, to - from);
+        }
+    };
     
-    return result;
+    // Offsets are mapped once the scan reaches them (text after a pending
+    // space starts past it), so windows stop at the next unmapped offset
+    size_t mapped = 0;
+    auto map_offsets = [&](size_t upto) {
+        for (; offsets && mapped < offsets->size() && (*offsets)[mapped] <= upto; ++mapped) {
+            (*offsets)[mapped] = out.size() + (pending_space && emitted ? 1 : 0);
+        }
+    };
+    
+    uint64_t bits[CLEAN_WINDOW / 64];
+    size_t pos = 0;
+    while (pos < len) {
+        map_offsets(pos);
+        size_t window_end = pos + std::min(CLEAN_WINDOW, len - pos);
+        if (offsets && mapped < offsets->size()) {
+            window_end = std::min(window_end, (*offsets)[mapped]);
+        }
+        kernels.set_mask(data + pos, window_end - pos, specials, bits);
+        
+        size_t run = pos;  // Start of the ordinary bytes not yet copied
+        size_t next = window_end;
+        for (size_t word = 0; word < (window_end - pos + 63) / 64 && next == window_end; ++word) {
+            uint64_t mask = bits[word];
+            while (mask != 0) {
+                size_t at = pos + word * 64 + static_cast<size_t>(__builtin_ctzll(mask));
+                mask &= mask - 1;
+                if (at < run) {
+                    continue;  // Inside a tag that was skipped
+                }
+                emit_run(run, at);
+                char c = data[at];
+                run = at + 1;
+                
+                if (c == '<' && strip_tags) {
+                    const void* close = std::memchr(data + at + 1, '>', len - at - 1);
+                    if (close) {
+                        run = static_cast<size_t>(static_cast<const char*>(close) - data) + 1;
+                        if (run > window_end) {
+                            next = run;  // Tag ends past this window: rescan from there
+                            break;
+                        }
+                    } else {
+                        // No '>' follows, so neither this '<' nor any later one opens a tag
+                        strip_tags = false;
+                        emit_run(at, at + 1);
+                    }
+                } else if (collapse_whitespace && is_space_byte(c)) {
+                    pending_space = true;
+                } else if (drop_controls && c != '<') {
+                    // Still output of the whitespace stage, just removed afterwards
+                    begin_output();
+                } else {
+                    emit_run(at, at + 1);
+                }
+            }
+        }
+        
+        if (next == window_end) {
+            emit_run(run, window_end);
+        }
+        pos = next;
+    }
+    
+    // Trailing whitespace is trimmed, so nothing starts past the end
+    map_offsets(SIZE_MAX);
+    if (offsets) {
+        for (size_t& offset : *offsets) {
+            offset = std::min(offset, out.size());
+        }
+    }
+    
+    return out;
+}
+
+} // namespace
+
+// Text cleaning and normalization
+std::string TextUtils::normalize_whitespace(const std::string& text) {
+    return clean_in_one_pass(text, false, true, false);
 }
 
 std::string TextUtils::remove_html_tags(const std::string& text) {
-    std::regex html_tag_regex("<[^>]*>");
-    return std::regex_replace(text, html_tag_regex, "");
+    return clean_in_one_pass(text, true, false, false);
 }
 
 std::string TextUtils::clean_text_content(const std::string& text) {
-    std::string result = text;
-    
-    // Remove null characters
-    result.erase(std::remove(result.begin(), result.end(), '\0'), result.end());
-    
-    // Remove other control characters except newlines and tabs
-    result.erase(std::remove_if(result.begin(), result.end(),
-        [](char c) { return c < 32 && c != '\n' && c != '\t' && c != '\r'; }), result.end());
-    
-    return result;
+    return clean_in_one_pass(text, false, false, true);
+}
+
+std::string TextUtils::clean_document_text(std::string_view text, bool strip_html_tags, bool collapse_whitespace,
+                                           std::vector<size_t>* offsets) {
+    return clean_in_one_pass(text, strip_html_tags, collapse_whitespace, true, offsets);
 }
 
 std::string TextUtils::trim_whitespace(const std::string& text) {
@@ -1,14 +1,32 @@
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <regex>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "r3m/utils/text_processing.hpp"
 #include "r3m/chunking/advanced_tokenizer.hpp"
+#include "r3m/utils/simd_utils.hpp"
 
 using namespace r3m::utils;
 using namespace r3m::chunking;
 
+// Regex implementation shared_precompare_cleanup replaced
+static std::string legacy_precompare_cleanup(const std::string& text) {
+    std::string result = text;
+    std::transform(result.begin(), result.end(), result.begin(), ::tolower);
+    std::regex pattern(R"(\s|\*|\\"|[.,:`"#-])");
+    return std::regex_replace(result, pattern, "");
+}
+
 void test_text_processing_utilities() {
     std::cout << "Testing TextProcessing utilities..." << std::endl;
     
@@ -23,6 +41,23 @@ void test_text_processing_utilities() {
     std::string cleaned_for_compare = TextProcessing::shared_precompare_cleanup(text_to_clean);
     assert(cleaned_for_compare.find(" ") == std::string::npos);
     assert(cleaned_for_compare.find(",") == std::string::npos);
+    
+    // Same output as the regex it replaced, including escaped quotes
+    const std::string alphabet = "aB \t\n\r\v\f*\\\".,:`#-!Z9_\x01\xC3\xA9";
+    std::mt19937 rng(12);
+    for (int iteration = 0; iteration < 5000; ++iteration) {
+        std::string input;
+        size_t length = rng() % 40;
+        for (size_t i = 0; i < length; ++i) {
+            input += alphabet[rng() % alphabet.size()];
+        }
+        std::string expected = legacy_precompare_cleanup(input);
+        assert(TextProcessing::shared_precompare_cleanup(input) == expected);
+        assert(TextProcessing::precompare_cleanup_length(input) == expected.length());
+        (void)expected;
+    }
+    assert(TextProcessing::shared_precompare_cleanup("A\\\"b\\") == "ab\\");
+    assert(TextProcessing::precompare_cleanup_length(TextProcessing::SECTION_SEPARATOR) == 0);
     std::cout << "✅ shared_precompare_cleanup test passed!" << std::endl;
     
     // Test remove_punctuation
@@ -154,6 +189,11 @@ void test_sentence_tokenizer() {
 void test_bpe_tokenizer() {
     std::cout << "Testing BPETokenizer..." << std::endl;
     
+    // GPT-2 pre-tokenization: contractions, space-prefixed runs, whitespace
+    // runs that leave their last character to the next word
+    auto pieces = BPETokenizer::pre_tokenize("I'm   fine\n\nOK 123!! they're");
+    assert((pieces == std::vector<std::string_view>{"I", "'m", "  ", " fine", "\n", "\n", "OK", " 123", "!!", " they", "'re"}));
+    
     auto tokenizer = std::make_shared<BPETokenizer>(1000);
     
     // Train on a small corpus
@@ -165,6 +205,8 @@ void test_bpe_tokenizer() {
     };
     
     tokenizer->train(corpus);
+    assert(tokenizer->merge_count() > 0);
+    assert(tokenizer->vocabulary_size() == 256 + tokenizer->merge_count());
     
     std::string text = "Hello world test";
     auto tokens = tokenizer->tokenize(text);
@@ -176,21 +218,217 @@ void test_bpe_tokenizer() {
     assert(!encoded.empty());
     assert(count > 0);
     assert(count == static_cast<int>(tokens.size()));
+    assert(count < static_cast<int>(text.size()));
     (void)count; // Suppress unused variable warning
     
-    // Test save/load vocabulary
-    tokenizer->save_vocabulary("test_vocab.txt");
+    // Byte-level: any bytes round-trip exactly
+    std::string binary = "caf\xc3\xa9\t\x01 \xff\n  the lazy dog";
+    assert(tokenizer->decode(tokenizer->encode(binary)) == binary);
+    assert(decoded == text);
+    
+    // Test save/load of vocab.json and merges.txt
+    tokenizer->save_vocabulary("test_vocab.json", "test_merges.txt");
     
     auto new_tokenizer = std::make_shared<BPETokenizer>();
-    new_tokenizer->load_vocabulary("test_vocab.txt");
+    new_tokenizer->load_vocabulary("test_vocab.json", "test_merges.txt");
+    assert(new_tokenizer->encode(text) == encoded);
+    assert(new_tokenizer->encode(binary) == tokenizer->encode(binary));
+    
+    // Hand-written files in the GPT-2 format ("\u0120" / "Ġ" is the space byte);
+    // merges apply by rank, not by length
+    {
+        std::ofstream vocab_file("test_vocab.json");
+        vocab_file << "{\"h\": 0, \"e\": 1, \"l\": 2, \"o\": 3, \"\\u0120\": 4, \"w\": 5, \"r\": 6, \"d\": 7,"
+                      " \"he\": 8, \"ll\": 9, \"hell\": 10, \"hello\": 11, \"\\u0120w\": 12, \"\\u0120wo\": 13}";
+        std::ofstream merges_file("test_merges.txt");
+        merges_file << "#version: 0.2\nh e\nl l\nhe ll\nhell o\n\xc4\xa0 w\n\xc4\xa0w o\n";
+    }
+    BPETokenizer gpt2_style;
+    gpt2_style.load_vocabulary("test_vocab.json", "test_merges.txt");
+    assert((gpt2_style.tokenize("hello world") == std::vector<std::string>{"hello", " wo", "r", "l", "d"}));
+    assert((gpt2_style.encode("hello world") == std::vector<int>{11, 13, 6, 2, 7}));
+    
+    bool threw = false;
+    try {
+        gpt2_style.load_vocabulary("missing_vocab.json", "test_merges.txt");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    (void)threw;
     
-    auto new_tokens = new_tokenizer->tokenize(text);
-    // The new tokenizer should produce some tokens (may not be identical due to vocabulary differences)
-    assert(!new_tokens.empty());
+    std::remove("test_vocab.json");
+    std::remove("test_merges.txt");
     
     std::cout << "✅ BPETokenizer test passed!" << std::endl;
 }
 
+// Word soup for the BPE benchmark
+std::string generate_bpe_text(size_t size) {
+    const std::vector<std::string> words = {
+        "document", "processing", "system", "performance", "optimization", "chunking", "tokenization",
+        "metadata", "analysis", "quality", "the", "of", "and", "to", "in", "is", "that", "for", "with", "on"
+    };
+    std::mt19937 rng(42);
+    std::string text;
+    text.reserve(size + 32);
+    while (text.size() < size) {
+        text += words[rng() % words.size()];
+        text += (rng() % 12 == 0) ? ". " : " ";
+    }
+    text.resize(size);
+    return text;
+}
+
+// The BPE encoder before merge ranks: 2-character vocabulary pairs found by
+// SIMD, then a scan of every found position for each output token
+std::vector<std::string> legacy_bpe_encode(const std::string& text, const std::vector<std::string>& pairs,
+                                           const std::unordered_set<std::string>& vocab) {
+    auto positions = SIMDUtils::find_bpe_pairs_simd(text, pairs);
+    std::sort(positions.begin(), positions.end(), std::greater<size_t>());
+    
+    std::vector<std::string> tokens;
+    for (size_t i = 0; i < text.size(); ++i) {
+        bool merged = false;
+        for (size_t pos : positions) {
+            if (pos == i && pos + 1 < text.size() && vocab.count(text.substr(pos, 2))) {
+                tokens.push_back(text.substr(pos, 2));
+                ++i;
+                merged = true;
+                break;
+            }
+        }
+        if (!merged) {
+            tokens.push_back(std::string(1, text[i]));
+        }
+    }
+    return tokens;
+}
+
+void benchmark_bpe_tokenizer() {
+    std::cout << "Benchmarking BPETokenizer (pair scan vs merge ranks)..." << std::endl;
+    
+    const size_t vocab_size = 2000;
+    std::vector<std::string> corpus = {generate_bpe_text(256 * 1024)};
+    
+    auto train_start = std::chrono::high_resolution_clock::now();
+    BPETokenizer tokenizer(vocab_size);
+    tokenizer.train(corpus);
+    auto train_end = std::chrono::high_resolution_clock::now();
+    std::cout << "🔍 Trained on 256KB: " << tokenizer.vocabulary_size() << " tokens, " << tokenizer.merge_count()
+              << " merges in " << std::fixed << std::setprecision(2)
+              << std::chrono::duration<double, std::milli>(train_end - train_start).count() << " ms\n";
+    
+    // The old vocabulary: the most frequent adjacent character pairs
+    std::unordered_map<std::string, size_t> pair_frequencies;
+    for (size_t i = 0; i + 1 < corpus[0].size(); ++i) {
+        ++pair_frequencies[corpus[0].substr(i, 2)];
+    }
+    std::vector<std::pair<std::string, size_t>> ranked_pairs(pair_frequencies.begin(), pair_frequencies.end());
+    std::sort(ranked_pairs.begin(), ranked_pairs.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    ranked_pairs.resize(std::min(ranked_pairs.size(), vocab_size - 128));
+    std::vector<std::string> legacy_pairs;
+    std::unordered_set<std::string> legacy_vocab;
+    for (const auto& [pair, frequency] : ranked_pairs) {
+        legacy_pairs.push_back(pair);
+        legacy_vocab.insert(pair);
+    }
+    
+    std::vector<size_t> sizes_kb = {16, 64, 1024, 10240};
+    for (size_t size_kb : sizes_kb) {
+        std::string text = generate_bpe_text(size_kb * 1024);
+        double mb = text.size() / 1048576.0;
+        
+        auto start = std::chrono::high_resolution_clock::now();
+        auto ids = tokenizer.encode(text);
+        auto end = std::chrono::high_resolution_clock::now();
+        double bpe_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        bool round_trip = tokenizer.decode(ids) == text;
+        assert(round_trip);
+        
+        std::cout << "🔍 " << std::setw(5) << size_kb << "KB -> " << ids.size() << " tokens ("
+                  << std::setprecision(2) << static_cast<double>(text.size()) / ids.size() << " bytes/token, "
+                  << (round_trip ? "lossless" : "LOSSY") << ")\n";
+        std::cout << "    Merge ranks: " << bpe_ms << " ms (" << mb / (bpe_ms / 1000.0) << " MB/s)\n";
+        
+        // The position scan is quadratic; compare it on the small inputs only
+        if (size_kb <= 64) {
+            auto legacy_start = std::chrono::high_resolution_clock::now();
+            auto legacy_tokens = legacy_bpe_encode(text, legacy_pairs, legacy_vocab);
+            auto legacy_end = std::chrono::high_resolution_clock::now();
+            double legacy_ms = std::chrono::duration<double, std::milli>(legacy_end - legacy_start).count();
+            std::cout << "    Pair scan (before): " << legacy_ms << " ms (" << mb / (legacy_ms / 1000.0) << " MB/s, "
+                      << legacy_tokens.size() << " tokens)\n";
+            if (bpe_ms > 0.0) {
+                std::cout << "    Speedup: " << (legacy_ms / bpe_ms) << "x\n";
+            }
+        }
+    }
+}
+
+void test_token_spans() {
+    std::cout << "Testing token offset spans..." << std::endl;
+    
+    std::string text = "Hello,  world!\nThis is\ta test (of spans). Don't re-join it: caf\xc3\xa9 42.";
+    auto span_text = [&text](const TokenSpan& span) { return text.substr(span.begin, span.end - span.begin); };
+    (void)span_text;
+    
+    // Spans select exactly the tokens tokenize() returns
+    BasicTokenizer basic(8192);
+    auto basic_tokens = basic.tokenize(text);
+    auto basic_spans = basic.token_spans(text);
+    assert(basic_spans.size() == basic_tokens.size());
+    for (size_t i = 0; i < basic_spans.size(); ++i) {
+        assert(span_text(basic_spans[i]) == basic_tokens[i]);
+        assert(i == 0 || basic_spans[i].begin >= basic_spans[i - 1].end);
+    }
+    assert(basic_spans.front() == (TokenSpan{0, 5}));
+    
+    // Sentence spans cover the raw words the (cleaned) tokens came from;
+    // sentence marks are extra tokens without bytes of their own
+    SentenceTokenizer sentence;
+    auto sentence_tokens = sentence.tokenize(text);
+    auto sentence_spans = sentence.token_spans(text);
+    assert(sentence_spans.size() == sentence_tokens.size());
+    for (size_t i = 0; i < sentence_spans.size(); ++i) {
+        const auto& span = sentence_spans[i];
+        assert(TextProcessing::clean_text(span_text(span)) == sentence_tokens[i] ||
+               (span.begin == span.end && text[span.end - 1] == sentence_tokens[i][0]));
+        assert(i == 0 || span.begin >= sentence_spans[i - 1].end);
+        (void)span;
+    }
+    
+    // Simple tokens are whitespace-separated words, spanning the raw word
+    SimpleTokenizer simple;
+    auto simple_spans = simple.token_spans(text);
+    assert(simple_spans.size() == simple.count_tokens(text));
+    assert(span_text(simple_spans[0]) == "Hello,");
+    assert(span_text(simple_spans.back()) == "42.");
+    
+    // Byte-level BPE spans tile the text: every byte belongs to one token
+    BPETokenizer bpe(400);
+    bpe.train({text, "the test of spans and the tokens of the test"});
+    auto ids = bpe.encode(text);
+    auto bpe_spans = bpe.token_spans(text);
+    assert(bpe_spans.size() == ids.size());
+    assert(bpe_spans.size() == bpe.count_tokens(std::string_view(text)));
+    size_t offset = 0;
+    for (size_t i = 0; i < bpe_spans.size(); ++i) {
+        assert(bpe_spans[i].begin == offset);
+        assert(span_text(bpe_spans[i]) == bpe.decode({ids[i]}));
+        offset = bpe_spans[i].end;
+    }
+    assert(offset == text.size());
+    (void)offset;
+    
+    // Spans are not capped like tokenize() is
+    BasicTokenizer capped(3);
+    assert(capped.tokenize(text).size() == 3);
+    assert(capped.token_spans(text).size() == basic.token_spans(text).size());
+    
+    std::cout << "✅ Token span test passed!" << std::endl;
+}
+
 void test_tokenizer_factory() {
     std::cout << "Testing TokenizerFactory..." << std::endl;
     
@@ -212,6 +450,55 @@ void test_tokenizer_factory() {
     assert(config_sentence != nullptr);
     assert(config_bpe != nullptr);
     
+    // Pipeline config keys; BasicTokenizer is the default
+    auto config_basic = TokenizerFactory::create_from_config(std::unordered_map<std::string, std::string>{
+        {"chunking.tokenizer.max_tokens", "100"}});
+    assert(dynamic_cast<BasicTokenizer*>(config_basic.get()) != nullptr);
+    assert(config_basic->get_max_tokens() == 100);
+    
+    // A BPE tokenizer loaded from vocab.json / merges.txt counts exactly, also
+    // on the string_view path the chunker uses
+    BPETokenizer trained(400);
+    trained.train({"the quick brown fox jumps over the lazy dog", "the lazy dog sleeps"});
+    trained.save_vocabulary("test_factory_vocab.json", "test_factory_merges.txt");
+    auto config_trained = TokenizerFactory::create_from_config(std::unordered_map<std::string, std::string>{
+        {"chunking.tokenizer.type", "bpe"},
+        {"chunking.tokenizer.vocab_file", "test_factory_vocab.json"},
+        {"chunking.tokenizer.merges_file", "test_factory_merges.txt"}});
+    std::string text = "the lazy fox, jumping over  the quick dog!";
+    assert(config_trained->count_tokens(text) == trained.encode(text).size());
+    assert(config_trained->count_tokens(std::string_view(text)) == trained.encode(text).size());
+    std::remove("test_factory_vocab.json");
+    std::remove("test_factory_merges.txt");
+    
+    // Unknown types and missing or half BPE vocabularies are rejected
+    bool threw = false;
+    try {
+        TokenizerFactory::create_from_config("sentencepiece");
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    threw = false;
+    try {
+        TokenizerFactory::create_from_config(std::unordered_map<std::string, std::string>{
+            {"chunking.tokenizer.type", "bpe"}, {"chunking.tokenizer.vocab_file", "vocab.json"}});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    // A configured BPE without its model is an error, not a byte-level tokenizer
+    threw = false;
+    try {
+        TokenizerFactory::create_from_config(std::unordered_map<std::string, std::string>{
+            {"chunking.tokenizer.type", "bpe"}});
+    } catch (const std::invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    (void)threw;
+    
     std::cout << "✅ TokenizerFactory test passed!" << std::endl;
 }
 
@@ -251,6 +538,8 @@ int main() {
         test_simple_tokenizer();
         test_sentence_tokenizer();
         test_bpe_tokenizer();
+        benchmark_bpe_tokenizer();
+        test_token_spans();
         test_tokenizer_factory();
         test_advanced_tokenizer_integration();
 
@@ -1,8 +1,10 @@
 #include <iostream>
 #include <cassert>
 #include <memory>
+#include <random>
 #include <vector>
 #include <string>
+#include <thread>
 #include <unordered_map>
 
 #include "r3m/chunking/advanced_chunker.hpp"
@@ -10,6 +12,12 @@
 #include "r3m/chunking/metadata_processor.hpp"
 #include "r3m/chunking/chunk_models.hpp"
 #include "r3m/chunking/section_processing/section_processor.hpp"
+#include "r3m/chunking/multipass_chunker.hpp"
+#include "r3m/chunking/advanced_tokenizer.hpp"
+#include "r3m/chunking/token_management/shared_token_cache.hpp"
+#include "r3m/chunking/token_management/token_cache.hpp"
+#include "r3m/utils/text_processing.hpp"
+#include <unordered_set>
 
 using namespace r3m::chunking;
 
@@ -150,6 +158,170 @@ void test_token_management() {
     std::cout << "✅ Token management test passed!" << std::endl;
 }
 
+void test_shared_token_cache() {
+    std::cout << "Testing shared token-count cache..." << std::endl;
+    using token_management::SharedTokenCache;
+
+    // Counts are keyed per tokenizer: the same text never returns another
+    // tokenizer's count, and retraining a tokenizer invalidates its counts
+    SharedTokenCache cache(SharedTokenCache::SHARD_COUNT * 4);
+    BasicTokenizer basic(8192);
+    BPETokenizer bpe(300);
+    std::string text = "Shared caches count boilerplate once, e.g. headers and footers.";
+    assert(cache.get_token_count(basic, text) == static_cast<int>(basic.count_tokens(text)));
+    assert(cache.get_token_count(bpe, text) == static_cast<int>(bpe.count_tokens(text)));
+    assert(cache.get_token_count(basic, text) == static_cast<int>(basic.count_tokens(text)));
+    assert(cache.stats().hits == 1 && cache.stats().misses == 2);
+    bpe.train({text, text});
+    assert(cache.get_token_count(bpe, text) == static_cast<int>(bpe.count_tokens(text)));
+    assert(cache.stats().misses == 3);
+
+    // Bounded: CLOCK evicts once every shard is full
+    for (int i = 0; i < 2000; ++i) {
+        std::string line = "line " + std::to_string(i) + " of a long log";
+        assert(cache.get_token_count(basic, line) == 6);
+    }
+    auto bounded = cache.stats();
+    assert(bounded.entries <= bounded.capacity);
+    assert(bounded.evictions > 0);
+    (void)bounded;
+
+    // Clearing one tokenizer's counts keeps every other tokenizer's
+    BasicTokenizer other(8192);
+    std::string other_text = "Counts of another tokenizer stay cached.";
+    cache.get_token_count(other, other_text);
+    cache.clear(basic);
+    auto cleared = cache.stats();
+    assert(cleared.entries > 0);
+    assert(cache.get_token_count(other, other_text) == static_cast<int>(other.count_tokens(other_text)));
+    assert(cache.stats().hits == cleared.hits + 1);
+    assert(cache.get_token_count(basic, text) == static_cast<int>(basic.count_tokens(text)));
+    assert(cache.stats().misses == cleared.misses + 1);
+    for (int i = 0; i < 2000; ++i) {
+        std::string line = "line " + std::to_string(i) + " of a long log";
+        assert(cache.get_token_count(basic, line) == 6);
+    }
+    assert(cache.stats().entries <= cache.stats().capacity);
+    (void)cleared;
+
+    // Safe to share between threads; every thread sees exact counts
+    SharedTokenCache shared(1024);
+    std::vector<std::string> texts;
+    for (int i = 0; i < 256; ++i) {
+        texts.push_back(std::string(static_cast<size_t>(i % 7), '#') + " Section " + std::to_string(i) + " footer, page " +
+                        std::to_string(i % 13));
+    }
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(8, 0);
+    for (size_t t = 0; t < mismatches.size(); ++t) {
+        threads.emplace_back([&, t]() {
+            for (int round = 0; round < 200; ++round) {
+                for (size_t i = t; i < texts.size(); i += 3) {
+                    if (shared.get_token_count(basic, texts[i]) != static_cast<int>(basic.count_tokens(texts[i]))) {
+                        mismatches[t]++;
+                    }
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int mismatch : mismatches) {
+        assert(mismatch == 0);
+        (void)mismatch;
+    }
+    assert(shared.stats().hit_rate() > 0.9);
+
+    // Chunkers share the process-wide cache: a second document with the same
+    // title and metadata counts them from the cache
+    auto tokenizer = std::make_shared<BasicTokenizer>(8192);
+    AdvancedChunker::Config config;
+    config.include_metadata = true;
+    config.enable_contextual_rag = false;
+    AdvancedChunker first_chunker(tokenizer, config);
+    AdvancedChunker second_chunker(tokenizer, config);
+
+    AdvancedChunker::DocumentInfo doc;
+    doc.title = "Quarterly Operations Report";
+    doc.source_type = "file";
+    doc.metadata["department"] = "Operations";
+    doc.metadata["confidentiality"] = "internal";
+    doc.sections.push_back(section_processing::DocumentSection(
+        "Revenue grew steadily across all regions while operating costs remained flat for the quarter. "
+        "Hiring in Berlin, Austin and Singapore added 42 engineers; churn fell to 3% after the support "
+        "rework. Next quarter focuses on warehouse automation, supplier audits and a new billing system.", "link"));
+
+    first_chunker.process_document(doc);
+    auto before = first_chunker.get_token_cache_stats();
+    auto second_result = second_chunker.process_document(doc);
+    auto after = second_chunker.get_token_cache_stats();
+    assert(after.hits >= before.hits + 3); // Title prefix, metadata suffix, section
+    assert(after.misses == before.misses);
+    (void)before;
+    (void)after;
+    
+    // Chunks carry the document's title and metadata counts
+    assert(!second_result.chunks.empty());
+    for (const auto& chunk : second_result.chunks) {
+        assert(chunk.title_tokens == static_cast<int>(tokenizer->count_tokens(chunk.title_prefix.view())));
+        assert(chunk.metadata_tokens == static_cast<int>(tokenizer->count_tokens(chunk.metadata_suffix_semantic.view())));
+        (void)chunk;
+    }
+
+    std::cout << "✅ Shared token-count cache test passed! (" << shared.stats().hits << " hits, hit rate "
+              << shared.stats().hit_rate() << ")" << std::endl;
+}
+
+void test_optimized_token_cache_fuzz() {
+    std::cout << "Testing OptimizedTokenCache key stability (1M inserts)..." << std::endl;
+
+    // Random texts, mostly short enough for the small-string buffer (whose
+    // bytes move when a std::string moves), counted through views of a
+    // temporary that is overwritten right after. Under -DR3M_ENABLE_ASAN=ON a
+    // dangling key would be reported by the first lookup comparing against it.
+    auto tokenizer = std::make_shared<BasicTokenizer>(8192);
+    token_management::OptimizedTokenCache cache(tokenizer);
+
+    std::mt19937_64 rng(20240817);
+    const std::string alphabet = "abcdefgh ijklmnop.,;:!?\n\t0123456789";
+    std::string text;
+    std::vector<std::pair<std::string, int>> samples;
+    const size_t insert_count = 1000000;
+
+    for (size_t i = 0; i < insert_count; ++i) {
+        size_t length = (i % 16 == 0) ? rng() % 200 : rng() % 16;
+        text.clear();
+        for (size_t j = 0; j < length; ++j) {
+            text += alphabet[rng() % alphabet.size()];
+        }
+        int count = cache.get_token_count(text);
+        assert(count == static_cast<int>(tokenizer->count_tokens(text)));
+        if (i % 997 == 0) {
+            samples.emplace_back(text, count);
+        }
+        text.assign(length, '#'); // Clobber the caller's bytes
+    }
+
+    // Early keys are still intact: looking them up again hits, with the
+    // count stored when they were inserted
+    size_t size_before = cache.size();
+    for (const auto& sample : samples) {
+        assert(cache.get_token_count(sample.first) == sample.second);
+        (void)sample;
+    }
+    assert(cache.size() == size_before);
+    assert(cache.key_bytes() > 0);
+    (void)size_before;
+
+    cache.clear();
+    assert(cache.size() == 0 && cache.key_bytes() == 0);
+    assert(cache.get_token_count("fresh start") == 2);
+
+    std::cout << "✅ OptimizedTokenCache fuzz test passed! (" << insert_count << " inserts, " << samples.size()
+              << " keys re-checked)" << std::endl;
+}
+
 // ============================================================================
 // SECTION PROCESSING TESTS
 // ============================================================================
@@ -287,6 +459,68 @@ void test_oversized_chunk_handling() {
     std::cout << "✅ Oversized chunk handling test passed!" << std::endl;
 }
 
+void test_oversized_split_preserves_text() {
+    std::cout << "Testing oversized section split at token offsets..." << std::endl;
+
+    auto tokenizer = std::make_shared<BasicTokenizer>(8192);
+    AdvancedChunker::Config config;
+    config.chunk_token_limit = 40;
+    config.enable_multipass = false;
+    config.enable_contextual_rag = false;
+
+    AdvancedChunker chunker(tokenizer, config);
+
+    AdvancedChunker::DocumentInfo doc;
+    doc.document_id = "test_doc_spans";
+    doc.title = "Span Split Test";
+    doc.semantic_identifier = "test_doc_spans";
+    doc.source_type = "file";
+
+    std::string section_text =
+        "Installation starts by reading the configuration (e.g. config.yaml), then calling init();\n"
+        "the loader validates every field before any worker thread is started.\n"
+        "Network settings describe ports, hostnames and TLS certificates; storage settings choose "
+        "where indexes, caches and temporary files live on disk.\n"
+        "Chunking parameters control token limits, overlap between neighbouring chunks, and whether "
+        "multipass indexing builds larger context windows.\n"
+        "Logging can write structured JSON records, rotate files daily, and forward errors to a collector.\n"
+        "Finally, the server exposes health checks at /health and metrics at /metrics for monitoring.";
+    doc.sections.push_back(section_processing::DocumentSection(section_text, "https://example.com/spans"));
+
+    auto result = chunker.process_document(doc);
+    assert(result.chunks.size() > 1);
+
+    // Chunks are consecutive slices of the cleaned section: punctuation stays
+    // attached and line breaks survive, unlike tokens re-joined with spaces
+    std::string cleaned = r3m::utils::TextProcessing::clean_text(section_text);
+    size_t cursor = 0;
+    for (const auto& chunk : result.chunks) {
+        assert(chunk.content.buffer() == result.chunks.front().content.buffer());
+        size_t pos = cleaned.find(chunk.content.view(), cursor);
+        assert(pos != std::string::npos);
+        assert(cleaned.find_first_not_of(" \t\n", cursor) == pos);
+        assert(static_cast<int>(tokenizer->count_tokens(chunk.content.view())) <= config.chunk_token_limit);
+        cursor = pos + chunk.content.size();
+        (void)pos;
+    }
+    assert(cleaned.find_first_not_of(" \t\n", cursor) == std::string::npos);
+    assert(result.chunks.front().content.view().find("(e.g. config.yaml), then calling init();\n") != std::string_view::npos);
+
+    // Text with bytes that cleaning drops is chunked from a cleaned copy
+    assert(r3m::utils::TextProcessing::is_clean_text(section_text));
+    std::string dirty_text = section_text;
+    dirty_text.insert(dirty_text.find("Logging"), "\x01\x02");
+    assert(!r3m::utils::TextProcessing::is_clean_text(dirty_text));
+    doc.sections = {section_processing::DocumentSection(dirty_text, "https://example.com/spans")};
+    auto dirty_result = chunker.process_document(doc);
+    assert(dirty_result.chunks.size() == result.chunks.size());
+    for (size_t i = 0; i < dirty_result.chunks.size(); ++i) {
+        assert(dirty_result.chunks[i].content == result.chunks[i].content.view());
+    }
+
+    std::cout << "✅ Oversized section split test passed!" << std::endl;
+}
+
 void test_advanced_strict_token_limit() {
     std::cout << "Testing advanced strict token limit enforcement..." << std::endl;
     
@@ -583,6 +817,59 @@ void test_advanced_link_offset_tracking() {
     
     assert(found_links);
     (void)found_links; // Suppress unused variable warning
+    
+    // Many small sections: each offset is the cleaned length of the chunk
+    // text before its section
+    std::vector<section_processing::DocumentSection> small_sections;
+    for (int i = 0; i < 400; ++i) {
+        std::string text = "Section #" + std::to_string(i) + ": \\\"quoted\\\" *bold*, `code` - end.";
+        if (i % 3 == 0) {
+            text += " Trailing backslash \\";
+        }
+        small_sections.emplace_back(text, "link_" + std::to_string(i));
+    }
+    
+    section_processing::SectionProcessor processor(tokenizer);
+    section_processing::TokenManagementResult token_result;
+    token_result.content_token_limit = 100;
+    auto small_chunks = processor.process_sections_with_combinations(
+        small_sections, token_result, "many_links_doc", "file", "many_links_001", false);
+    
+    size_t checked_links = 0;
+    for (const auto& chunk : small_chunks) {
+        const std::string content = chunk.content.str();
+        for (const auto& [offset, link] : chunk.source_links) {
+            const auto& section = small_sections[std::stoi(link.substr(5))];
+            size_t pos = content.find(section.content);
+            assert(pos != std::string::npos);
+            assert(static_cast<size_t>(offset) ==
+                   r3m::utils::TextProcessing::shared_precompare_cleanup(content.substr(0, pos)).length());
+            (void)pos;
+            ++checked_links;
+        }
+    }
+    assert(small_chunks.size() > 1);
+    assert(checked_links == small_sections.size());
+    (void)checked_links;
+
+    // The same sections as offsets into one document text chunk identically
+    std::string document_text;
+    std::vector<section_processing::DocumentSection> sliced_sections;
+    for (const auto& section : small_sections) {
+        section_processing::DocumentSection sliced;
+        sliced.offset = document_text.size();
+        sliced.length = section.content.size();
+        sliced.link = section.link;
+        sliced_sections.push_back(std::move(sliced));
+        document_text += section.content;
+    }
+    auto sliced_chunks = processor.process_sections_with_combinations(
+        sliced_sections, token_result, "many_links_doc", "file", "many_links_001", false, document_text);
+    assert(sliced_chunks.size() == small_chunks.size());
+    for (size_t i = 0; i < sliced_chunks.size(); ++i) {
+        assert(sliced_chunks[i].content == small_chunks[i].content.view());
+        assert(sliced_chunks[i].source_links == small_chunks[i].source_links);
+    }
     std::cout << "✅ Link offset tracking test passed!" << std::endl;
 }
 
@@ -640,6 +927,78 @@ void test_multipass_indexing() {
     std::cout << "✅ Multipass indexing test passed!" << std::endl;
 }
 
+void test_shared_chunk_storage() {
+    std::cout << "Testing shared chunk storage..." << std::endl;
+
+    auto tokenizer = std::make_shared<BasicTokenizer>(8192);
+    MultipassChunker chunker(tokenizer, true, true, 150, 4, 2048);
+
+    std::string content;
+    for (int i = 0; content.size() < 1024 * 1024; ++i) {
+        content += "Sentence " + std::to_string(i) + " describes shared buffers, reference counts and chunk spans. ";
+    }
+    std::unordered_map<std::string, std::string> metadata = {
+        {"author", "Storage Team"}, {"category", "memory"}, {"source", "benchmark corpus"}
+    };
+
+    auto result = chunker.chunk_document("shared_doc", content, "Shared Storage Document", metadata);
+    assert(result.chunks.size() > 100);
+
+    // Every chunk points at the same title and metadata buffers
+    const auto& first = result.chunks.front();
+    for (const auto& chunk : result.chunks) {
+        assert(chunk.title_prefix.buffer() == first.title_prefix.buffer());
+        assert(chunk.metadata_suffix_semantic.buffer() == first.metadata_suffix_semantic.buffer());
+        (void)chunk;
+    }
+
+    // Bytes held through distinct buffers vs. bytes if every field were an owned copy
+    std::unordered_set<const std::string*> buffers;
+    std::unordered_set<const void*> lists;
+    size_t retained_bytes = 0;
+    size_t materialized_bytes = 0;
+    auto account = [&](const SharedText& text) {
+        materialized_bytes += text.size();
+        if (text.buffer() && buffers.insert(text.buffer().get()).second) {
+            retained_bytes += text.buffer()->size();
+        }
+    };
+    for (const auto& chunk : result.chunks) {
+        account(chunk.content);
+        account(chunk.blurb);
+        account(chunk.title_prefix);
+        account(chunk.metadata_suffix_semantic);
+        account(chunk.metadata_suffix_keyword);
+        for (const auto& mini_text : chunk.mini_chunk_texts) {
+            account(mini_text);
+        }
+        if (chunk.mini_chunk_texts.items() && lists.insert(chunk.mini_chunk_texts.items().get()).second) {
+            retained_bytes += chunk.mini_chunk_texts.size() * sizeof(SharedText);
+        }
+    }
+
+    // Mini chunks and regular chunks slice the same document buffer
+    size_t sliced = 0;
+    for (const auto& chunk : result.chunks) {
+        if (chunk.content.buffer() == first.content.buffer()) sliced++;
+    }
+    assert(sliced > result.chunks.size() / 2);
+    (void)sliced;
+
+    double ratio = static_cast<double>(materialized_bytes) / static_cast<double>(retained_bytes);
+    std::cout << "  " << result.chunks.size() << " chunks: " << retained_bytes / 1024 << "KB shared vs "
+              << materialized_bytes / 1024 << "KB as owned copies (" << ratio << "x)" << std::endl;
+    // Large chunks still own their "\n\n"-joined text, the rest is shared
+    assert(ratio >= 5.0);
+    (void)ratio;
+
+    // Serialization materializes the same text
+    assert(first.get_full_content() == first.title_prefix.str() + first.content.str() +
+                                       first.metadata_suffix_keyword.str());
+
+    std::cout << "✅ Shared chunk storage test passed!" << std::endl;
+}
+
 void test_contextual_rag() {
     std::cout << "Testing contextual RAG..." << std::endl;
 
@@ -729,6 +1088,92 @@ void test_advanced_contextual_rag() {
 // QUALITY AND BATCH PROCESSING TESTS
 // ============================================================================
 
+void test_streaming_chunker() {
+    std::cout << "Testing streaming chunker..." << std::endl;
+
+    auto tokenizer = std::make_shared<BasicTokenizer>(8192);
+    AdvancedChunker::Config config;
+    config.chunk_token_limit = 128;
+    config.enable_multipass = false;
+    config.enable_contextual_rag = false;
+
+    AdvancedChunker::DocumentInfo doc;
+    doc.document_id = "test_doc_stream";
+    doc.title = "Streaming Test";
+    doc.semantic_identifier = "test_doc_stream";
+    doc.source_type = "file";
+
+    std::vector<section_processing::DocumentSection> blocks;
+    for (int i = 0; i < 60; ++i) {
+        std::string text = "Block " + std::to_string(i) + " discusses streaming ingestion of large logs. ";
+        for (int j = 0; j < (i % 7) + 1; ++j) {
+            text += "Each sentence adds information about chunk boundaries and memory bounds. ";
+        }
+        blocks.emplace_back(text, "https://example.com/stream_" + std::to_string(i));
+    }
+
+    // Batch reference over the same sections
+    AdvancedChunker batch_chunker(tokenizer, config);
+    doc.sections = blocks;
+    auto batch = batch_chunker.process_document(doc);
+    doc.sections.clear();
+
+    AdvancedChunker stream_chunker(tokenizer, config);
+    size_t next = 0;
+    size_t pulled_at_first_chunk = 0;
+    std::vector<DocumentChunk> streamed;
+    auto result = stream_chunker.process_document_stream(
+        doc,
+        [&](section_processing::DocumentSection& block) {
+            if (next == blocks.size()) return false;
+            block = blocks[next++];
+            return true;
+        },
+        [&](DocumentChunk&& chunk) {
+            if (streamed.empty()) pulled_at_first_chunk = next;
+            streamed.push_back(std::move(chunk));
+        });
+
+    // Chunks arrive while the source is still being read
+    assert(pulled_at_first_chunk < blocks.size());
+    assert(result.chunks.empty());
+    assert(result.total_chunks == streamed.size());
+    assert(streamed.size() == batch.chunks.size());
+    for (size_t i = 0; i < streamed.size(); ++i) {
+        assert(streamed[i].content == batch.chunks[i].content);
+        assert(streamed[i].chunk_id == batch.chunks[i].chunk_id);
+        assert(streamed[i].source_links == batch.chunks[i].source_links);
+    }
+    (void)pulled_at_first_chunk;
+
+    // Multipass: large chunks are built from completed windows as they fill
+    config.enable_multipass = true;
+    AdvancedChunker multipass_chunker(tokenizer, config);
+    next = 0;
+    size_t large_chunks = 0;
+    size_t regular_chunks = 0;
+    multipass_chunker.process_document_stream(
+        doc,
+        [&](section_processing::DocumentSection& block) {
+            if (next == blocks.size()) return false;
+            block = blocks[next++];
+            return true;
+        },
+        [&](DocumentChunk&& chunk) {
+            if (chunk.large_chunk_id >= 0 && !chunk.large_chunk_reference_ids.empty()) {
+                ++large_chunks;
+            } else {
+                ++regular_chunks;
+            }
+        });
+    assert(regular_chunks == streamed.size());
+    assert(large_chunks > 0);
+    (void)large_chunks;
+    (void)regular_chunks;
+
+    std::cout << "✅ Streaming chunker test passed!" << std::endl;
+}
+
 void test_quality_filtering() {
     std::cout << "Testing quality filtering..." << std::endl;
 
@@ -881,6 +1326,8 @@ int main() {
         test_metadata_processing();
         test_title_and_metadata_token_management();
         test_token_management();
+        test_shared_token_cache();
+        test_optimized_token_cache_fuzz();
         
         // Section Processing Tests
         test_section_processing_with_continuation();
@@ -888,6 +1335,7 @@ int main() {
         
         // Chunk Handling Tests
         test_oversized_chunk_handling();
+        test_oversized_split_preserves_text();
         test_advanced_strict_token_limit();
         test_token_limit_enforcement();
         
@@ -904,8 +1352,10 @@ int main() {
         
         // Multipass and Contextual RAG Tests
         test_multipass_indexing();
+        test_shared_chunk_storage();
         test_contextual_rag();
         test_advanced_contextual_rag();
+        test_streaming_chunker();
         
         // Quality and Batch Processing Tests
         test_quality_filtering();
@@ -1,13 +1,28 @@
 #include <iostream>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <memory>
+#include <set>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
+#include "r3m/core/config_manager.hpp"
 #include "r3m/core/document_processor.hpp"
 #include "r3m/chunking/advanced_chunker.hpp"
 #include "r3m/chunking/tokenizer.hpp"
+#include "r3m/chunking/advanced_tokenizer.hpp"
+#include "r3m/utils/mapped_file.hpp"
+#include "r3m/formats/html_text_extractor.hpp"
+#include "r3m/formats/section_splitter.hpp"
+#include "r3m/quality/assessor.hpp"
+#include "r3m/utils/text_utils.hpp"
+#include "r3m/utils/hash.hpp"
+#include "r3m/utils/hyperloglog.hpp"
 
 void test_document_processor_chunking_integration() {
     std::cout << "Testing DocumentProcessor + AdvancedChunker integration..." << std::endl;
@@ -248,6 +263,846 @@ void test_chunking_disabled() {
     std::cout << "✅ Chunking disabled test passed!" << std::endl;
 }
 
+void test_process_document_from_memory() {
+    std::cout << "Testing in-memory document processing..." << std::endl;
+    
+    auto processor = std::make_unique<r3m::core::DocumentProcessor>();
+    
+    std::unordered_map<std::string, std::string> config;
+    config["document_processing.enable_chunking"] = "true";
+    config["chunking.chunk_token_limit"] = "200";
+    
+    bool initialized = processor->initialize(config);
+    assert(initialized);
+    (void)initialized; // Suppress unused variable warning
+    
+    std::string text_content;
+    for (int i = 0; i < 40; ++i) {
+        text_content += "Paragraph " + std::to_string(i) + " explains memory based processing of uploaded documents. ";
+    }
+    std::string html_content = "<html><head><script>var x = 1;</script></head><body><p>" +
+                               text_content + "</p></body></html>";
+    
+    for (const auto& entry : std::vector<std::pair<std::string, std::string>>{
+             {"test_memory_processing.txt", text_content},
+             {"test_memory_processing.html", html_content}}) {
+        const auto& test_file = entry.first;
+        const auto& content = entry.second;
+        
+        std::ofstream file(test_file);
+        file << content;
+        file.close();
+        
+        // The buffer path must produce the same text and chunks as the file path
+        auto file_result = processor->process_document(test_file);
+        auto memory_result = processor->process_document_from_memory(test_file,
+            std::vector<uint8_t>(content.begin(), content.end()));
+        
+        assert(file_result.processing_success);
+        assert(memory_result.processing_success);
+        assert(memory_result.text_content == file_result.text_content);
+        assert(memory_result.total_chunks == file_result.total_chunks);
+        assert(memory_result.file_size == content.size());
+        assert(memory_result.metadata["file_size"] == std::to_string(content.size()));
+        assert(memory_result.text_content.find("var x") == std::string::npos);
+        
+        std::cout << "  " << test_file << ": " << memory_result.text_content.length()
+                  << " chars, " << memory_result.total_chunks << " chunks" << std::endl;
+        
+        std::filesystem::remove(test_file);
+    }
+    
+    // Empty buffers are rejected without touching the filesystem
+    auto empty_result = processor->process_document_from_memory("empty.txt", std::vector<uint8_t>{});
+    assert(!empty_result.processing_success);
+    assert(!empty_result.error_message.empty());
+    (void)empty_result;
+    
+    std::cout << "✅ In-memory processing test passed!" << std::endl;
+}
+
+void test_mapped_file_ingestion() {
+    std::cout << "Testing memory-mapped file ingestion..." << std::endl;
+    
+    // Below the threshold the file is read into an owned buffer, above it is mapped
+    std::string small_file = "test_mapped_small.log";
+    std::string large_file = "test_mapped_large.log";
+    std::string small_content = "small log line for the read() fallback\n";
+    std::string large_content;
+    while (large_content.size() < 2 * r3m::utils::MappedFile::MMAP_THRESHOLD) {
+        large_content += "2024-01-01T00:00:00Z INFO request served in 12ms path=/api/v1/items\n";
+    }
+    
+    std::ofstream(small_file) << small_content;
+    std::ofstream(large_file) << large_content;
+    
+    {
+        r3m::utils::MappedFile small(small_file);
+        r3m::utils::MappedFile large(large_file);
+        assert(!small.is_mapped());
+        assert(large.is_mapped());
+        assert(small.view() == small_content);
+        assert(large.view() == large_content);
+        
+        // Moving keeps the view valid for both storage modes
+        r3m::utils::MappedFile moved_small(std::move(small));
+        r3m::utils::MappedFile moved_large(std::move(large));
+        assert(moved_small.view() == small_content);
+        assert(moved_large.view() == large_content);
+        assert(small.size() == 0 && large.size() == 0);
+    }
+    
+    bool threw = false;
+    try {
+        r3m::utils::MappedFile missing("does_not_exist.log");
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    (void)threw;
+    
+    // Plain text extraction only copies up to max_text_length
+    auto processor = std::make_unique<r3m::core::DocumentProcessor>();
+    std::unordered_map<std::string, std::string> config;
+    config["document_processing.enable_chunking"] = "false";
+    config["document_processing.max_text_length"] = "4096";
+    bool initialized = processor->initialize(config);
+    assert(initialized);
+    (void)initialized;
+    
+    auto result = processor->process_document(large_file);
+    assert(result.processing_success);
+    assert(result.text_content.length() <= 4096);
+    assert(result.text_content.rfind("2024-01-01T00:00:00Z INFO", 0) == 0);
+    
+    std::filesystem::remove(small_file);
+    std::filesystem::remove(large_file);
+    
+    std::cout << "✅ Memory-mapped ingestion test passed!" << std::endl;
+}
+
+void test_streaming_document_processing() {
+    std::cout << "Testing streaming document processing..." << std::endl;
+    
+    // Far larger than max_text_length: the batch path truncates, streaming does not
+    std::string test_file = "test_streaming_large.log";
+    std::string content;
+    int line = 0;
+    while (content.size() < 256 * 1024) {
+        content += "2024-01-01T00:00:00Z INFO request " + std::to_string(line++) + " served in 12ms path=/api/v1/items\n";
+        if (line % 20 == 0) content += "\n";
+    }
+    content += "FINAL_MARKER end of log\n";
+    std::ofstream(test_file) << content;
+    
+    std::unordered_map<std::string, std::string> config;
+    config["document_processing.enable_chunking"] = "true";
+    config["document_processing.max_text_length"] = "16384";
+    config["chunking.chunk_token_limit"] = "512";
+    config["chunking.enable_multipass"] = "false";
+    config["chunking.enable_contextual_rag"] = "false";
+    
+    auto processor = std::make_unique<r3m::core::DocumentProcessor>();
+    bool initialized = processor->initialize(config);
+    assert(initialized);
+    (void)initialized;
+    
+    auto batch = processor->process_document(test_file);
+    assert(batch.processing_success);
+    
+    size_t chunk_count = 0;
+    size_t streamed_bytes = 0;
+    bool saw_marker = false;
+    int last_chunk_id = -1;
+    bool ordered = true;
+    auto result = processor->process_document_streaming(test_file, [&](r3m::chunking::DocumentChunk&& chunk) {
+        ordered = ordered && chunk.chunk_id == last_chunk_id + 1;
+        last_chunk_id = chunk.chunk_id;
+        streamed_bytes += chunk.content.size();
+        saw_marker = saw_marker || chunk.content.find("FINAL_MARKER") != std::string::npos;
+        ++chunk_count;
+    });
+    
+    assert(result.processing_success);
+    assert(result.chunks.empty());
+    assert(result.total_chunks == chunk_count);
+    assert(result.file_size == content.size());
+    assert(ordered);
+    assert(saw_marker);
+    assert(chunk_count > batch.total_chunks);
+    assert(streamed_bytes > 16384);
+    (void)ordered;
+    (void)saw_marker;
+    
+    // Larger than max_file_size: the batch path rejects it, streaming maps it
+    while (content.size() <= 1024 * 1024) {
+        content += content;
+    }
+    std::ofstream(test_file, std::ios::trunc) << content;
+    config["document_processing.max_file_size"] = "1MB";
+    auto capped = std::make_unique<r3m::core::DocumentProcessor>();
+    initialized = capped->initialize(config);
+    assert(initialized);
+    
+    auto rejected = capped->process_document(test_file);
+    assert(!rejected.processing_success);
+    assert(rejected.error_message.find("File too large") != std::string::npos);
+    (void)rejected;
+    
+    size_t capped_chunks = 0;
+    auto oversized = capped->process_document_streaming(test_file, [&](r3m::chunking::DocumentChunk&&) { ++capped_chunks; });
+    assert(oversized.processing_success);
+    assert(oversized.file_size == content.size());
+    assert(capped_chunks > chunk_count);
+    (void)oversized;
+    
+    std::filesystem::remove(test_file);
+    
+    std::cout << "✅ Streaming document processing test passed! (" << chunk_count
+              << " chunks streamed vs " << batch.total_chunks << " after truncation, " << capped_chunks
+              << " beyond max_file_size)" << std::endl;
+}
+
+// PDF strings hold font codes, not UTF-8. With WinAnsiEncoding the Latin-1
+// range (U+00A0..U+00FF, two-byte UTF-8 from 0xC2/0xC3) keeps its code points
+static std::string to_win_ansi(const std::string& utf8) {
+    std::string codes;
+    for (size_t i = 0; i < utf8.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(utf8[i]);
+        if ((c == 0xC2 || c == 0xC3) && i + 1 < utf8.size()) {
+            c = static_cast<unsigned char>(((c & 0x03) << 6) | (static_cast<unsigned char>(utf8[++i]) & 0x3F));
+        }
+        codes.push_back(static_cast<char>(c));
+    }
+    return codes;
+}
+
+// Minimal PDF with one line of Helvetica text per page (UTF-8, ASCII or Latin-1)
+static std::string make_test_pdf(const std::vector<std::string>& page_texts) {
+    const size_t page_count = page_texts.size();
+    std::vector<std::string> objects;
+    std::string kids;
+    for (size_t i = 0; i < page_count; ++i) {
+        kids += std::to_string(4 + 2 * i) + " 0 R ";
+    }
+    objects.push_back("<< /Type /Catalog /Pages 2 0 R >>");
+    objects.push_back("<< /Type /Pages /Kids [" + kids + "] /Count " + std::to_string(page_count) + " >>");
+    objects.push_back("<< /Type /Font /Subtype /Type1 /BaseFont /Helvetica /Encoding /WinAnsiEncoding >>");
+    for (size_t i = 0; i < page_count; ++i) {
+        std::string stream = "BT /F1 12 Tf 72 720 Td (" + to_win_ansi(page_texts[i]) + ") Tj ET";
+        objects.push_back("<< /Type /Page /Parent 2 0 R /MediaBox [0 0 612 792] /Resources << /Font << /F1 3 0 R >> >> /Contents " +
+                          std::to_string(5 + 2 * i) + " 0 R >>");
+        objects.push_back("<< /Length " + std::to_string(stream.size()) + " >>\nstream\n" + stream + "\nendstream");
+    }
+    
+    std::string pdf = "%PDF-1.4\n";
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < objects.size(); ++i) {
+        offsets.push_back(pdf.size());
+        pdf += std::to_string(i + 1) + " 0 obj\n" + objects[i] + "\nendobj\n";
+    }
+    size_t xref_offset = pdf.size();
+    pdf += "xref\n0 " + std::to_string(objects.size() + 1) + "\n0000000000 65535 f \n";
+    for (size_t offset : offsets) {
+        char entry[21];
+        std::snprintf(entry, sizeof(entry), "%010zu 00000 n \n", offset);
+        pdf += entry;
+    }
+    pdf += "trailer\n<< /Size " + std::to_string(objects.size() + 1) + " /Root 1 0 R >>\nstartxref\n" +
+           std::to_string(xref_offset) + "\n%%EOF\n";
+    return pdf;
+}
+
+void test_pdf_page_extraction() {
+    std::cout << "Testing page-parallel PDF extraction..." << std::endl;
+    
+    // Enough pages to be split into ranges on the pool
+    const size_t page_count = 40;
+    std::vector<std::string> page_texts;
+    for (size_t i = 0; i < page_count; ++i) {
+        page_texts.push_back("Page " + std::to_string(i + 1) + " marker: extraction of large reports keeps every page in order.");
+    }
+    // Non-ASCII text must reach the chunks as UTF-8, not be dropped by cleaning
+    const std::string accented = "R\xc3\xa9sum\xc3\xa9 of the na\xc3\xafve fa\xc3\xa7" "ade in Z\xc3\xbcrich, \xc2\xa9 Stra\xc3\x9f" "e.";
+    page_texts[page_count / 2] += " " + accented;
+    std::string pdf = make_test_pdf(page_texts);
+    std::string test_file = "test_pdf_pages.pdf";
+    std::ofstream(test_file, std::ios::binary) << pdf;
+    
+    std::unordered_map<std::string, std::string> config;
+    config["document_processing.enable_chunking"] = "true";
+    config["chunking.chunk_token_limit"] = "128";
+    config["chunking.enable_multipass"] = "false";
+    config["chunking.enable_contextual_rag"] = "false";
+    
+    auto processor = std::make_unique<r3m::core::DocumentProcessor>();
+    bool initialized = processor->initialize(config);
+    assert(initialized);
+    (void)initialized;
+    
+    auto result = processor->process_document(test_file);
+    assert(result.processing_success);
+    assert(result.sections.size() == page_count);
+    
+    // Each page starts at its offset in the cleaned text, in order
+    for (size_t i = 0; i < page_count; ++i) {
+        std::string marker = "Page " + std::to_string(i + 1) + " marker";
+        assert(result.text_content.compare(result.sections[i].offset, marker.size(), marker) == 0);
+        assert(result.sections[i].anchor == "page=" + std::to_string(i + 1));
+        assert(i == 0 || result.sections[i].offset > result.sections[i - 1].offset);
+        (void)marker;
+    }
+    
+    assert(result.text_content.find(accented) != std::string::npos);
+    
+    // Chunks cite the pages they were built from
+    std::set<std::string> cited_pages;
+    for (const auto& chunk : result.chunks) {
+        for (const auto& [offset, link] : chunk.source_links) {
+            assert(link.rfind(test_file + "#page=", 0) == 0);
+            cited_pages.insert(link);
+            (void)offset;
+        }
+    }
+    assert(result.chunks.size() > 1);
+    assert(cited_pages.size() == page_count);
+    
+    // The in-memory path extracts the same pages
+    auto memory_result = processor->process_document_from_memory(test_file,
+        std::vector<uint8_t>(pdf.begin(), pdf.end()));
+    assert(memory_result.processing_success);
+    assert(memory_result.text_content == result.text_content);
+    assert(memory_result.sections == result.sections);
+    assert(memory_result.total_chunks == result.total_chunks);
+    (void)memory_result;
+    
+    std::filesystem::remove(test_file);
+    
+    std::cout << "✅ PDF page extraction test passed! (" << result.chunks.size() << " chunks over "
+              << page_count << " pages)" << std::endl;
+}
+
+void test_html_block_extraction() {
+    std::cout << "\n=== Testing HTML Block Extraction ===" << std::endl;
+    
+    // Extractor on its own: hidden elements, references and block boundaries
+    std::vector<r3m::formats::TextSection> blocks;
+    std::string text = r3m::formats::HtmlTextExtractor::extract(
+        "<!DOCTYPE html><html><head><title>T &amp; C</title>"
+        "<style>p { color: red; }</style>"
+        "<script>if (a < b) document.write('<p>hidden</p>');</script></head>"
+        "<body><!-- note --><noscript>Enable JS</noscript>"
+        "<h1 id=\"intro\">Caf&eacute; &#169; &#x41;</h1>"
+        "<p class='x>y'>one <b>bold</b> 1 &lt; 2 &bogus; &amp</p>"
+        "<ul><li>first</li><li>second<br>line</li></ul>"
+        "<table><tr><td>a</td><td>b</td></tr><tr><th>c</th></tr></table>"
+        "</body></html>", &blocks);
+    
+    assert(text == "T & C\n\nCaf\u00e9 \u00a9 A\n\none bold 1 < 2 &bogus; &amp\n\nfirst\n\nsecond\nline\n\na b\n\nc");
+    std::vector<std::string> anchors;
+    for (const auto& block : blocks) {
+        anchors.push_back(block.anchor);
+    }
+    assert((anchors == std::vector<std::string>{"block=1", "intro", "block=3", "block=4", "block=5", "block=6", "block=7"}));
+    assert(text.compare(blocks[1].offset, 3, "Caf") == 0);
+    assert(text.compare(blocks[6].offset, 1, "c") == 0);
+    
+    // Unterminated markup does not leak into the text
+    assert(r3m::formats::HtmlTextExtractor::extract("<p>kept</p><script>never closed") == "kept");
+    assert(r3m::formats::HtmlTextExtractor::extract("<p>kept</p><a href=\"x") == "kept");
+    
+    // Through the processor: every block becomes a section linked as <file>#<anchor>
+    std::string html = "<html><head><title>Report</title><script>var skipped = 1;</script></head><body>";
+    const size_t paragraph_count = 30;
+    for (size_t i = 0; i < paragraph_count; ++i) {
+        html += "<h2 id=\"part-" + std::to_string(i + 1) + "\">Part " + std::to_string(i + 1) + "</h2>";
+        html += "<p>Paragraph " + std::to_string(i + 1) + " explains how the quarterly results were collected, "
+                "reviewed and summarised for the board &amp; the wider team.</p>";
+    }
+    html += "</body></html>";
+    std::string test_file = "test_html_blocks.html";
+    std::ofstream(test_file, std::ios::binary) << html;
+    
+    std::unordered_map<std::string, std::string> config;
+    config["document_processing.enable_chunking"] = "true";
+    config["chunking.chunk_token_limit"] = "128";
+    config["chunking.enable_multipass"] = "false";
+    config["chunking.enable_contextual_rag"] = "false";
+    
+    auto processor = std::make_unique<r3m::core::DocumentProcessor>();
+    bool initialized = processor->initialize(config);
+    assert(initialized);
+    (void)initialized;
+    
+    auto result = processor->process_document(test_file);
+    assert(result.processing_success);
+    assert(result.text_content.find("skipped") == std::string::npos);
+    assert(result.text_content.find("board & the wider team") != std::string::npos);
+    assert(result.sections.size() == 1 + 2 * paragraph_count);
+    assert(result.sections[0].anchor == "block=1");
+    for (size_t i = 0; i < paragraph_count; ++i) {
+        const auto& heading = result.sections[1 + 2 * i];
+        std::string title = "Part " + std::to_string(i + 1);
+        assert(heading.anchor == "part-" + std::to_string(i + 1));
+        assert(result.text_content.compare(heading.offset, title.size(), title) == 0);
+        (void)heading;
+        (void)title;
+    }
+    
+    // Chunks cite the blocks they were built from
+    std::set<std::string> cited_blocks;
+    for (const auto& chunk : result.chunks) {
+        for (const auto& [offset, link] : chunk.source_links) {
+            assert(link.rfind(test_file + "#", 0) == 0);
+            cited_blocks.insert(link);
+            (void)offset;
+        }
+    }
+    assert(result.chunks.size() > 1);
+    assert(cited_blocks.count(test_file + "#part-" + std::to_string(paragraph_count)) == 1);
+    
+    // The in-memory path extracts the same blocks
+    auto memory_result = processor->process_document_from_memory(test_file,
+        std::vector<uint8_t>(html.begin(), html.end()));
+    assert(memory_result.processing_success);
+    assert(memory_result.text_content == result.text_content);
+    assert(memory_result.sections == result.sections);
+    (void)memory_result;
+    
+    std::filesystem::remove(test_file);
+    
+    std::cout << "✅ HTML block extraction test passed! (" << result.sections.size() << " blocks, "
+              << result.chunks.size() << " chunks)" << std::endl;
+}
+
+void test_structured_text_sections() {
+    std::cout << "\n=== Testing Markdown and Paragraph Sections ===" << std::endl;
+    
+    // Headings split, fenced blocks stay whole, repeated slugs are numbered
+    std::string markdown =
+        "Intro line\n\n"
+        "# Getting Started\nInstall it.\n"
+        "```sh\n# not a heading\n\nmake install\n```\n"
+        "After the fence.\n\n"
+        "Setext Title\n============\n\n"
+        "## Getting Started ##\nAgain.\n";
+    std::vector<r3m::formats::TextSection> sections;
+    r3m::formats::SectionSplitter::split_markdown(markdown, sections);
+    std::vector<std::string> anchors;
+    for (const auto& section : sections) {
+        anchors.push_back(section.anchor);
+    }
+    assert((anchors == std::vector<std::string>{"section=1", "getting-started", "section=3", "section=4",
+                                                 "setext-title", "getting-started-1"}));
+    assert(markdown.compare(sections[2].offset, 5, "```sh") == 0);
+    assert(markdown.compare(sections[4].offset, 6, "Setext") == 0);
+    
+    r3m::formats::SectionSplitter::split_paragraphs("one\ntwo\n\n \t\nthree\n\n\nfour", sections);
+    assert(sections.size() == 3);
+    assert(sections[1].offset == 12 && sections[1].anchor == "para=2");
+    
+    // Through the processor: headings and paragraphs become linked sections
+    std::string md_file = "test_sections.md";
+    std::string txt_file = "test_sections.txt";
+    const size_t part_count = 20;
+    std::string md_content = "# Handbook\n\n";
+    std::string txt_content;
+    for (size_t i = 0; i < part_count; ++i) {
+        std::string body = "Part " + std::to_string(i + 1) + " describes how the team reviews changes, "
+                           "ships releases and keeps the documentation current for new contributors.";
+        md_content += "## Part " + std::to_string(i + 1) + "\n\n" + body + "\n\n```\n## inside a fence\n```\n\n";
+        txt_content += body + "\n\n";
+    }
+    std::ofstream(md_file) << md_content;
+    std::ofstream(txt_file) << txt_content;
+    
+    std::unordered_map<std::string, std::string> config;
+    config["document_processing.enable_chunking"] = "true";
+    config["chunking.chunk_token_limit"] = "128";
+    config["chunking.enable_multipass"] = "false";
+    config["chunking.enable_contextual_rag"] = "false";
+    
+    auto processor = std::make_unique<r3m::core::DocumentProcessor>();
+    bool initialized = processor->initialize(config);
+    assert(initialized);
+    (void)initialized;
+    
+    auto md_result = processor->process_document(md_file);
+    assert(md_result.processing_success);
+    assert(md_result.sections.size() == 1 + 2 * part_count);
+    assert(md_result.sections[0].anchor == "handbook");
+    for (size_t i = 0; i < part_count; ++i) {
+        const auto& heading = md_result.sections[1 + 2 * i];
+        assert(heading.anchor == "part-" + std::to_string(i + 1));
+        assert(md_result.text_content.compare(heading.offset, 2, "##") == 0);
+        (void)heading;
+    }
+    
+    auto txt_result = processor->process_document(txt_file);
+    assert(txt_result.processing_success);
+    assert(txt_result.sections.size() == part_count);
+    assert(txt_result.sections.back().anchor == "para=" + std::to_string(part_count));
+    
+    // Chunks cite the sections they were built from
+    for (const auto* result : {&md_result, &txt_result}) {
+        std::set<std::string> cited;
+        for (const auto& chunk : result->chunks) {
+            for (const auto& [offset, link] : chunk.source_links) {
+                assert(link.find('#') != std::string::npos);
+                cited.insert(link);
+                (void)offset;
+            }
+        }
+        assert(result->chunks.size() > 1);
+        assert(cited.size() > 1);
+    }
+    
+    // The in-memory path splits the same way
+    auto memory_result = processor->process_document_from_memory(md_file,
+        std::vector<uint8_t>(md_content.begin(), md_content.end()));
+    assert(memory_result.processing_success);
+    assert(memory_result.sections == md_result.sections);
+    (void)memory_result;
+    
+    std::filesystem::remove(md_file);
+    std::filesystem::remove(txt_file);
+    
+    std::cout << "✅ Markdown and paragraph sections test passed! (" << md_result.sections.size() << " Markdown sections, "
+              << txt_result.sections.size() << " paragraphs)" << std::endl;
+}
+
+void test_tokenizer_selection() {
+    std::cout << "Testing tokenizer selection from config..." << std::endl;
+    
+    // Varied words, so even the short byte-level chunks pass the chunk quality filter
+    const std::vector<std::string> topics = {"parser", "scheduler", "allocator", "indexer", "renderer",
+                                             "compiler", "profiler", "resolver"};
+    std::string text_content;
+    for (int i = 0; i < 40; ++i) {
+        const std::string& topic = topics[i % topics.size()];
+        text_content += "Paragraph " + std::to_string(i) + " explains how the " + topic + " module v" +
+                        std::to_string(i) + " sizes chunk_" + std::to_string(i * 7) + " buffers for " + topic +
+                        "_" + std::to_string(i) + " jobs. ";
+    }
+    std::vector<uint8_t> buffer(text_content.begin(), text_content.end());
+    
+    auto chunk_count = [&buffer](const std::unordered_map<std::string, std::string>& tokenizer_config) {
+        std::unordered_map<std::string, std::string> config = tokenizer_config;
+        config["document_processing.enable_chunking"] = "true";
+        config["chunking.chunk_token_limit"] = "400";
+        
+        r3m::core::DocumentProcessor processor;
+        bool initialized = processor.initialize(config);
+        assert(initialized);
+        (void)initialized;
+        auto result = processor.process_document_from_memory("test_tokenizer_selection.txt", buffer);
+        assert(result.processing_success);
+        return result.total_chunks;
+    };
+    
+    // BPE vocabularies loaded from vocab.json / merges.txt: with a handful of
+    // merges nearly every byte is a token, so the same limit cuts many more
+    // chunks than whitespace tokens do; a larger vocabulary merges them again
+    auto bpe_chunk_count = [&](size_t vocab_size) {
+        r3m::chunking::BPETokenizer trained(vocab_size);
+        trained.train({text_content});
+        trained.save_vocabulary("test_selection_vocab.json", "test_selection_merges.txt");
+        size_t chunks = chunk_count({{"chunking.tokenizer.type", "bpe"},
+                                     {"chunking.tokenizer.vocab_file", "test_selection_vocab.json"},
+                                     {"chunking.tokenizer.merges_file", "test_selection_merges.txt"}});
+        std::remove("test_selection_vocab.json");
+        std::remove("test_selection_merges.txt");
+        return chunks;
+    };
+    size_t basic_chunks = chunk_count({});
+    size_t byte_chunks = bpe_chunk_count(260);
+    size_t bpe_chunks = bpe_chunk_count(600);
+    assert(basic_chunks > 0);
+    assert(byte_chunks > basic_chunks);
+    assert(bpe_chunks > 0);
+    assert(bpe_chunks < byte_chunks);
+    
+    // Unknown tokenizers, BPE without a model and unreadable vocabularies
+    // fail initialization
+    for (const auto& bad_config : std::vector<std::unordered_map<std::string, std::string>>{
+             {{"document_processing.enable_chunking", "true"}, {"chunking.tokenizer.type", "sentencepiece"}},
+             {{"document_processing.enable_chunking", "true"}, {"chunking.tokenizer.type", "bpe"}},
+             {{"document_processing.enable_chunking", "true"}, {"chunking.tokenizer.type", "bpe"},
+              {"chunking.tokenizer.vocab_file", "missing_vocab.json"},
+              {"chunking.tokenizer.merges_file", "missing_merges.txt"}}}) {
+        r3m::core::DocumentProcessor processor;
+        bool initialized = processor.initialize(bad_config);
+        assert(!initialized);
+        (void)initialized;
+    }
+    
+    std::cout << "✅ Tokenizer selection test passed! (basic: " << basic_chunks << ", 4-merge BPE: " << byte_chunks
+              << ", trained BPE: " << bpe_chunks << " chunks)" << std::endl;
+}
+
+void test_quality_assessment_single_pass() {
+    std::cout << "Testing single-pass quality assessment..." << std::endl;
+    
+    using r3m::quality::QualityAssessor;
+    using r3m::utils::TextUtils;
+    
+    // The fused counts match the separate TextUtils passes they replace
+    std::vector<std::string> samples = {
+        "",
+        "   \t\n ",
+        "...!!!???",
+        "Hello, world! Hello world.",
+        "(Wrapped) 'quotes' -dash- __init__ v2.0 user@example.com #tag C++ e.g. ...end",
+        "Tabs\tand\nnewlines\r\nand\vvertical\fform feeds. Caf\xc3\xa9 na\xc3\xafve \xe2\x80\x94 r\xc3\xa9sum\xc3\xa9?",
+        "word word WORD Word w0rd 123 123. 123!",
+    };
+    for (const auto& text : samples) {
+        auto counts = QualityAssessor::count_text(text);
+        assert(counts.text_length == text.size());
+        assert(counts.unique_words == TextUtils::get_unique_words(text).size());
+        assert(counts.sentence_count == TextUtils::count_sentences(text));
+        assert(counts.technical_terms == TextUtils::count_technical_terms(text));
+        (void)counts;
+    }
+    
+    QualityAssessor assessor;
+    assessor.initialize({});
+    for (const auto& text : samples) {
+        auto metrics = assessor.assess_quality(text);
+        assert(metrics.content_quality_score == assessor.calculate_content_quality_score(text));
+        assert(metrics.information_density == assessor.calculate_information_density(text));
+        assert(metrics.content_quality_score >= 0.0 && metrics.content_quality_score <= 1.0);
+        (void)metrics;
+    }
+    
+    // ~5MB document: one pass instead of four stringstream tokenizations
+    std::string document;
+    document.reserve(5 * 1024 * 1024 + 128);
+    for (size_t i = 0; document.size() < 5 * 1024 * 1024; ++i) {
+        document += "Section " + std::to_string(i % 5000) + " describes module_" + std::to_string(i % 977) +
+                    " and its v" + std::to_string(i % 13) + ".x interface. ";
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t reference_unique = TextUtils::get_unique_words(document).size();
+    size_t reference_sentences = TextUtils::count_sentences(document);
+    size_t reference_technical = TextUtils::count_technical_terms(document);
+    TextUtils::get_unique_words(document);
+    TextUtils::get_unique_words(document);
+    auto reference_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    
+    // Exact counting: by default documents this large get a sketch estimate
+    QualityAssessor exact_assessor;
+    exact_assessor.initialize({{"document_processing.quality_filtering.unique_words.mode", "exact"}});
+    
+    start = std::chrono::high_resolution_clock::now();
+    auto metrics = exact_assessor.assess_quality(document);
+    auto fused_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    
+    assert(metrics.unique_words == reference_unique);
+    assert(metrics.sentence_count == reference_sentences);
+    assert(metrics.technical_terms == reference_technical);
+    (void)reference_unique;
+    (void)reference_sentences;
+    (void)reference_technical;
+    
+    std::cout << "✅ Single-pass quality assessment test passed! (5MB: " << fused_ms << "ms fused vs "
+              << reference_ms << "ms for separate passes, " << metrics.unique_words << " unique words)" << std::endl;
+}
+
+void test_config_hot_reload() {
+    std::cout << "Testing typed config snapshots and hot reload..." << std::endl;
+    
+    using r3m::core::ConfigManager;
+    using r3m::core::ConfigSnapshot;
+    
+    const std::string config_file = "test_hot_reload.yaml";
+    auto write_config = [&config_file](const std::string& min_score, int token_limit) {
+        std::ofstream(config_file)
+            << "# Hot reload test configuration\n"
+            << "document_processing:\n"
+            << "  enable_chunking: true\n"
+            << "  max_workers: 2\n"
+            << "  quality_filtering:\n"
+            << "    min_content_quality_score: " << min_score << "   # quality bar\n"
+            << "    quality_weights:\n"
+            << "      length_factor: 0.3\n"
+            << "chunking:\n"
+            << "  chunk_token_limit: " << token_limit << "\n"
+            << "  tokenizer:\n"
+            << "    type: \"basic\"\n";
+    };
+    
+    // Nested YAML flattens to the dot notation keys and parses into typed fields
+    write_config("0.1", 400);
+    ConfigManager manager;
+    bool loaded = manager.load_config(config_file);
+    assert(loaded);
+    (void)loaded;
+    auto first = manager.snapshot();
+    assert(first->enable_chunking);
+    assert(first->max_workers == 2);
+    assert(first->quality.min_content_quality_score == 0.1);
+    assert(first->quality.quality_weights.length_factor == 0.3);
+    assert(first->chunker.chunk_token_limit == 400);
+    assert(first->values.at("chunking.tokenizer.type") == "basic");
+    assert(!manager.reload_if_changed());
+    
+    std::string text;
+    for (int i = 0; i < 30; ++i) {
+        text += "Release " + std::to_string(i) + " notes describe how the scheduler balances work across nodes. ";
+    }
+    std::vector<uint8_t> buffer(text.begin(), text.end());
+    
+    r3m::core::DocumentProcessor processor;
+    bool initialized = processor.initialize(first);
+    assert(initialized);
+    (void)initialized;
+    auto before = processor.process_document_from_memory("test_hot_reload.txt", buffer);
+    assert(before.processing_success && before.is_high_quality);
+    assert(before.total_chunks > 0);
+    
+    // An edited file is picked up; holders of the old snapshot keep its values
+    write_config("0.99", 100);
+    std::filesystem::last_write_time(config_file,
+                                     std::filesystem::last_write_time(config_file) + std::chrono::seconds(2));
+    bool reloaded = manager.reload_if_changed();
+    assert(reloaded);
+    (void)reloaded;
+    auto second = manager.snapshot();
+    assert(second->version > first->version);
+    assert(second->quality.min_content_quality_score == 0.99);
+    assert(first->quality.min_content_quality_score == 0.1);
+    assert(second->chunking_differs(*first));
+    
+    bool applied = processor.apply_config(second);
+    assert(applied);
+    (void)applied;
+    auto after = processor.process_document_from_memory("test_hot_reload.txt", buffer);
+    assert(after.processing_success && !after.is_high_quality);
+    assert(after.quality_reason == "Low content quality score");
+    assert(after.total_chunks > before.total_chunks);
+    
+    // A file that does not parse leaves the published snapshot alone
+    write_config("not-a-number", 100);
+    bool bad_reload = manager.reload();
+    assert(!bad_reload);
+    (void)bad_reload;
+    assert(manager.snapshot() == second);
+    
+    // Overrides win over the file and survive reloads
+    write_config("0.99", 100);
+    manager.load_from_map({{"chunking.chunk_token_limit", "300"}});
+    assert(manager.snapshot()->chunker.chunk_token_limit == 300);
+    manager.reload();
+    assert(manager.snapshot()->chunker.chunk_token_limit == 300);
+    
+    // Documents in flight while snapshots are swapped all complete
+    std::atomic<size_t> completed{0};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < 20; ++i) {
+                auto result = processor.process_document_from_memory("test_hot_reload.txt", buffer);
+                if (result.processing_success && result.total_chunks > 0) {
+                    ++completed;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 100; ++i) {
+        processor.apply_config(i % 2 == 0 ? first : second);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    assert(completed == 80);
+    
+    std::remove(config_file.c_str());
+    std::cout << "✅ Config hot reload test passed! (" << before.total_chunks << " chunks before, "
+              << after.total_chunks << " after reload)" << std::endl;
+}
+
+void test_approximate_unique_words() {
+    std::cout << "Testing approximate unique-word counting..." << std::endl;
+    
+    using r3m::quality::QualityAssessor;
+    using r3m::quality::UniqueWordCounting;
+    using r3m::utils::HyperLogLog;
+    
+    // The sketch stays within a few standard errors at every scale, in fixed memory
+    assert(HyperLogLog::precision_for_error(0.01) == 14);
+    for (size_t distinct : {size_t{10}, size_t{1000}, size_t{1000000}}) {
+        HyperLogLog sketch(0.01);
+        for (size_t i = 0; i < distinct; ++i) {
+            std::string word = "w" + std::to_string(i);
+            sketch.add_hash(r3m::utils::wyhash(word));
+            sketch.add_hash(r3m::utils::wyhash(word));  // Repeats do not count
+        }
+        double error = std::abs(static_cast<double>(sketch.estimate()) - static_cast<double>(distinct)) / distinct;
+        assert(error <= 4 * sketch.standard_error());
+        assert(sketch.memory_bytes() == 16384);
+        (void)error;
+    }
+    
+    // Dictionary-like document: every word distinct
+    std::string dictionary;
+    size_t word_count = 0;
+    while (dictionary.size() < 4 * 1024 * 1024) {
+        dictionary += "term" + std::to_string(word_count);
+        ++word_count;
+        dictionary += word_count % 12 == 0 ? ". " : " ";
+    }
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    auto exact = QualityAssessor::count_text(dictionary, {UniqueWordCounting::Mode::EXACT});
+    auto exact_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    assert(exact.unique_words == word_count && !exact.unique_words_estimated);
+    (void)exact;
+    
+    // AUTO switches to the sketch above the threshold; other counts stay exact
+    UniqueWordCounting counting;
+    counting.approximate_threshold = 1024 * 1024;
+    start = std::chrono::high_resolution_clock::now();
+    auto approximate = QualityAssessor::count_text(dictionary, counting);
+    auto approximate_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    assert(approximate.unique_words_estimated);
+    assert(approximate.sentence_count == exact.sentence_count);
+    assert(approximate.technical_terms == exact.technical_terms);
+    double error = std::abs(static_cast<double>(approximate.unique_words) - static_cast<double>(word_count)) / word_count;
+    assert(error <= 0.04);
+    
+    auto small = QualityAssessor::count_text("alpha beta alpha gamma", counting);
+    assert(small.unique_words == 3 && !small.unique_words_estimated);
+    (void)small;
+    
+    // Configured through the quality filtering section
+    QualityAssessor assessor;
+    assessor.initialize({{"document_processing.quality_filtering.unique_words.mode", "approximate"},
+                         {"document_processing.quality_filtering.unique_words.approximate_error", "0.02"}});
+    assert(assessor.get_config().unique_words.mode == UniqueWordCounting::Mode::APPROXIMATE);
+    assert(assessor.get_config().unique_words.approximate_error == 0.02);
+    auto metrics = assessor.assess_quality("Short text with a handful of words.");
+    assert(metrics.unique_words_estimated && metrics.unique_words == 7);
+    
+    bool rejected = false;
+    try {
+        QualityAssessor::parse_config({{"document_processing.quality_filtering.unique_words.mode", "fuzzy"}});
+    } catch (const std::invalid_argument&) {
+        rejected = true;
+    }
+    assert(rejected);
+    (void)rejected;
+    
+    std::cout << "✅ Approximate unique-word test passed! (" << word_count << " distinct words: exact "
+              << exact_ms << "ms, sketch " << approximate_ms << "ms, estimate " << approximate.unique_words
+              << ", error " << error * 100 << "%)" << std::endl;
+}
+
 int main() {
     std::cout << "🚀 R3M DocumentProcessor + AdvancedChunker Integration Tests" << std::endl;
     std::cout << "Testing the integration between document processing and chunking systems" << std::endl;
@@ -256,6 +1111,16 @@ int main() {
         test_document_processor_chunking_integration();
         test_chunking_configuration();
         test_chunking_disabled();
+        test_process_document_from_memory();
+        test_mapped_file_ingestion();
+        test_streaming_document_processing();
+        test_pdf_page_extraction();
+        test_html_block_extraction();
+        test_structured_text_sections();
+        test_tokenizer_selection();
+        test_quality_assessment_single_pass();
+        test_approximate_unique_words();
+        test_config_hot_reload();
         
         std::cout << "\n🎉 All integration tests passed!" << std::endl;
         return 0;
@@ -4,8 +4,16 @@
 #include <string>
 #include <iomanip>
 #include <fstream>
+#include <atomic>
+#include <cassert>
+#include <thread>
+#include <memory_resource>
 #include "r3m/core/document_processor.hpp"
 #include "r3m/parallel/optimized_thread_pool.hpp"
+#include "r3m/parallel/thread_pool.hpp"
+#include "r3m/quality/assessor.hpp"
+#include "r3m/utils/performance.hpp"
+#include "r3m/utils/task_memory.hpp"
 
 using namespace r3m::core;
 
@@ -20,6 +28,338 @@ void print_subsection(const std::string& title) {
     std::cout << std::string(title.length(), '-') << "\n";
 }
 
+// Chunk-level unit of work: count the tokens of one small chunk
+struct ChunkWork {
+    const r3m::chunking::BasicTokenizer* tokenizer;
+    const std::vector<std::string>* chunks;
+    std::atomic<size_t>* tokens;
+    std::atomic<size_t>* done;
+    
+    void operator()(size_t index) const {
+        tokens->fetch_add(tokenizer->count_tokens((*chunks)[index % chunks->size()]), std::memory_order_relaxed);
+        done->fetch_add(1, std::memory_order_release);
+    }
+};
+
+void wait_for(const std::atomic<size_t>& done, size_t expected) {
+    while (done.load(std::memory_order_acquire) < expected) {
+        std::this_thread::yield();
+    }
+}
+
+// Many small tasks submitted from outside the pool
+template<typename Pool>
+double run_flat_tasks(Pool& pool, const ChunkWork& work, size_t task_count) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < task_count; ++i) {
+        pool.submit([work, i]() { work(i); });
+    }
+    wait_for(*work.done, task_count);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// Document-level tasks that fan out into chunk-level tasks from inside the pool
+template<typename Pool>
+double run_nested_tasks(Pool& pool, const ChunkWork& work, size_t parents, size_t children) {
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t p = 0; p < parents; ++p) {
+        pool.submit([&pool, work, p, children]() {
+            for (size_t c = 0; c < children; ++c) {
+                pool.submit([work, p, c, children]() { work(p * children + c); });
+            }
+        });
+    }
+    wait_for(*work.done, parents * children);
+    auto end = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void benchmark_scheduler_throughput() {
+    print_separator("TEST 6: WORK-STEALING SCHEDULER THROUGHPUT");
+    
+    const size_t workers = 4;
+    const size_t flat_tasks = 200000;
+    const size_t parents = 64;
+    const size_t children = 3000;
+    
+    r3m::chunking::BasicTokenizer tokenizer;
+    std::vector<std::string> chunks;
+    for (int i = 0; i < 64; ++i) {
+        chunks.push_back("Chunk " + std::to_string(i) + " covers API_v" + std::to_string(i) +
+                         ".0 request handling, JSON.parse() results and retry policies for the HTTP client.");
+    }
+    
+    struct Run {
+        double flat_ms;
+        double nested_ms;
+        size_t tokens;
+    };
+    
+    auto measure = [&](auto& pool) {
+        Run run{};
+        std::atomic<size_t> tokens{0};
+        std::atomic<size_t> done{0};
+        ChunkWork work{&tokenizer, &chunks, &tokens, &done};
+        
+        run.flat_ms = run_flat_tasks(pool, work, flat_tasks);
+        done = 0;
+        run.nested_ms = run_nested_tasks(pool, work, parents, children);
+        run.tokens = tokens.load();
+        return run;
+    };
+    
+    Run shared_queue;
+    {
+        r3m::parallel::ThreadPool pool(workers);
+        shared_queue = measure(pool);
+    }
+    
+    Run stealing;
+    size_t steals = 0;
+    size_t processed = 0;
+    {
+        r3m::parallel::OptimizedThreadPool pool(workers);
+        stealing = measure(pool);
+        pool.shutdown();  // Counters are final once the workers have exited
+        steals = pool.get_work_steals();
+        processed = pool.get_tasks_processed();
+    }
+    
+    // Every task ran exactly once in both pools
+    assert(stealing.tokens == shared_queue.tokens);
+    assert(processed == flat_tasks + parents + parents * children);
+    (void)processed;
+    
+    auto rate = [](size_t tasks, double ms) { return tasks / (ms / 1000.0) / 1e6; };
+    
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Workers: " << workers << " (hardware threads: " << std::thread::hardware_concurrency() << ")\n";
+    std::cout << "Flat submit (" << flat_tasks << " chunk tasks from one thread):\n";
+    std::cout << "  Shared-queue pool:   " << shared_queue.flat_ms << " ms ("
+              << rate(flat_tasks, shared_queue.flat_ms) << " M tasks/s)\n";
+    std::cout << "  Work-stealing pool:  " << stealing.flat_ms << " ms ("
+              << rate(flat_tasks, stealing.flat_ms) << " M tasks/s)\n";
+    std::cout << "Nested spawn (" << parents << " documents x " << children << " chunk tasks):\n";
+    std::cout << "  Shared-queue pool:   " << shared_queue.nested_ms << " ms ("
+              << rate(parents * children, shared_queue.nested_ms) << " M tasks/s)\n";
+    std::cout << "  Work-stealing pool:  " << stealing.nested_ms << " ms ("
+              << rate(parents * children, stealing.nested_ms) << " M tasks/s)\n";
+    std::cout << "Speedup: flat " << shared_queue.flat_ms / stealing.flat_ms << "x, nested "
+              << shared_queue.nested_ms / stealing.nested_ms << "x\n";
+    std::cout << "Work steals: " << steals << "\n";
+}
+
+// Identical chunk lists: same order, ids, text and scores
+bool same_chunks(const std::vector<r3m::chunking::DocumentChunk>& a,
+                 const std::vector<r3m::chunking::DocumentChunk>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].chunk_id != b[i].chunk_id || a[i].large_chunk_id != b[i].large_chunk_id ||
+            a[i].large_chunk_reference_ids != b[i].large_chunk_reference_ids ||
+            a[i].content.view() != b[i].content.view() || a[i].blurb.view() != b[i].blurb.view() ||
+            a[i].quality_score != b[i].quality_score ||
+            a[i].information_density != b[i].information_density ||
+            a[i].chunk_context.view() != b[i].chunk_context.view()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void benchmark_intra_document_parallelism() {
+    print_separator("TEST 7: INTRA-DOCUMENT PARALLEL CHUNKING");
+    
+    using r3m::chunking::AdvancedChunker;
+    using r3m::chunking::MultipassChunker;
+    
+    // One large document (~2MB) in paragraph sections
+    AdvancedChunker::DocumentInfo doc;
+    doc.document_id = "large_doc";
+    doc.title = "Large Document";
+    doc.semantic_identifier = "large_doc.txt";
+    doc.source_type = "file";
+    doc.metadata["author"] = "r3m";
+    for (int p = 0; p < 2000; ++p) {
+        std::string paragraph;
+        for (int s = 0; s < 12; ++s) {
+            paragraph += "Paragraph " + std::to_string(p) + " sentence " + std::to_string(s) +
+                         " describes API_v" + std::to_string(p % 97) + " caching, retries and JSON.parse() output. ";
+        }
+        doc.full_content += paragraph + "\n\n";
+        doc.sections.emplace_back(paragraph);
+    }
+    
+    AdvancedChunker::Config config;
+    config.enable_multipass = true;
+    config.enable_large_chunks = true;
+    config.enable_contextual_rag = true;
+    config.chunk_token_limit = 512;
+    
+    auto tokenizer = std::make_shared<r3m::chunking::BasicTokenizer>();
+    
+    AdvancedChunker sequential(tokenizer, config);
+    auto seq_start = std::chrono::high_resolution_clock::now();
+    auto seq_result = sequential.process_document(doc);
+    auto seq_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - seq_start).count();
+    
+    MultipassChunker seq_multipass(tokenizer, true, true, 150, 4, 512);
+    auto seq_multi = seq_multipass.chunk_document(doc.document_id, doc.full_content, doc.title, doc.metadata);
+    
+    r3m::parallel::OptimizedThreadPool pool(4);
+    AdvancedChunker forked(tokenizer, config);
+    forked.set_thread_pool(&pool);
+    auto par_start = std::chrono::high_resolution_clock::now();
+    auto par_result = forked.process_document(doc);
+    auto par_ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - par_start).count();
+    
+    MultipassChunker par_multipass(tokenizer, true, true, 150, 4, 512);
+    par_multipass.set_thread_pool(&pool);
+    auto par_multi = par_multipass.chunk_document(doc.document_id, doc.full_content, doc.title, doc.metadata);
+    
+    // Forked work is joined in chunk order: results do not depend on the pool
+    assert(seq_result.chunks.size() > 100);
+    assert(same_chunks(seq_result.chunks, par_result.chunks));
+    assert(seq_result.total_content_tokens == par_result.total_content_tokens);
+    assert(seq_result.avg_quality_score == par_result.avg_quality_score);
+    assert(same_chunks(seq_multi.chunks, par_multi.chunks));
+    
+    // The same fork/join nested inside a pool task (document-level parallelism)
+    auto nested = pool.submit([&forked, &doc]() { return forked.process_document(doc); }).get();
+    assert(same_chunks(seq_result.chunks, nested.chunks));
+    (void)nested;
+    
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "Document: " << doc.full_content.size() / 1024 << " KB, "
+              << seq_result.chunks.size() << " chunks (" << seq_multi.chunks.size() << " with mini chunks)\n";
+    std::cout << "Calling thread only:   " << seq_ms << " ms\n";
+    std::cout << "Fork/join on 4 workers: " << par_ms << " ms ("
+              << seq_ms / par_ms << "x, hardware threads: " << std::thread::hardware_concurrency() << ")\n";
+    std::cout << "✅ Chunk order, ids and scores identical with and without the pool\n";
+}
+
+// What one document task produced, to compare runs with and without arenas
+struct DocumentSummary {
+    size_t unique_words = 0;
+    size_t chunks = 0;
+    size_t content_tokens = 0;
+    double avg_quality = 0.0;
+    
+    bool operator==(const DocumentSummary&) const = default;
+};
+
+void benchmark_task_arenas() {
+    print_separator("TEST 8: PER-WORKER TASK ARENAS");
+    
+    using r3m::chunking::AdvancedChunker;
+    using r3m::parallel::OptimizedThreadPool;
+    using r3m::utils::PerformanceUtils;
+    
+    // Task memory is the worker's arena only inside a pool task
+    assert(r3m::utils::task_memory_resource() == std::pmr::get_default_resource());
+    {
+        OptimizedThreadPool pool(1, true);
+        auto first = pool.submit([]() {
+            auto* resource = r3m::utils::task_memory_resource();
+            assert(resource != std::pmr::get_default_resource());
+            return resource->allocate(256);
+        }).get();
+        // The arena was released when the first task returned, so the next
+        // task gets the same memory again
+        auto second = pool.submit([]() { return r3m::utils::task_memory_resource()->allocate(256); }).get();
+        assert(first == second);
+        (void)first;
+        (void)second;
+    }
+    {
+        OptimizedThreadPool pool(1, false);
+        auto resource = pool.submit([]() { return r3m::utils::task_memory_resource(); }).get();
+        assert(resource == std::pmr::get_default_resource());
+        (void)resource;
+    }
+    
+    // Documents with a large vocabulary: the unique-word set and the chunker's
+    // per-document vectors are the task temporaries
+    std::vector<AdvancedChunker::DocumentInfo> documents(16);
+    for (size_t d = 0; d < documents.size(); ++d) {
+        auto& doc = documents[d];
+        doc.document_id = "arena_doc_" + std::to_string(d);
+        doc.title = "Arena Document " + std::to_string(d);
+        doc.semantic_identifier = doc.document_id + ".txt";
+        doc.source_type = "file";
+        for (int p = 0; p < 400; ++p) {
+            std::string paragraph;
+            for (int s = 0; s < 20; ++s) {
+                paragraph += "Record " + std::to_string(d * 100000 + p * 100 + s) + " links term_" +
+                             std::to_string((d * 7919 + p * 131 + s) % 50000) + " to node_" +
+                             std::to_string(p * 20 + s) + " in cluster " + std::to_string(s % 7) + ". ";
+            }
+            doc.full_content += paragraph + "\n\n";
+            doc.sections.emplace_back(paragraph);
+        }
+    }
+    
+    AdvancedChunker::Config config;
+    config.chunk_token_limit = 256;
+    auto tokenizer = std::make_shared<r3m::chunking::BasicTokenizer>();
+    AdvancedChunker chunker(tokenizer, config);
+    r3m::quality::UniqueWordCounting exact;
+    exact.mode = r3m::quality::UniqueWordCounting::Mode::EXACT;
+    
+    auto process = [&](const AdvancedChunker::DocumentInfo& doc) {
+        DocumentSummary summary;
+        summary.unique_words = r3m::quality::QualityAssessor::count_text(doc.full_content, exact).unique_words;
+        auto result = chunker.process_document(doc);
+        summary.chunks = result.chunks.size();
+        summary.content_tokens = result.total_content_tokens;
+        summary.avg_quality = result.avg_quality_score;
+        return summary;
+    };
+    
+    const size_t iterations = 5;
+    std::vector<DocumentSummary> summaries[2];
+    double avg_ms[2] = {};
+    double faults_per_document[2] = {};
+    for (int pooling = 0; pooling < 2; ++pooling) {
+        OptimizedThreadPool pool(4, pooling == 1);
+        auto run_all = [&]() {
+            std::vector<std::future<DocumentSummary>> futures;
+            for (const auto& doc : documents) {
+                futures.push_back(pool.submit([&process, &doc]() { return process(doc); }));
+            }
+            summaries[pooling].clear();
+            for (auto& future : futures) {
+                summaries[pooling].push_back(future.get());
+            }
+        };
+        
+        // Warm up outside the measurement: arenas settle at their working size
+        run_all();
+        PerformanceUtils::BenchmarkRunner runner(pooling ? "Task arenas" : "Heap", iterations);
+        runner.set_warmup_iterations(0);
+        size_t faults_before = PerformanceUtils::get_page_faults();
+        auto results = runner.run_benchmark(run_all);
+        size_t faults = PerformanceUtils::get_page_faults() - faults_before;
+        
+        avg_ms[pooling] = results.avg_time_ms / documents.size();
+        faults_per_document[pooling] = static_cast<double>(faults) / (iterations * documents.size());
+    }
+    
+    // Arenas change where temporaries live, not what is computed
+    assert(summaries[0] == summaries[1]);
+    assert(summaries[1].front().unique_words > 1000);
+    
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Documents: " << documents.size() << " x " << documents.front().full_content.size() / 1024
+              << " KB on 4 workers, " << iterations << " runs\n";
+    std::cout << "Heap:        " << avg_ms[0] << " ms/document, " << std::setprecision(1)
+              << faults_per_document[0] << " page faults/document\n";
+    std::cout << std::setprecision(3);
+    std::cout << "Task arenas: " << avg_ms[1] << " ms/document, " << std::setprecision(1)
+              << faults_per_document[1] << " page faults/document\n";
+    std::cout << "✅ Task memory released between tasks; results identical with and without arenas\n";
+}
+
 int main() {
     std::cout << "🚀 R3M Parallel Optimization Test\n";
     std::cout << "==================================\n\n";
@@ -199,6 +539,10 @@ int main() {
     std::cout << "Text size: " << large_text.length() << " characters\n";
     std::cout << "Processing speed: " << (large_text.length() / (simd_duration.count() / 1000.0)) << " chars/ms\n";
     
+    benchmark_scheduler_throughput();
+    benchmark_intra_document_parallelism();
+    benchmark_task_arenas();
+    
     // Summary
     print_separator("OPTIMIZATION SUMMARY");
     
@@ -7,6 +7,7 @@
 #include <random>
 #include <thread>
 #include <chrono>
+#include <filesystem>
 
 using namespace r3m;
 
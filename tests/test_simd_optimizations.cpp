@@ -3,14 +3,23 @@
 #include <random>
 #include <string>
 #include <cassert>
+#include <vector>
+#include <regex>
+#include <algorithm>
+#include <sstream>
+#include <unordered_set>
 #include "r3m/utils/simd_utils.hpp"
 #include "r3m/utils/text_processing.hpp"
+#include "r3m/utils/text_utils.hpp"
+#include "r3m/chunking/tokenizer.hpp"
+#include "r3m/chunking/quality_assessment/quality_calculator.hpp"
 
 void test_simd_capabilities() {
     std::cout << "=== SIMD Capability Detection ===" << std::endl;
     std::cout << "SIMD supported: " << (r3m::utils::SIMDUtils::supports_simd() ? "YES" : "NO") << std::endl;
     std::cout << "AVX2 supported: " << (r3m::utils::SIMDUtils::supports_avx2() ? "YES" : "NO") << std::endl;
     std::cout << "AVX-512 supported: " << (r3m::utils::SIMDUtils::supports_avx512() ? "YES" : "NO") << std::endl;
+    std::cout << "Active kernels: " << r3m::utils::SIMDUtils::kernels().name << std::endl;
     std::cout << std::endl;
 }
 
@@ -120,6 +129,69 @@ void test_token_counting() {
     std::cout << std::endl;
 }
 
+void test_word_token_counting_differential() {
+    std::cout << "=== Word Token Counting Differential Tests ===" << std::endl;
+    
+    // Alphabet covers every class boundary: letters, all isspace chars,
+    // tokenizer punctuation, other ASCII, control bytes and UTF-8 bytes
+    const std::string alphabet =
+        "abcXYZ019 \t\n\v\f\r.,!?;:()[]{}\"'`~@#$%^&*+=|\\/<>-_\x01\x1f\x7f\x80\xc3\xa9\xff";
+    std::string with_nul = alphabet;
+    with_nul.push_back('\0');
+    
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pick(0, with_nul.size() - 1);
+    std::uniform_int_distribution<size_t> length(0, 300);
+    
+    r3m::chunking::BasicTokenizer tokenizer(8192);
+    r3m::chunking::BasicTokenizer capped_tokenizer(25);
+    
+    for (int iteration = 0; iteration < 20000; ++iteration) {
+        // Occasionally use long inputs so the vector loop and carry are exercised
+        size_t len = (iteration % 100 == 0) ? length(rng) * 40 : length(rng);
+        std::string text;
+        text.reserve(len);
+        for (size_t i = 0; i < len; ++i) {
+            text.push_back(with_nul[pick(rng)]);
+        }
+        
+        size_t expected = tokenizer.tokenize(text).size();
+        size_t simd_count = r3m::utils::SIMDUtils::count_word_tokens_simd(text);
+        size_t scalar_count = r3m::utils::SIMDUtils::count_word_tokens_scalar(text);
+        
+        assert(simd_count == scalar_count);
+        assert(tokenizer.count_tokens(text) == expected);
+        assert(capped_tokenizer.count_tokens(text) == capped_tokenizer.tokenize(text).size());
+        (void)expected;
+        (void)simd_count;
+        (void)scalar_count;
+    }
+    
+    // Allocation-free count vs tokenize().size() on a large document
+    std::string document;
+    for (int i = 0; i < 20000; ++i) {
+        document += "Token counting (hot path): sections, sentences & caches... ";
+    }
+    r3m::chunking::BasicTokenizer large_tokenizer(1u << 30);
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t counted = large_tokenizer.count_tokens(document);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto count_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    
+    start = std::chrono::high_resolution_clock::now();
+    size_t tokenized = large_tokenizer.tokenize(document).size();
+    end = std::chrono::high_resolution_clock::now();
+    auto tokenize_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    
+    assert(counted == tokenized);
+    (void)tokenized;
+    std::cout << "20000 randomized inputs matched tokenize().size()" << std::endl;
+    std::cout << "count_tokens: " << count_time.count() << " microseconds, tokenize().size(): "
+              << tokenize_time.count() << " microseconds (" << counted << " tokens)" << std::endl;
+    std::cout << std::endl;
+}
+
 void test_string_splitting() {
     std::cout << "=== String Splitting Tests ===" << std::endl;
     
@@ -349,6 +421,327 @@ void test_text_normalization() {
     std::cout << std::endl;
 }
 
+void test_kernel_dispatch_differential() {
+    std::cout << "=== Kernel Dispatch Differential Tests ===" << std::endl;
+    using r3m::utils::ByteSet;
+    using r3m::utils::SIMDIsa;
+    using r3m::utils::SIMDKernels;
+    using r3m::utils::SIMDUtils;
+    
+    const SIMDKernels& scalar = r3m::utils::scalar_kernels;
+    std::vector<const SIMDKernels*> tables;
+    for (SIMDIsa isa : {SIMDIsa::SSE42, SIMDIsa::AVX2, SIMDIsa::AVX512BW, SIMDIsa::NEON}) {
+        if (const SIMDKernels* table = SIMDUtils::kernels_for(isa)) {
+            tables.push_back(table);
+        }
+    }
+    
+    auto make_set = [](const std::string& members) {
+        ByteSet set{};
+        for (unsigned char c : members) {
+            uint8_t* rows = c < 0x80 ? set.low_rows : set.high_rows;
+            rows[c & 0x0F] |= static_cast<uint8_t>(1u << ((c >> 4) & 7));
+        }
+        return set;
+    };
+    
+    const std::string alphabet =
+        "abcXYZ019 \t\n\v\f\r.,!?;:()[]{}\"'`~@#$%^&*+=|\\/<>-_\x01\x1f\x7f\x80\xc3\xa9\xff";
+    const ByteSet spaces = make_set(" \t\n\v\f\r");
+    const ByteSet punctuation = make_set(".,!?;:()[]{}\"'`~@#$%^&*+=|\\/<>");
+    const ByteSet high_bytes = make_set("\x80\xc3\xa9\xff\x01");
+    
+    std::mt19937 rng(1234);
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    std::uniform_int_distribution<size_t> length(0, 200);
+    
+    for (int iteration = 0; iteration < 3000; ++iteration) {
+        // Long inputs cross several vector widths and bitmap words
+        size_t len = (iteration % 50 == 0) ? 5000 + length(rng) : length(rng);
+        std::string text;
+        for (size_t i = 0; i < len; ++i) {
+            text.push_back(alphabet[pick(rng)]);
+        }
+        // Sentinel for pair_mask's one-byte lookahead
+        std::string padded = text + '\0';
+        const char* data = padded.data();
+        size_t words = (len + 63) / 64 + 1;
+        char target = alphabet[pick(rng)];
+        std::string pattern = text.substr(len / 2, length(rng) % 5);
+        
+        for (const SIMDKernels* table : tables) {
+            assert(table->count_byte(data, len, target) == scalar.count_byte(data, len, target));
+            assert(table->count_set(data, len, punctuation) == scalar.count_set(data, len, punctuation));
+            assert(table->count_set(data, len, high_bytes) == scalar.count_set(data, len, high_bytes));
+            
+            std::vector<uint64_t> expected(words, ~0ull), actual(words, ~0ull);
+            scalar.set_mask(data, len, spaces, expected.data());
+            table->set_mask(data, len, spaces, actual.data());
+            assert(expected == actual);
+            
+            scalar.pair_mask(data, len, target, 'a', expected.data());
+            table->pair_mask(data, len, target, 'a', actual.data());
+            assert(expected == actual);
+            
+            assert(table->find_substring(data, len, pattern.data(), pattern.size()) ==
+                   scalar.find_substring(data, len, pattern.data(), pattern.size()));
+            
+            bool scalar_word = iteration % 2 == 0;
+            bool table_word = scalar_word;
+            assert(table->count_word_tokens(data, len, spaces, punctuation, &table_word) ==
+                   scalar.count_word_tokens(data, len, spaces, punctuation, &scalar_word));
+            assert(table_word == scalar_word);
+            (void)table_word;
+        }
+        
+        // Public wrappers agree with their scalar references
+        assert(SIMDUtils::count_whitespace_simd(text) == SIMDUtils::count_whitespace_scalar(text));
+        assert(SIMDUtils::count_punctuation_simd(text) == SIMDUtils::count_punctuation_scalar(text));
+        assert(SIMDUtils::find_substring_simd(text, pattern) == SIMDUtils::find_substring_scalar(text, pattern));
+        assert(SIMDUtils::find_pattern_simd(text, pattern) == SIMDUtils::find_pattern_scalar(text, pattern));
+        assert(SIMDUtils::find_sentence_boundaries_simd(text) == SIMDUtils::find_sentence_boundaries_scalar(text));
+        assert(SIMDUtils::find_bpe_pairs_simd(text, {"ab", ". "}) == SIMDUtils::find_bpe_pairs_scalar(text, {"ab", ". "}));
+        assert(SIMDUtils::normalize_for_search_simd(text) == SIMDUtils::normalize_for_search_scalar(text));
+        assert(SIMDUtils::clean_text_simd(text, {'\xff', '.', 'a'}) == SIMDUtils::clean_text_scalar(text, {'\xff', '.', 'a'}));
+    }
+    
+    (void)punctuation;
+    (void)high_bytes;
+    std::cout << "Checked " << tables.size() << " kernel table(s) against scalar:";
+    for (const SIMDKernels* table : tables) {
+        std::cout << " " << table->name;
+    }
+    std::cout << std::endl << std::endl;
+}
+
+// Cleaning chain the fused pass replaced: std::regex tag stripping, \s+
+// collapsing plus trim, then two erase/remove passes (control bytes compared
+// as unsigned char, so bytes >= 0x80 are kept)
+std::string legacy_clean_document_text(const std::string& text, bool strip_html_tags, bool collapse_whitespace) {
+    std::string result = text;
+    if (strip_html_tags) {
+        result = std::regex_replace(result, std::regex("<[^>]*>"), "");
+    }
+    if (collapse_whitespace) {
+        result = std::regex_replace(result, std::regex("\\s+"), " ");
+        result.erase(0, result.find_first_not_of(" \t\n\r"));
+        result.erase(result.find_last_not_of(" \t\n\r") + 1);
+    }
+    result.erase(std::remove(result.begin(), result.end(), '\0'), result.end());
+    result.erase(std::remove_if(result.begin(), result.end(),
+        [](unsigned char c) { return c < 32 && c != '\n' && c != '\t' && c != '\r'; }), result.end());
+    return result;
+}
+
+void test_fused_text_cleaning_differential() {
+    std::cout << "=== Fused Text Cleaning Differential Tests ===" << std::endl;
+    
+    // Tags, every whitespace byte, control bytes, NUL and bytes >= 0x80
+    static constexpr char ALPHABET[] = "ab <>< > \t\n\v\f\r\x01\x1f\x7f\x80\xc3\xff\0xyz.";
+    const std::string alphabet(ALPHABET, sizeof(ALPHABET) - 1);
+    std::mt19937 rng(99);
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    std::uniform_int_distribution<size_t> length(0, 120);
+    
+    for (int iteration = 0; iteration < 20000; ++iteration) {
+        // Long inputs with rare '>' so tags span scan windows
+        bool long_input = iteration % 200 == 0;
+        size_t len = long_input ? 9000 + length(rng) * 50 : length(rng);
+        std::string text;
+        for (size_t i = 0; i < len; ++i) {
+            char c = alphabet[pick(rng)];
+            if (long_input && c == '>' && rng() % 500 != 0) c = 'a';
+            text.push_back(c);
+        }
+        
+        for (int flags = 0; flags < 4; ++flags) {
+            bool strip_html_tags = flags & 1;
+            bool collapse_whitespace = flags & 2;
+            std::string fused = r3m::utils::TextUtils::clean_document_text(text, strip_html_tags, collapse_whitespace);
+            assert(fused == legacy_clean_document_text(text, strip_html_tags, collapse_whitespace));
+            (void)fused;
+            
+            // Mapped offsets (e.g. page starts) delimit the cleaned pieces
+            if (strip_html_tags || long_input) {
+                continue;
+            }
+            std::vector<size_t> offsets = {0, rng() % (len + 1), rng() % (len + 1), len};
+            std::sort(offsets.begin(), offsets.end());
+            std::vector<size_t> mapped = offsets;
+            std::string with_offsets = r3m::utils::TextUtils::clean_document_text(text, false, collapse_whitespace, &mapped);
+            assert(with_offsets == fused);
+            for (size_t k = 0; k + 1 < offsets.size(); ++k) {
+                assert(mapped[k] <= mapped[k + 1] && mapped[k + 1] <= fused.size());
+                std::string piece = legacy_clean_document_text(text.substr(offsets[k], offsets[k + 1] - offsets[k]),
+                                                               false, collapse_whitespace);
+                std::string slice = fused.substr(mapped[k], mapped[k + 1] - mapped[k]);
+                if (collapse_whitespace) {
+                    auto trim = [](std::string& str) {
+                        str.erase(0, str.find_first_not_of(' '));
+                        str.erase(str.find_last_not_of(' ') + 1);
+                    };
+                    trim(piece);
+                    trim(slice);
+                }
+                assert(slice == piece);
+            }
+        }
+    }
+    
+    // UTF-8 text (Cyrillic, Latin-1 accents, CJK, no-break space) survives untouched
+    const std::string utf8 = "\xd0\x9f\xd1\x80\xd0\xb8\xd0\xb2\xd0\xb5\xd1\x82 \xd0\xbc\xd0\xb8\xd1\x80 caf\xc3\xa9 "
+                             "\xe6\x9d\xb1\xe4\xba\xac\xc2\xa0ok";
+    assert(r3m::utils::TextUtils::clean_document_text(utf8, true, true) == utf8);
+    
+    std::string html = "<p>Hello,\t<b>world</b>!</p>\r\n\x01  <br/>Second\v line ";
+    std::cout << "Cleaned: \"" << r3m::utils::TextUtils::clean_document_text(html, true, true) << "\"" << std::endl;
+    std::cout << "20000 randomized inputs matched the regex chain for all flag combinations" << std::endl;
+    std::cout << std::endl;
+}
+
+// Chunk scoring the single-pass scorer replaced: each metric tokenized the
+// chunk again with istringstream and counted distinct values in hash sets
+r3m::chunking::quality_assessment::ChunkQuality legacy_chunk_quality(const std::string& text) {
+    r3m::chunking::quality_assessment::ChunkQuality quality;
+    std::unordered_set<std::string> unique_words;
+    std::istringstream iss(text);
+    std::string word;
+    int words = 0;
+    int sentences = 0;
+    while (iss >> word) {
+        words++;
+        if (unique_words.size() < 100) {
+            unique_words.insert(word);
+        }
+        if (word.find('.') != std::string::npos || word.find('!') != std::string::npos ||
+            word.find('?') != std::string::npos) {
+            sentences++;
+        }
+    }
+    std::unordered_set<char> chars;
+    for (char c : text) {
+        if (std::isalnum(static_cast<unsigned char>(c))) {
+            chars.insert(c);
+        }
+    }
+    quality.word_count = words;
+    quality.sentence_count = sentences;
+    quality.word_diversity = std::min(1.0, static_cast<double>(unique_words.size()) / 100.0);
+    quality.sentence_structure = sentences == 0 ? 0.0 : std::min(1.0, (static_cast<double>(words) / sentences) / 20.0);
+    quality.information_density = std::min(1.0, static_cast<double>(chars.size()) / 50.0);
+    double length_factor = std::min(1.0, static_cast<double>(text.length()) / 1000.0);
+    quality.quality_score = (length_factor * 0.3 + quality.word_diversity * 0.3 +
+                             quality.sentence_structure * 0.2 + quality.information_density * 0.2);
+    return quality;
+}
+
+void test_chunk_quality_scoring_differential() {
+    std::cout << "=== Chunk Quality Scoring Differential Tests ===" << std::endl;
+    using r3m::chunking::quality_assessment::ChunkQuality;
+    using r3m::chunking::quality_assessment::QualityCalculator;
+    using r3m::utils::SIMDIsa;
+    using r3m::utils::SIMDKernels;
+    using r3m::utils::SIMDUtils;
+    
+    std::vector<const SIMDKernels*> tables = {&r3m::utils::scalar_kernels};
+    for (SIMDIsa isa : {SIMDIsa::SSE42, SIMDIsa::AVX2, SIMDIsa::AVX512BW, SIMDIsa::NEON}) {
+        if (const SIMDKernels* table = SIMDUtils::kernels_for(isa)) {
+            tables.push_back(table);
+        }
+    }
+    
+    // Short words from a small alphabet repeat (diversity below saturation),
+    // every whitespace byte separates them and marks land anywhere in a word
+    const std::string alphabet = "abcXYZ019.!?.,-\x80\xc3\xff";
+    const std::string separators(" \t\n\v\f\r", 6);
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+    std::uniform_int_distribution<size_t> separator(0, separators.size() - 1);
+    std::uniform_int_distribution<size_t> word_length(1, 6);
+    std::uniform_int_distribution<size_t> word_total(0, 80);
+    
+    std::vector<std::string> texts;
+    for (int iteration = 0; iteration < 5000; ++iteration) {
+        // Long inputs cross bitmap words and scan windows
+        size_t words = (iteration % 100 == 0) ? 3000 + word_total(rng) * 20 : word_total(rng);
+        std::string text;
+        for (size_t w = 0; w < words; ++w) {
+            size_t run = 1 + rng() % 3;
+            for (size_t k = 0; k < run; ++k) {
+                text.push_back(separators[separator(rng)]);
+            }
+            size_t len = word_length(rng);
+            for (size_t i = 0; i < len; ++i) {
+                text.push_back(alphabet[pick(rng)]);
+            }
+        }
+        if (iteration % 3 == 0 && !text.empty()) {
+            text.erase(0, 1);
+        }
+        texts.push_back(std::move(text));
+    }
+    
+    for (const std::string& text : texts) {
+        ChunkQuality expected = legacy_chunk_quality(text);
+        for (const SIMDKernels* table : tables) {
+            ChunkQuality actual = QualityCalculator::score(text, *table);
+            assert(actual.word_count == expected.word_count);
+            assert(actual.sentence_count == expected.sentence_count);
+            assert(actual.word_diversity == expected.word_diversity);
+            assert(actual.sentence_structure == expected.sentence_structure);
+            assert(actual.information_density == expected.information_density);
+            assert(actual.quality_score == expected.quality_score);
+            (void)actual;
+        }
+        assert(QualityCalculator::calculate_quality_score(text) == expected.quality_score);
+        assert(QualityCalculator::calculate_information_density(text) == expected.information_density);
+        (void)expected;
+    }
+    
+    // Batch scoring of realistic chunks matches one-at-a-time scoring
+    std::vector<std::string> chunks;
+    for (int i = 0; i < 2000; ++i) {
+        std::string chunk;
+        for (int s = 0; chunk.size() < 1500; ++s) {
+            chunk += "Section " + std::to_string(i) + " covers topic " + std::to_string((i * 7 + s) % 311) +
+                     " with sample data point " + std::to_string(s) + ". ";
+        }
+        chunks.push_back(std::move(chunk));
+    }
+    std::vector<std::string_view> views(chunks.begin(), chunks.end());
+    std::vector<ChunkQuality> batch(views.size());
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    QualityCalculator::score_batch(views, batch);
+    auto end = std::chrono::high_resolution_clock::now();
+    auto batch_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    
+    start = std::chrono::high_resolution_clock::now();
+    double legacy_total = 0.0;
+    for (const std::string& chunk : chunks) {
+        legacy_total += legacy_chunk_quality(chunk).quality_score;
+    }
+    end = std::chrono::high_resolution_clock::now();
+    auto legacy_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    
+    double batch_total = 0.0;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        ChunkQuality single = QualityCalculator::score(chunks[i]);
+        assert(batch[i].quality_score == single.quality_score);
+        assert(batch[i].word_count == single.word_count);
+        (void)single;
+        batch_total += batch[i].quality_score;
+    }
+    assert(batch_total == legacy_total);
+    (void)legacy_total;
+    
+    std::cout << texts.size() << " randomized inputs matched the istringstream metrics on "
+              << tables.size() << " kernel table(s)" << std::endl;
+    std::cout << "2000 chunks: score_batch " << batch_time.count() << " microseconds, separate metrics "
+              << legacy_time.count() << " microseconds" << std::endl;
+    std::cout << std::endl;
+}
+
 int main() {
     std::cout << "R3M SIMD Optimizations Test" << std::endl;
     std::cout << "============================" << std::endl;
@@ -360,6 +753,7 @@ int main() {
     test_punctuation_counting();
     test_text_cleaning();
     test_token_counting();
+    test_word_token_counting_differential();
     test_string_splitting();
     test_text_processing_integration();
     test_large_document_performance();
@@ -367,6 +761,9 @@ int main() {
     test_sentence_boundary_detection();
     test_pattern_matching();
     test_text_normalization();
+    test_kernel_dispatch_differential();
+    test_fused_text_cleaning_differential();
+    test_chunk_quality_scoring_differential();
     
     std::cout << "All SIMD tests passed!" << std::endl;
     return 0;